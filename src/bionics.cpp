@@ -487,7 +487,7 @@ bool player::activate_bionic( int b, bool eff_only )
         if( veh != nullptr ) {
             vehwindspeed = abs( veh->velocity / 100 ); // vehicle velocity in mph
         }
-        const oter_id &cur_om_ter = overmap_buffer.ter( global_omt_location() );
+        const oter_id &cur_om_ter = overmap_buffer.get_ter( global_omt_location() );
         /* windpower defined in internal velocity units (=.01 mph) */
         double windpower = 100.0f * get_local_windpower( weatherPoint.windpower + vehwindspeed,
                            cur_om_ter, g->is_sheltered( g->u.pos() ) );
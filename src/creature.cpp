@@ -20,6 +20,7 @@
 #include <numeric>
 #include <cmath>
 #include <map>
+#include <memory>
 
 const efftype_id effect_blind( "blind" );
 const efftype_id effect_bounced( "bounced" );
@@ -208,6 +209,39 @@ bool Creature::sees( const tripoint &t, bool is_player ) const
     }
 }
 
+std::vector<tripoint> Creature::vision_field( const int range ) const
+{
+    std::vector<tripoint> result;
+    const tripoint &here = pos();
+    if( range < 0 || !g->m.inbounds( here ) ) {
+        return result;
+    }
+    struct sight_cache {
+        float values[MAPSIZE*SEEX][MAPSIZE*SEEY];
+    };
+    // The player's field of vision is cast anyway when the map caches are built
+    std::unique_ptr<sight_cache> cast;
+    const float (*seen)[MAPSIZE*SEEY] = g->m.get_cache_ref( here.z ).seen_cache;
+    if( !is_player() ) {
+        cast.reset( new sight_cache() );
+        g->m.cast_sight( here, cast->values );
+        seen = cast->values;
+    }
+    const int xmin = std::max( here.x - range, 0 );
+    const int ymin = std::max( here.y - range, 0 );
+    const int xmax = std::min( here.x + range, g->m.getmapsize() * SEEX - 1 );
+    const int ymax = std::min( here.y + range, g->m.getmapsize() * SEEY - 1 );
+    for( int x = xmin; x <= xmax; x++ ) {
+        for( int y = ymin; y <= ymax; y++ ) {
+            const tripoint p( x, y, here.z );
+            if( seen[x][y] > LIGHT_TRANSPARENCY_SOLID && rl_dist( here, p ) <= range ) {
+                result.push_back( p );
+            }
+        }
+    }
+    return result;
+}
+
 // Helper function to check if potential area of effect of a weapon overlaps vehicle
 // Maybe TODO: If this is too slow, precalculate a bounding box and clip the tested area to it
 bool overlaps_vehicle( const std::set<tripoint> &veh_area, const tripoint &pos, const int area )
@@ -14,6 +14,7 @@
 #include <stdlib.h>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 class field;
 class field_entry;
@@ -144,6 +145,14 @@ class Creature
 
         /*@}*/
 
+        /**
+         * All the places on the creature's z-level within `range` that it has a line of sight to,
+         * light isn't taken into account. Taken from the shadowcasting of the field of vision:
+         * the seen cache for the player, a cast of @ref map::cast_sight for everyone else.
+         * Lets callers that check many places at once (e.g. picking a target) share one sweep.
+         */
+        std::vector<tripoint> vision_field( int range ) const;
+
         /**
          * How far the creature sees under the given light. Places outside this range can
          * @param light_level See @ref game::light_level.
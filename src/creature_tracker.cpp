@@ -1,4 +1,6 @@
 #include "creature_tracker.h"
+#include "cata_utility.h"
+#include "line.h"
 #include "pathfinding.h"
 #include "monster.h"
 #include "mongroup.h"
@@ -8,6 +10,7 @@
 #include "item.h"
 
 #include <algorithm>
+#include <cstdlib>
 
 #define dbg(x) DebugLog((DebugLevel)(x),D_GAME) << __FILE__ << ":" << __LINE__ << ": "
 
@@ -17,13 +20,128 @@ Creature_tracker::Creature_tracker()
 
 Creature_tracker::~Creature_tracker() = default;
 
+static bool in_bubble( const tripoint &pos )
+{
+    return pos.x >= 0 && pos.x < MAPSIZE * SEEX && pos.y >= 0 && pos.y < MAPSIZE * SEEY &&
+           pos.z >= -OVERMAP_DEPTH && pos.z <= OVERMAP_HEIGHT;
+}
+
+static std::vector<monster *> &bucket_of( std::array<std::vector<monster *>, MAPSIZE * MAPSIZE> &buckets,
+        const tripoint &pos )
+{
+    return buckets[( pos.x / SEEX ) * MAPSIZE + pos.y / SEEY];
+}
+
+static void remove_from_bucket( std::vector<monster *> &bucket, const monster *critter )
+{
+    const auto iter = std::find( bucket.begin(), bucket.end(), critter );
+    if( iter != bucket.end() ) {
+        *iter = bucket.back();
+        bucket.pop_back();
+    }
+}
+
+const std::shared_ptr<monster> *Creature_tracker::monster_at_location( const tripoint &pos ) const
+{
+    if( !in_bubble( pos ) ) {
+        const auto iter = monsters_outside_bubble.find( pos );
+        return iter != monsters_outside_bubble.end() ? &iter->second : nullptr;
+    }
+    const std::unique_ptr<location_layer> &layer = location_layers[pos.z + OVERMAP_DEPTH];
+    if( !layer ) {
+        return nullptr;
+    }
+    const int handle = layer->handles[pos.x][pos.y];
+    return handle != 0 ? &location_slots[handle - 1] : nullptr;
+}
+
+void Creature_tracker::set_location( const tripoint &pos, const std::shared_ptr<monster> &critter )
+{
+    if( !in_bubble( pos ) ) {
+        monsters_outside_bubble[pos] = critter;
+        return;
+    }
+    std::unique_ptr<location_layer> &layer = location_layers[pos.z + OVERMAP_DEPTH];
+    if( !layer ) {
+        layer.reset( new location_layer() );
+    }
+    int &handle = layer->handles[pos.x][pos.y];
+    std::vector<monster *> &bucket = bucket_of( layer->buckets, pos );
+    if( handle == 0 ) {
+        if( free_location_slots.empty() ) {
+            location_slots.emplace_back();
+            handle = location_slots.size();
+        } else {
+            handle = free_location_slots.back() + 1;
+            free_location_slots.pop_back();
+        }
+    } else {
+        remove_from_bucket( bucket, location_slots[handle - 1].get() );
+    }
+    location_slots[handle - 1] = critter;
+    bucket.push_back( critter.get() );
+}
+
+void Creature_tracker::clear_location( const tripoint &pos )
+{
+    if( !in_bubble( pos ) ) {
+        monsters_outside_bubble.erase( pos );
+        return;
+    }
+    const std::unique_ptr<location_layer> &layer = location_layers[pos.z + OVERMAP_DEPTH];
+    if( !layer ) {
+        return;
+    }
+    int &handle = layer->handles[pos.x][pos.y];
+    if( handle != 0 ) {
+        remove_from_bucket( bucket_of( layer->buckets, pos ), location_slots[handle - 1].get() );
+        location_slots[handle - 1].reset();
+        free_location_slots.push_back( handle - 1 );
+        handle = 0;
+    }
+}
+
+void Creature_tracker::visit_nearby( const tripoint &center, const int range,
+                                     const std::function<bool( monster &, int )> &visit ) const
+{
+    const int bx = clamp( center.x, 0, MAPSIZE * SEEX - 1 ) / SEEX;
+    const int by = clamp( center.y, 0, MAPSIZE * SEEY - 1 ) / SEEY;
+    for( int ring = 0; ring < MAPSIZE; ring++ ) {
+        // Monsters of this ring are at least this far from any point of the center bucket.
+        const int min_dist = std::max( ring - 1, 0 ) * std::min( SEEX, SEEY ) + ( ring > 0 ? 1 : 0 );
+        if( min_dist > range ) {
+            return;
+        }
+        for( int x = bx - ring; x <= bx + ring; x++ ) {
+            for( int y = by - ring; y <= by + ring; y++ ) {
+                // Only the edge of the square is in this ring
+                if( ( std::abs( x - bx ) != ring && std::abs( y - by ) != ring ) ||
+                    x < 0 || x >= MAPSIZE || y < 0 || y >= MAPSIZE ) {
+                    continue;
+                }
+                for( const auto &layer : location_layers ) {
+                    if( !layer ) {
+                        continue;
+                    }
+                    for( monster *critter : layer->buckets[x * MAPSIZE + y] ) {
+                        if( critter->is_dead() || square_dist( center.x, center.y, critter->posx(), critter->posy() ) > range ) {
+                            continue;
+                        }
+                        if( !visit( *critter, min_dist ) ) {
+                            return;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
 std::shared_ptr<monster> Creature_tracker::find( const tripoint &pos ) const
 {
-    const auto iter = monsters_by_location.find( pos );
-    if( iter != monsters_by_location.end() ) {
-        const std::shared_ptr<monster> &mon_ptr = iter->second;
-        if( !mon_ptr->is_dead() ) {
-            return mon_ptr;
+    if( const std::shared_ptr<monster> *mon_ptr = monster_at_location( pos ) ) {
+        if( !( *mon_ptr )->is_dead() ) {
+            return *mon_ptr;
         }
     }
     return nullptr;
@@ -80,7 +198,7 @@ bool Creature_tracker::add( monster &critter )
     }
 
     monsters_list.emplace_back( std::make_shared<monster>( critter ) );
-    monsters_by_location[critter.pos()] = monsters_list.back();
+    set_location( critter.pos(), monsters_list.back() );
     return true;
 }
 
@@ -92,8 +210,8 @@ size_t Creature_tracker::size() const
 bool Creature_tracker::update_pos( const monster &critter, const tripoint &new_pos )
 {
     if( critter.is_dead() ) {
-        // find ignores dead critters anyway, changing their position in the
-        // monsters_by_location map is useless.
+        // find ignores dead critters anyway, changing their tracked
+        // position is useless.
         remove_from_location_map( critter );
         return true;
     }
@@ -110,18 +228,27 @@ bool Creature_tracker::update_pos( const monster &critter, const tripoint &new_p
         }
     }
 
-    const auto iter = std::find_if( monsters_list.begin(), monsters_list.end(),
-    [&]( const std::shared_ptr<monster> &ptr ) {
-        return ptr.get() == &critter;
-    } );
-    if( iter != monsters_list.end() ) {
-        monsters_by_location.erase( critter.pos() );
-        monsters_by_location[new_pos] = *iter;
+    std::shared_ptr<monster> critter_ptr;
+    const std::shared_ptr<monster> *old_ptr = monster_at_location( critter.pos() );
+    if( old_ptr != nullptr && old_ptr->get() == &critter ) {
+        critter_ptr = *old_ptr;
+    } else {
+        const auto iter = std::find_if( monsters_list.begin(), monsters_list.end(),
+        [&]( const std::shared_ptr<monster> &ptr ) {
+            return ptr.get() == &critter;
+        } );
+        if( iter != monsters_list.end() ) {
+            critter_ptr = *iter;
+        }
+    }
+    if( critter_ptr ) {
+        clear_location( critter.pos() );
+        set_location( new_pos, critter_ptr );
         return true;
     } else {
         const tripoint &old_pos = critter.pos();
         // We're changing the x/y/z coordinates of a zombie that hasn't been added
-        // to the game yet. add_zombie() will update monsters_by_location for us.
+        // to the game yet. add_zombie() will track its location for us.
         debugmsg( "update_zombie_pos: no %s at %d,%d,%d (moving to %d,%d,%d)",
                   critter.disp_name().c_str(),
                   old_pos.x, old_pos.y, old_pos.z, new_pos.x, new_pos.y, new_pos.z );
@@ -136,11 +263,9 @@ bool Creature_tracker::update_pos( const monster &critter, const tripoint &new_p
 void Creature_tracker::remove_from_location_map( const monster &critter )
 {
     const tripoint &loc = critter.pos();
-    const auto pos_iter = monsters_by_location.find( loc );
-    if( pos_iter != monsters_by_location.end() ) {
-        if( pos_iter->second.get() == &critter ) {
-            monsters_by_location.erase( pos_iter );
-        }
+    const std::shared_ptr<monster> *mon_ptr = monster_at_location( loc );
+    if( mon_ptr != nullptr && mon_ptr->get() == &critter ) {
+        clear_location( loc );
     }
 }
 
@@ -162,14 +287,32 @@ void Creature_tracker::remove( const monster &critter )
 void Creature_tracker::clear()
 {
     monsters_list.clear();
-    monsters_by_location.clear();
+    for( auto &layer : location_layers ) {
+        layer.reset();
+    }
+    location_slots.clear();
+    free_location_slots.clear();
+    monsters_outside_bubble.clear();
 }
 
 void Creature_tracker::rebuild_cache()
 {
-    monsters_by_location.clear();
+    // Keep the layers allocated, the monsters are most likely still on the same z-levels.
+    for( auto &layer : location_layers ) {
+        if( layer ) {
+            for( auto &column : layer->handles ) {
+                column.fill( 0 );
+            }
+            for( auto &bucket : layer->buckets ) {
+                bucket.clear();
+            }
+        }
+    }
+    location_slots.clear();
+    free_location_slots.clear();
+    monsters_outside_bubble.clear();
     for( const std::shared_ptr<monster> &mon_ptr : monsters_list ) {
-        monsters_by_location[mon_ptr->pos()] = mon_ptr;
+        set_location( mon_ptr->pos(), mon_ptr );
     }
 }
 
@@ -180,20 +323,16 @@ void Creature_tracker::swap_positions( monster &first, monster &second )
     }
 
     // Either of them may be invalid!
-    const auto first_iter = monsters_by_location.find( first.pos() );
-    const auto second_iter = monsters_by_location.find( second.pos() );
-    // implied: first_iter != second_iter
-
     std::shared_ptr<monster> first_ptr;
-    if( first_iter != monsters_by_location.end() ) {
-        first_ptr = first_iter->second;
-        monsters_by_location.erase( first_iter );
+    if( const std::shared_ptr<monster> *ptr = monster_at_location( first.pos() ) ) {
+        first_ptr = *ptr;
+        clear_location( first.pos() );
     }
 
     std::shared_ptr<monster> second_ptr;
-    if( second_iter != monsters_by_location.end() ) {
-        second_ptr = second_iter->second;
-        monsters_by_location.erase( second_iter );
+    if( const std::shared_ptr<monster> *ptr = monster_at_location( second.pos() ) ) {
+        second_ptr = *ptr;
+        clear_location( second.pos() );
     }
     // implied: (first_ptr != second_ptr) or (first_ptr == nullptr && second_ptr == nullptr)
 
@@ -203,10 +342,10 @@ void Creature_tracker::swap_positions( monster &first, monster &second )
 
     // If the pointers have been taken out of the list, put them back in.
     if( first_ptr ) {
-        monsters_by_location[first.pos()] = first_ptr;
+        set_location( first.pos(), first_ptr );
     }
     if( second_ptr ) {
-        monsters_by_location[second.pos()] = second_ptr;
+        set_location( second.pos(), second_ptr );
     }
 }
 
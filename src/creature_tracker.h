@@ -3,7 +3,10 @@
 #define CREATURE_TRACKER_H
 
 #include "enums.h"
+#include "game_constants.h"
 
+#include <array>
+#include <functional>
 #include <memory>
 #include <vector>
 #include <unordered_map>
@@ -53,13 +56,44 @@ class Creature_tracker
             return monsters_list;
         }
 
+        /**
+         * Calls visit( critter, min_dist ) for the living monsters inside the reality bubble that
+         * are no more than range tiles away from center (horizontally, on any z-level). They come
+         * in rings of submap sized buckets, nearest ring first, min_dist is the lowest distance
+         * any monster of the current and later rings can have. Visiting stops once visit returns false.
+         */
+        void visit_nearby( const tripoint &center, int range,
+                           const std::function<bool( monster &critter, int min_dist )> &visit ) const;
+
         void serialize( JsonOut &jsout ) const;
         void deserialize( JsonIn &jsin );
 
     private:
+        struct location_layer {
+            /**
+             * Handles of the monsters on each tile of the reality bubble on one z-level.
+             * 0 is an empty tile, other values are 1 + the index into @ref location_slots.
+             */
+            std::array<std::array<int, MAPSIZE * SEEY>, MAPSIZE * SEEX> handles;
+            /** The monsters on each submap, indexed by x * MAPSIZE + y, for @ref visit_nearby. */
+            std::array<std::vector<monster *>, MAPSIZE * MAPSIZE> buckets;
+        };
+
         std::vector<std::shared_ptr<monster>> monsters_list;
-        std::unordered_map<tripoint, std::shared_ptr<monster>> monsters_by_location;
-        /** Remove the monsters entry in @ref monsters_by_location */
+        /** Monster locations inside the reality bubble, layers are allocated on first use. */
+        std::array<std::unique_ptr<location_layer>, OVERMAP_LAYERS> location_layers;
+        /** The monsters the handles in @ref location_layers refer to, null for unused slots. */
+        std::vector<std::shared_ptr<monster>> location_slots;
+        std::vector<int> free_location_slots;
+        /** Monster locations outside of the reality bubble, those are rare. */
+        std::unordered_map<tripoint, std::shared_ptr<monster>> monsters_outside_bubble;
+
+        /** The monster tracked at pos, nullptr if there is none. */
+        const std::shared_ptr<monster> *monster_at_location( const tripoint &pos ) const;
+        void set_location( const tripoint &pos, const std::shared_ptr<monster> &critter );
+        /** Stops tracking whatever monster is at pos. */
+        void clear_location( const tripoint &pos );
+        /** Remove the monsters entry in the location lookup */
         void remove_from_location_map( const monster &critter );
 };
 
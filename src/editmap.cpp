@@ -24,6 +24,7 @@
 #include "npc.h"
 #include "vehicle.h"
 #include "submap.h"
+#include "mapbuffer.h"
 #include "monster.h"
 #include "overmap.h"
 #include "field.h"
@@ -1773,6 +1774,11 @@ int editmap::mapgen_preview( real_coords &tc, uimenu &gmenu )
                         }
                         srcsm->vehicles.clear();
                         g->m.update_vehicle_list( destsm, target.z ); // update real map's vcaches
+                        if( !destsm->vehicles.empty() ) {
+                            const tripoint abs_sub = g->m.get_abs_sub();
+                            MAPBUFFER.add_vehicle_submap( tripoint( abs_sub.x + target_sub.x + x,
+                                                                    abs_sub.y + target_sub.y + y, target.z ) );
+                        }
 
                         int spawns_todo = 0;
                         for( size_t i = 0; i < srcsm->spawns.size(); i++ ) { // copy spawns
@@ -1788,6 +1794,7 @@ int editmap::mapgen_preview( real_coords &tc, uimenu &gmenu )
                             }
                         }
                         destsm->field_count = srcsm->field_count; // and count
+                        destsm->field_tiles = srcsm->field_tiles;
 
                         std::memcpy( destsm->ter, srcsm->ter, sizeof( srcsm->ter ) ); // terrain
                         std::memcpy( destsm->frn, srcsm->frn, sizeof( srcsm->frn ) ); // furniture
@@ -21,8 +21,13 @@
 #include "mtype.h"
 #include "emit.h"
 #include "scent_map.h"
+#include "worker_pool.h"
 
+#include <algorithm>
+#include <climits>
+#include <functional>
 #include <queue>
+#include <random>
 
 const species_id FUNGUS( "FUNGUS" );
 
@@ -459,33 +464,174 @@ field_id field_from_ident(const std::string &field_ident)
     return fd_null;
 }
 
+/**
+ * Spread rules of the gases that do nothing but spread and age. These are planned for a
+ * whole submap at once (see @ref map::plan_gas_spread), everything else is processed tile
+ * by tile in @ref map::process_fields_in_submap.
+ */
+struct gas_spread_rule {
+    int percent_spread;
+    int outdoor_age_speedup;
+    bool changes_transparency;
+};
+
+static const gas_spread_rule *gas_spread_rule_for( const field_id type )
+{
+    static const gas_spread_rule smoke{ 50, 0, true };
+    static const gas_spread_rule tear_gas{ 30, 0, true };
+    static const gas_spread_rule relax_gas{ 25, 50, true };
+    static const gas_spread_rule toxic_gas{ 50, 30, true };
+    static const gas_spread_rule cigsmoke{ 250, 65, true };
+    // No transparency cache wrecking here!
+    static const gas_spread_rule hot_air{ 100, 1000, false };
+    switch( type ) {
+        case fd_smoke:
+            return &smoke;
+        case fd_tear_gas:
+            return &tear_gas;
+        case fd_relax_gas:
+            return &relax_gas;
+        case fd_toxic_gas:
+            return &toxic_gas;
+        case fd_cigsmoke:
+            return &cigsmoke;
+        case fd_hot_air1:
+        case fd_hot_air2:
+        case fd_hot_air3:
+        case fd_hot_air4:
+            return &hot_air;
+        default:
+            return nullptr;
+    }
+}
+
+/**
+ * The planned change of one gas entry for this turn: how its own density and age change
+ * and, if it spreads, where to and with which age.
+ */
+struct gas_spread {
+    tripoint source;
+    field_id type;
+    int density_change;
+    int age_change;
+    bool clears_scent;
+    bool spreads;
+    tripoint destination;
+    int destination_age;
+};
+
+/** A fire that burned its own tile this turn and still has to spread, see @ref map::plan_fire_spread. */
+struct fire_source {
+    tripoint pos;
+    // Smoke produced by what burned on the tile, the chance in 100 to smoke
+    int smoke;
+};
+
+/**
+ * One planned change of spreading fire. They are applied in the planned order, so fires
+ * feeding the same tile see what the ones before them did.
+ */
+struct fire_spread {
+    enum kind_t {
+        // Changes the density and age of the fire at target by density and age
+        burn,
+        // Makes a weaker fire at target bigger and gives it some fuel
+        boost,
+        // Fuels the fire at target, or starts one if there is none
+        feed,
+        // Sets target on fire unless it already burns, and burns the webs there
+        ignite,
+        // Adds a field of type and density at target
+        add
+    };
+    kind_t kind;
+    tripoint target;
+    field_id type;
+    int density;
+    int age;
+};
+
 bool map::process_fields()
 {
     bool dirty_transparency_cache = false;
     const int minz = zlevels ? -OVERMAP_DEPTH : abs_sub.z;
     const int maxz = zlevels ? OVERMAP_HEIGHT : abs_sub.z;
-    bool zlev_dirty;
+    const int submaps = my_MAPSIZE * my_MAPSIZE;
+    std::vector<std::vector<gas_spread>> staged( submaps );
+    std::vector<std::vector<fire_source>> fires( submaps );
+    std::vector<std::vector<fire_spread>> staged_fire( submaps );
+    std::vector<char> submap_dirty( submaps );
+    // Runs plan( index ) for every submap, on the shared workers if there are any
+    const auto plan_submaps = [submaps]( const std::function<void( int )> &plan ) {
+        if( worker_pool *workers = shared_workers() ) {
+            workers->run( submaps, [&plan]( const int index, int ) {
+                plan( index );
+            } );
+        } else {
+            for( int index = 0; index < submaps; index++ ) {
+                plan( index );
+            }
+        }
+    };
     for( int z = minz; z <= maxz; z++ ) {
-        zlev_dirty = false;
+        // Simple gases are planned against the fields as they were at the start of the turn and
+        // every submap draws from its own random stream, so the result doesn't depend on
+        // how many workers did the planning.
+        const unsigned int seed = rng( 0, INT_MAX );
+        plan_submaps( [&]( const int index ) {
+            staged[index].clear();
+            submap_dirty[index] = false;
+            if( get_submap_at_grid( index / my_MAPSIZE, index % my_MAPSIZE, z )->field_count > 0 ) {
+                submap_dirty[index] = plan_gas_spread( index / my_MAPSIZE, index % my_MAPSIZE, z,
+                                                       seed + index, staged[index] );
+            }
+        } );
+        for( const auto &changes : staged ) {
+            apply_gas_spread( changes );
+        }
+
         for( int x = 0; x < my_MAPSIZE; x++ ) {
             for( int y = 0; y < my_MAPSIZE; y++ ) {
                 submap * const current_submap = get_submap_at_grid( x, y, z );
-                if( current_submap->field_count > 0 ) {
-                    const bool cur_dirty = process_fields_in_submap( current_submap, x, y, z );
-                    zlev_dirty |= cur_dirty;
+                const int index = x * my_MAPSIZE + y;
+                fires[index].clear();
+                if( current_submap->field_count > 0 &&
+                    process_fields_in_submap( current_submap, x, y, z, fires[index] ) ) {
+                    submap_dirty[index] = true;
                 }
             }
         }
 
-        if( zlev_dirty ) {
-            // For now, just always dirty the transparency cache
-            // when a field might possibly be changed.
-            // TODO: check if there are any fields(mostly fire)
-            //       that frequently change, if so set the dirty
-            //       flag, otherwise only set the dirty flag if
-            //       something actually changed
-            set_transparency_cache_dirty( z );
-            dirty_transparency_cache = true;
+        // Fires burned their own tiles above, they spread to their neighbours the same way as gases
+        const unsigned int fire_seed = rng( 0, INT_MAX );
+        plan_submaps( [&]( const int index ) {
+            staged_fire[index].clear();
+            if( plan_fire_spread( fires[index], fire_seed + index, staged_fire[index] ) ) {
+                submap_dirty[index] = true;
+            }
+        } );
+        for( const auto &changes : staged_fire ) {
+            apply_fire_spread( changes );
+        }
+
+        for( int x = 0; x < my_MAPSIZE; x++ ) {
+            for( int y = 0; y < my_MAPSIZE; y++ ) {
+                if( submap_dirty[x * my_MAPSIZE + y] ) {
+                    // For now, just always dirty the transparency cache
+                    // when a field might possibly be changed.
+                    // TODO: check if there are any fields(mostly fire)
+                    //       that frequently change, if so set the dirty
+                    //       flag, otherwise only set the dirty flag if
+                    //       something actually changed
+                    // Fields spread into the neighbouring submaps too.
+                    for( int nx = std::max( x - 1, 0 ); nx <= std::min( x + 1, my_MAPSIZE - 1 ); nx++ ) {
+                        for( int ny = std::max( y - 1, 0 ); ny <= std::min( y + 1, my_MAPSIZE - 1 ); ny++ ) {
+                            set_transparency_cache_dirty( tripoint( nx * SEEX, ny * SEEY, z ) );
+                        }
+                    }
+                    dirty_transparency_cache = true;
+                }
+            }
         }
     }
 
@@ -542,45 +688,468 @@ bool at_edge( const size_t x, const size_t y )
     return x == 0 || x == SEEX || y == 0 || y == SEEY;
 }
 
+std::array<maptile, 8> map::get_neighbors( const tripoint &pt )
+{
+    // Wrapper to allow skipping bound checks except at the edges of the map
+    const auto maptile_has_bounds = [this]( const tripoint &pt, const bool bounds_checked ) {
+        if( bounds_checked ) {
+            // We know that the point is in bounds
+            return maptile_at_internal( pt );
+        }
+
+        return maptile_at( pt );
+    };
+
+    // Find out which edges are in the bubble
+    // Where possible, do just one bounds check for all the neighbors
+    const bool west = pt.x > 0;
+    const bool north = pt.y > 0;
+    const bool east = pt.x < SEEX * my_MAPSIZE - 1;
+    const bool south = pt.y < SEEY * my_MAPSIZE - 1;
+    return std::array< maptile, 8 > { {
+        maptile_has_bounds( {pt.x - 1, pt.y - 1, pt.z}  , west && north ),
+        maptile_has_bounds( {pt.x, pt.y - 1, pt.z}      , north ),
+        maptile_has_bounds( {pt.x + 1, pt.y - 1, pt.z}  , east && north ),
+        maptile_has_bounds( {pt.x - 1, pt.y, pt.z}      , west ),
+        maptile_has_bounds( {pt.x + 1, pt.y, pt.z}      , east ),
+        maptile_has_bounds( {pt.x - 1, pt.y + 1, pt.z}  , west && south ),
+        maptile_has_bounds( {pt.x, pt.y + 1, pt.z}      , south ),
+        maptile_has_bounds( {pt.x + 1, pt.y + 1, pt.z}  , east && south ),
+    } };
+}
+
+// Offsets of the tiles returned by get_neighbors
+static const std::array<point, 8> neighbor_offsets = { {
+    point( -1, -1 ), point( 0, -1 ), point( 1, -1 ), point( -1, 0 ),
+    point( 1, 0 ), point( -1, 1 ), point( 0, 1 ), point( 1, 1 )
+} };
+
 /*
-Function: process_fields_in_submap
-Iterates over every field on every tile of the given submap given as parameter.
-This is the general update function for field effects. This should only be called once per game turn.
-If you need to insert a new field behavior per unit time add a case statement in the switch below.
+Function: plan_gas_spread
+Works out how the simple gases (see gas_spread_rule_for) in the given submap age and spread this
+turn, without changing the map. The rules are the ones of spread_gas in process_fields_in_submap.
+Only reads the map, so the submaps can be planned in parallel. Returns whether any of the gases
+changes transparency.
 */
-bool map::process_fields_in_submap( submap *const current_submap,
-                                    const int submap_x, const int submap_y, const int submap_z )
+bool map::plan_gas_spread( const int submap_x, const int submap_y, const int submap_z,
+                           const unsigned int seed, std::vector<gas_spread> &changes )
 {
-    const auto get_neighbors = [this]( const tripoint &pt ) {
-        // Wrapper to allow skipping bound checks except at the edges of the map
-        const auto maptile_has_bounds = [this]( const tripoint &pt, const bool bounds_checked ) {
-            if( bounds_checked ) {
-                // We know that the point is in bounds
-                return maptile_at_internal( pt );
+    std::minstd_rand engine( seed );
+    const auto roll = [&engine]( const int lo, const int hi ) {
+        return std::uniform_int_distribution<int>( lo, hi )( engine );
+    };
+
+    bool dirty_transparency_cache = false;
+    submap *const current_submap = get_submap_at_grid( submap_x, submap_y, submap_z );
+    for( size_t locx = 0; locx < SEEX; locx++ ) {
+        for( size_t locy = current_submap->next_field_tile( locx, 0 ); locy < SEEY;
+             locy = current_submap->next_field_tile( locx, locy + 1 ) ) {
+            const tripoint p( locx + submap_x * SEEX, locy + submap_y * SEEY, submap_z );
+            for( const auto &fp : current_submap->fld[locx][locy] ) {
+                const field_entry &cur = fp.second;
+                const gas_spread_rule *rule = gas_spread_rule_for( fp.first );
+                if( rule == nullptr || !cur.isAlive() ) {
+                    continue;
+                }
+
+                gas_spread change{ p, fp.first, 0, 0, false, false, p, 0 };
+                const int current_density = cur.getFieldDensity();
+                int density = current_density;
+                int age = cur.getFieldAge();
+                // Don't process "newborn" fields. This gives the player time to run if they need to.
+                if( age != 0 ) {
+                    change.clears_scent = true;
+                    dirty_transparency_cache |= rule->changes_transparency;
+                    const int current_age = age;
+                    // Dissipate faster outdoors.
+                    if( is_outside( p ) ) {
+                        age += rule->outdoor_age_speedup;
+                    }
+
+                    const auto can_spread_to = [&]( const maptile &dst ) {
+                        const field_entry *tmpfld = dst.get_field().findField( fp.first );
+                        const auto &ter = dst.get_ter_t();
+                        const auto &frn = dst.get_furn_t();
+                        return ( ter_furn_movecost( ter, frn ) > 0 || ter_furn_has_flag( ter, frn, TFLAG_PERMEABLE ) ) &&
+                               ( tmpfld == nullptr || tmpfld->getFieldDensity() < current_density );
+                    };
+                    const auto spread_to = [&]( const tripoint &dst ) {
+                        // Nearby gas grows thicker, and ages are shared.
+                        const int age_fraction = 0.5 + current_age / current_density;
+                        change.spreads = true;
+                        change.destination = dst;
+                        change.destination_age = age_fraction;
+                        density = current_density - 1;
+                        age = current_age - age_fraction;
+                    };
+
+                    if( current_density > 1 && roll( 1, 100 ) <= rule->percent_spread ) {
+                        bool fell = false;
+                        // First check if we can fall
+                        if( zlevels && p.z > -OVERMAP_DEPTH ) {
+                            const tripoint down( p.x, p.y, p.z - 1 );
+                            if( can_spread_to( maptile_at_internal( down ) ) && valid_move( p, down, true, true ) ) {
+                                spread_to( down );
+                                fell = true;
+                            }
+                        }
+
+                        if( !fell ) {
+                            const auto neighs = get_neighbors( p );
+                            const size_t end_it = roll( 0, neighs.size() - 1 );
+                            std::vector<size_t> spread;
+                            spread.reserve( 8 );
+                            // Start at end_it + 1, then wrap around until i == end_it
+                            for( size_t i = ( end_it + 1 ) % neighs.size(); i != end_it; i = ( i + 1 ) % neighs.size() ) {
+                                const tripoint dst( p.x + neighbor_offsets[i].x, p.y + neighbor_offsets[i].y, p.z );
+                                if( inbounds( dst ) && can_spread_to( neighs[i] ) ) {
+                                    spread.push_back( i );
+                                }
+                            }
+
+                            // Then, spread to a nearby point.
+                            // If not possible (or randomly), try to spread up
+                            if( !spread.empty() && ( !zlevels || roll( 1, spread.size() ) == 1 ) ) {
+                                const point &offset = neighbor_offsets[spread[roll( 0, spread.size() - 1 )]];
+                                spread_to( tripoint( p.x + offset.x, p.y + offset.y, p.z ) );
+                            } else if( zlevels && p.z < OVERMAP_HEIGHT ) {
+                                const tripoint up( p.x, p.y, p.z + 1 );
+                                if( can_spread_to( maptile_at_internal( up ) ) && valid_move( p, up, true, true ) ) {
+                                    spread_to( up );
+                                }
+                            }
+                        }
+                    }
+                }
+
+                age++;
+                const int halflife = fieldlist[fp.first].halflife;
+                if( halflife > 0 && age > 0 && roll( 1, age ) + roll( 1, age ) > halflife ) {
+                    age = 0;
+                    density--;
+                }
+                change.density_change = density - current_density;
+                change.age_change = age - cur.getFieldAge();
+                changes.push_back( change );
             }
+        }
+    }
+    return dirty_transparency_cache;
+}
 
-            return maptile_at( pt );
-        };
+/*
+Function: apply_gas_spread
+Applies the changes planned by plan_gas_spread. The changes are relative, so gas that spread
+into an entry after it was planned adds up with the planned aging of that entry.
+*/
+void map::apply_gas_spread( const std::vector<gas_spread> &changes )
+{
+    for( const gas_spread &change : changes ) {
+        const tripoint &p = change.source;
+        if( change.clears_scent ) {
+            // Reset nearby scents to zero
+            tripoint tmp;
+            tmp.z = p.z;
+            for( tmp.x = p.x - 1; tmp.x <= p.x + 1; tmp.x++ ) {
+                for( tmp.y = p.y - 1; tmp.y <= p.y + 1; tmp.y++ ) {
+                    g->scent.set( tmp, 0 );
+                }
+            }
+        }
+
+        if( field_entry *cur = maptile_at_internal( p ).find_field( change.type ) ) {
+            cur->setFieldDensity( cur->getFieldDensity() + change.density_change );
+            cur->setFieldAge( cur->getFieldAge() + change.age_change );
+        }
+
+        if( !change.spreads ) {
+            continue;
+        }
+        maptile dst = maptile_at_internal( change.destination );
+        if( field_entry *candidate_field = dst.find_field( change.type ) ) {
+            candidate_field->setFieldDensity( candidate_field->getFieldDensity() + 1 );
+            candidate_field->setFieldAge( candidate_field->getFieldAge() + change.destination_age );
+        } else if( dst.add_field( change.type, 1, 0 ) ) {
+            dst.find_field( change.type )->setFieldAge( change.destination_age );
+        }
+    }
+}
 
-        // Find out which edges are in the bubble
-        // Where possible, do just one bounds check for all the neighbors
-        const bool west = pt.x > 0;
-        const bool north = pt.y > 0;
-        const bool east = pt.x < SEEX * my_MAPSIZE - 1;
-        const bool south = pt.y < SEEY * my_MAPSIZE - 1;
-        return std::array< maptile, 8 > { {
-            maptile_has_bounds( {pt.x - 1, pt.y - 1, pt.z}  , west && north ),
-            maptile_has_bounds( {pt.x, pt.y - 1, pt.z}      , north ),
-            maptile_has_bounds( {pt.x + 1, pt.y - 1, pt.z}  , east && north ),
-            maptile_has_bounds( {pt.x - 1, pt.y, pt.z}      , west ),
-            maptile_has_bounds( {pt.x + 1, pt.y, pt.z}      , east ),
-            maptile_has_bounds( {pt.x - 1, pt.y + 1, pt.z}  , west && south ),
-            maptile_has_bounds( {pt.x, pt.y + 1, pt.z}      , south ),
-            maptile_has_bounds( {pt.x + 1, pt.y + 1, pt.z}  , east && south ),
-        } };
+/*
+Function: plan_fire_spread
+Works out how the given fires, which already burned their own tiles this turn, feed their
+neighbours, grow, set the tiles around them on fire and smoke, without changing the map.
+Only reads the map, so the submaps can be planned in parallel. Returns whether any of the
+changes affects transparency.
+*/
+bool map::plan_fire_spread( const std::vector<fire_source> &fires, const unsigned int seed,
+                            std::vector<fire_spread> &changes )
+{
+    std::minstd_rand engine( seed );
+    const auto roll = [&engine]( const int lo, const int hi ) {
+        return std::uniform_int_distribution<int>( lo, hi )( engine );
+    };
+    const auto chance = [&roll]( const int in ) {
+        return in <= 1 || roll( 0, in - 1 ) == 0;
     };
 
-    const auto spread_gas = [this, &get_neighbors] (
+    bool dirty_transparency_cache = false;
+    for( const fire_source &fire : fires ) {
+        const tripoint &p = fire.pos;
+        const maptile map_tile = maptile_at_internal( p );
+        const field_entry *cur = map_tile.get_field().findField( fd_fire );
+        if( cur == nullptr || !cur->isAlive() ) {
+            continue;
+        }
+        const auto &ter = map_tile.get_ter_t();
+        const auto &frn = map_tile.get_furn_t();
+        const bool can_spread = !ter_furn_has_flag( ter, frn, TFLAG_FIRE_CONTAINER );
+        const size_t own_change = changes.size();
+        changes.push_back( { fire_spread::burn, p, fd_fire, 0, 0 } );
+        int density = cur->getFieldDensity();
+        int age = cur->getFieldAge();
+
+        // Below we will access our nearest 8 neighbors, so let's cache them now
+        // This should probably be done more globally, because large fires will re-do it a lot
+        auto neighs = get_neighbors( p );
+        const auto neighbor_at = [&p]( const size_t i ) {
+            return tripoint( p.x + neighbor_offsets[i].x, p.y + neighbor_offsets[i].y, p.z );
+        };
+
+        // If the flames are in a pit, it can't spread to non-pit
+        const bool in_pit = ter.id.id() == t_pit;
+
+        // Count adjacent fires, to optimize out needless smoke and hot air
+        int adjacent_fires = 0;
+
+        // If the flames are big, they contribute to adjacent flames
+        if( can_spread ) {
+            if( density > 1 && chance( 3 ) ) {
+                // Basically: Scan around for a spot,
+                // if there is more fire there, make it bigger and give it some fuel.
+                // This is how big fires spend their excess age:
+                // making other fires bigger. Flashpoint.
+                const size_t end_it = roll( 0, neighs.size() - 1 );
+                for( size_t i = ( end_it + 1 ) % neighs.size();
+                     i != end_it && age < 0;
+                     i = ( i + 1 ) % neighs.size() ) {
+                    const maptile &dst = neighs[i];
+                    const field_entry *dstfld = dst.get_field().findField( fd_fire );
+                    // If the fire exists and is weaker than ours, boost it
+                    if( dstfld != nullptr && inbounds( neighbor_at( i ) ) &&
+                        ( dstfld->getFieldDensity() <= density || dstfld->getFieldAge() > age ) &&
+                        ( in_pit == ( dst.get_ter() == t_pit ) ) ) {
+                        changes.push_back( { fire_spread::boost, neighbor_at( i ), fd_fire, 0, 0 } );
+                        age += MINUTES( 5 );
+                    }
+
+                    if( dstfld != nullptr ) {
+                        adjacent_fires++;
+                    }
+                }
+            } else if( age < 0 && density < 3 ) {
+                // See if we can grow into a stage 2/3 fire, for this
+                // burning neighbours are necessary in addition to
+                // field age < 0, or alternatively, a LOT of fuel.
+
+                // The maximum fire density is 1 for a lone fire, 2 for at least 1 neighbour,
+                // 3 for at least 2 neighbours.
+                int maximum_density =  1;
+
+                // The following logic looks a bit complex due to optimization concerns, so here are the semantics:
+                // 1. Calculate maximum field density based on fuel, -50 minutes is 2(medium), -500 minutes is 3(raging)
+                // 2. Calculate maximum field density based on neighbours, 3 neighbours is 2(medium), 7 or more neighbours is 3(raging)
+                // 3. Pick the higher maximum between 1. and 2.
+                if( age < -MINUTES( 500 ) ) {
+                    maximum_density = 3;
+                } else {
+                    for( size_t i = 0; i < neighs.size(); i++ ) {
+                        if( neighs[i].get_field().findField( fd_fire ) != nullptr ) {
+                            adjacent_fires++;
+                        }
+                    }
+                    maximum_density = 1 + ( adjacent_fires >= 3 ) + ( adjacent_fires >= 7 );
+
+                    if( maximum_density < 2 && age < -MINUTES( 50 ) ) {
+                        maximum_density = 2;
+                    }
+                }
+
+                // If we consumed a lot, the flames grow higher
+                if( density < maximum_density && age < 0 ) {
+                    // Fires under 0 age grow in size. Level 3 fires under 0 spread later on.
+                    // Weaken the newly-grown fire
+                    density++;
+                    age += MINUTES( density * 10 );
+                }
+            }
+        }
+
+        // Consume adjacent fuel / terrain / webs to spread.
+        // Allow raging fires (and only raging fires) to spread up
+        // Spreading down is achieved by wrecking the walls/floor and then falling
+        if( zlevels && density == 3 && p.z < OVERMAP_HEIGHT ) {
+            // Let it burn through the floor
+            const tripoint up( p.x, p.y, p.z + 1 );
+            const auto &dst_ter = maptile_at_internal( up ).get_ter_t();
+            if( dst_ter.has_flag( TFLAG_NO_FLOOR ) ||
+                dst_ter.has_flag( TFLAG_FLAMMABLE ) ||
+                dst_ter.has_flag( TFLAG_FLAMMABLE_ASH ) ||
+                dst_ter.has_flag( TFLAG_FLAMMABLE_HARD ) ) {
+                // Fueling fires above doesn't cost fuel
+                changes.push_back( { fire_spread::feed, up, fd_fire, 0, 0 } );
+            }
+        }
+
+        // Our iterator will start at end_i + 1 and increment from there and then wrap around.
+        // This guarantees it will check all neighbors, starting from a random one
+        const size_t end_i = roll( 0, neighs.size() - 1 );
+        for( size_t i = ( end_i + 1 ) % neighs.size();
+             i != end_i; i = ( i + 1 ) % neighs.size() ) {
+            if( chance( density * 2 ) ) {
+                // Skip some processing to save on CPU
+                continue;
+            }
+
+            const maptile &dst = neighs[i];
+            if( !inbounds( neighbor_at( i ) ) ) {
+                continue;
+            }
+
+            if( dst.get_field().findField( fd_fire ) != nullptr ) {
+                // We handled supporting fires in the section above, no need to do it here
+                continue;
+            }
+
+            const field_entry *nearwebfld = dst.get_field().findField( fd_web );
+            int spread_chance = 25 * ( density - 1 );
+            if( nearwebfld != nullptr ) {
+                spread_chance = 50 + spread_chance / 2;
+            }
+
+            const auto &dster = dst.get_ter_t();
+            const auto &dsfrn = dst.get_furn_t();
+            // Allow weaker fires to spread occasionally
+            const int power = density + chance( 5 );
+            if( can_spread && roll( 1, 100 ) < spread_chance &&
+                ( in_pit == ( dster.id.id() == t_pit ) ) &&
+                (
+                    ( power >= 3 && age < 0 && chance( 20 ) ) ||
+                    ( power >= 2 && ( ter_furn_has_flag( dster, dsfrn, TFLAG_FLAMMABLE ) && chance( 2 ) ) ) ||
+                    ( power >= 2 && ( ter_furn_has_flag( dster, dsfrn, TFLAG_FLAMMABLE_ASH ) && chance( 2 ) ) ) ||
+                    ( power >= 3 && ( ter_furn_has_flag( dster, dsfrn, TFLAG_FLAMMABLE_HARD ) && chance( 5 ) ) ) ||
+                    nearwebfld || ( dst.get_item_count() > 0 && flammable_items_at( neighbor_at( i ) ) && chance( 5 ) )
+                ) ) {
+                // Nearby open flammable ground? Set it on fire.
+                changes.push_back( { fire_spread::ignite, neighbor_at( i ), fd_fire, 0, 0 } );
+                // Consume a bit of our fuel
+                age += MINUTES( 1 );
+            }
+        }
+
+        // Create smoke once - above us if possible, at us otherwise
+        if( !ter_furn_has_flag( ter, frn, TFLAG_SUPPRESS_SMOKE ) &&
+            roll( 0, 100 ) <= fire.smoke &&
+            roll( 3, 35 ) < density * 10 ) {
+            bool smoke_up = zlevels && p.z < OVERMAP_HEIGHT;
+            if( smoke_up ) {
+                const tripoint up( p.x, p.y, p.z + 1 );
+                if( maptile_at_internal( up ).get_ter_t().has_flag( TFLAG_NO_FLOOR ) ) {
+                    changes.push_back( { fire_spread::add, up, fd_smoke, roll( 1, density ), 0 } );
+                } else {
+                    // Can't create smoke above
+                    smoke_up = false;
+                }
+            }
+
+            if( !smoke_up ) {
+                // Create thicker smoke
+                changes.push_back( { fire_spread::add, p, fd_smoke, density, 0 } );
+            }
+
+            dirty_transparency_cache = true; // Smoke affects transparency
+        }
+
+        // Hot air is a heavy load on the CPU and it doesn't do much
+        // Don't produce too much of it if we have a lot fires nearby, they produce
+        // radiant heat which does what hot air would do anyway
+        if( roll( 0, adjacent_fires ) > 2 ) {
+            static const std::array<field_id, 3> hot_air = { { fd_hot_air1, fd_hot_air2, fd_hot_air3 } };
+            for( int counter = 0; counter < 5; counter++ ) {
+                const tripoint dst( p.x + roll( -1, 1 ), p.y + roll( -1, 1 ), p.z );
+                changes.push_back( { fire_spread::add, dst, hot_air[density - 1], 1, 0 } );
+            }
+        }
+
+        changes[own_change].density = density - cur->getFieldDensity();
+        changes[own_change].age = age - cur->getFieldAge();
+    }
+    return dirty_transparency_cache;
+}
+
+/*
+Function: apply_fire_spread
+Applies the changes planned by plan_fire_spread.
+*/
+void map::apply_fire_spread( const std::vector<fire_spread> &changes )
+{
+    for( const fire_spread &change : changes ) {
+        if( change.kind == fire_spread::add ) {
+            // Checks the bounds, hot air can drift off the map
+            add_field( change.target, change.type, change.density, 0 );
+            continue;
+        }
+
+        maptile dst = maptile_at_internal( change.target );
+        field_entry *fire = dst.find_field( fd_fire );
+        switch( change.kind ) {
+            case fire_spread::burn:
+                if( fire != nullptr ) {
+                    fire->setFieldDensity( fire->getFieldDensity() + change.density );
+                    fire->setFieldAge( fire->getFieldAge() + change.age );
+                }
+                break;
+            case fire_spread::boost:
+                if( fire != nullptr ) {
+                    if( fire->getFieldDensity() < 2 ) {
+                        fire->setFieldDensity( fire->getFieldDensity() + 1 );
+                    }
+                    fire->setFieldAge( fire->getFieldAge() - MINUTES( 5 ) );
+                }
+                break;
+            case fire_spread::feed:
+                if( fire != nullptr ) {
+                    fire->setFieldAge( fire->getFieldAge() - MINUTES( 2 ) );
+                } else {
+                    dst.add_field( fd_fire, 1, 0 );
+                }
+                break;
+            case fire_spread::ignite:
+                // Make the new fire quite weak, so that it doesn't start jumping around instantly
+                if( fire == nullptr && dst.add_field( fd_fire, 1, 0 ) ) {
+                    dst.find_field( fd_fire )->setFieldAge( MINUTES( 2 ) );
+                }
+                if( field_entry *web = dst.find_field( fd_web ) ) {
+                    web->setFieldDensity( 0 );
+                }
+                break;
+            case fire_spread::add:
+                break;
+        }
+    }
+}
+
+/*
+Function: process_fields_in_submap
+Iterates over every field on every tile of the given submap given as parameter.
+This is the general update function for field effects. This should only be called once per game turn.
+If you need to insert a new field behavior per unit time add a case statement in the switch below.
+*/
+bool map::process_fields_in_submap( submap *const current_submap,
+                                    const int submap_x, const int submap_y, const int submap_z,
+                                    std::vector<fire_source> &fires )
+{
+    const auto spread_gas = [this] (
         field_entry *cur, const tripoint &p, field_id curtype,
         int percent_spread, int outdoor_age_speedup ) {
         // Reset nearby scents to zero
@@ -716,9 +1285,11 @@ bool map::process_fields_in_submap( submap *const current_submap,
     maptile map_tile( current_submap, 0, 0 );
     size_t &locx = map_tile.x;
     size_t &locy = map_tile.y;
-    //Loop through all tiles in this submap indicated by current_submap
+    //Loop through all tiles in this submap indicated by current_submap that hold fields.
+    //Fields spreading into a later tile get processed in this pass too, same as for a full sweep.
     for( locx = 0; locx < SEEX; locx++ ) {
-        for( locy = 0; locy < SEEY; locy++ ) {
+        for( locy = current_submap->next_field_tile( locx, 0 ); locy < SEEY;
+             locy = current_submap->next_field_tile( locx, locy + 1 ) ) {
             // This is a translation from local coordinates to submap coords.
             // All submaps are in one long 1d array.
             thep.x = locx + submap_x * SEEX;
@@ -742,6 +1313,12 @@ bool map::process_fields_in_submap( submap *const current_submap,
                 }
 
                 curtype = cur->getFieldType();
+                // Simple gases were already aged and spread by plan_gas_spread, everything else
+                // is processed serially in place. Fire only burns its own tile here.
+                if( gas_spread_rule_for( curtype ) != nullptr ) {
+                    ++it;
+                    continue;
+                }
                 // Again, legacy support in the event someone Mods setFieldDensity to allow more values.
                 if (cur->getFieldDensity() > 3 || cur->getFieldDensity() < 1) {
                     debugmsg("Whoooooa density of %d", cur->getFieldDensity());
@@ -979,210 +1556,12 @@ bool map::process_fields_in_submap( submap *const current_submap,
                             cur->setFieldAge( cur->getFieldAge() + 2 * cur->getFieldDensity() );
                         }
 
-                        // Below we will access our nearest 8 neighbors, so let's cache them now
-                        // This should probably be done more globally, because large fires will re-do it a lot
-                        auto neighs = get_neighbors( p );
-
-                        // If the flames are in a pit, it can't spread to non-pit
-                        const bool in_pit = ter.id.id() == t_pit;
-
-                        // Count adjacent fires, to optimize out needless smoke and hot air
-                        int adjacent_fires = 0;
-
-                        // If the flames are big, they contribute to adjacent flames
-                        if( can_spread ) {
-                            if( cur->getFieldDensity() > 1 && one_in( 3 ) ) {
-                                // Basically: Scan around for a spot,
-                                // if there is more fire there, make it bigger and give it some fuel.
-                                // This is how big fires spend their excess age:
-                                // making other fires bigger. Flashpoint.
-                                const size_t end_it = (size_t)rng( 0, neighs.size() - 1 );
-                                for( size_t i = ( end_it + 1 ) % neighs.size();
-                                     i != end_it && cur->getFieldAge() < 0;
-                                     i = ( i + 1 ) % neighs.size() ) {
-                                    maptile &dst = neighs[i];
-                                    auto dstfld = dst.find_field( fd_fire );
-                                    // If the fire exists and is weaker than ours, boost it
-                                    if( dstfld != nullptr &&
-                                        ( dstfld->getFieldDensity() <= cur->getFieldDensity() ||
-                                          dstfld->getFieldAge() > cur->getFieldAge() ) &&
-                                        ( in_pit == ( dst.get_ter() == t_pit) ) ) {
-                                        if( dstfld->getFieldDensity() < 2 ) {
-                                            dstfld->setFieldDensity(dstfld->getFieldDensity() + 1);
-                                        }
-
-                                        dstfld->setFieldAge( dstfld->getFieldAge() - MINUTES(5) );
-                                        cur->setFieldAge( cur->getFieldAge() + MINUTES(5) );
-                                    }
-
-                                    if( dstfld != nullptr ) {
-                                        adjacent_fires++;
-                                    }
-                                }
-                            } else if( cur->getFieldAge() < 0 && cur->getFieldDensity() < 3 ) {
-                                // See if we can grow into a stage 2/3 fire, for this
-                                // burning neighbours are necessary in addition to
-                                // field age < 0, or alternatively, a LOT of fuel.
-
-                                // The maximum fire density is 1 for a lone fire, 2 for at least 1 neighbour,
-                                // 3 for at least 2 neighbours.
-                                int maximum_density =  1;
-
-                                // The following logic looks a bit complex due to optimization concerns, so here are the semantics:
-                                // 1. Calculate maximum field density based on fuel, -50 minutes is 2(medium), -500 minutes is 3(raging)
-                                // 2. Calculate maximum field density based on neighbours, 3 neighbours is 2(medium), 7 or more neighbours is 3(raging)
-                                // 3. Pick the higher maximum between 1. and 2.
-                                if( cur->getFieldAge() < -MINUTES(500) ) {
-                                    maximum_density = 3;
-                                } else {
-                                    for( size_t i = 0; i < neighs.size(); i++ ) {
-                                        if( neighs[i].get_field().findField( fd_fire ) != nullptr ) {
-                                            adjacent_fires++;
-                                        }
-                                    }
-                                    maximum_density = 1 + (adjacent_fires >= 3) + (adjacent_fires >= 7);
-
-                                    if( maximum_density < 2 && cur->getFieldAge() < -MINUTES(50) ) {
-                                        maximum_density = 2;
-                                    }
-                                }
-
-                                // If we consumed a lot, the flames grow higher
-                                if( cur->getFieldDensity() < maximum_density && cur->getFieldAge() < 0 ) {
-                                    // Fires under 0 age grow in size. Level 3 fires under 0 spread later on.
-                                    // Weaken the newly-grown fire
-                                    cur->setFieldDensity( cur->getFieldDensity() + 1 );
-                                    cur->setFieldAge( cur->getFieldAge() + MINUTES( cur->getFieldDensity() * 10 ) );
-                                }
-                            }
-                        }
-
-                        // Consume adjacent fuel / terrain / webs to spread.
-                        // Allow raging fires (and only raging fires) to spread up
-                        // Spreading down is achieved by wrecking the walls/floor and then falling
-                        if( zlevels && cur->getFieldDensity() == 3 && p.z < OVERMAP_HEIGHT ) {
-                            // Let it burn through the floor
-                            maptile dst = maptile_at_internal( {p.x, p.y, p.z + 1} );
-                            const auto &dst_ter = dst.get_ter_t();
-                            if( dst_ter.has_flag( TFLAG_NO_FLOOR ) ||
-                                dst_ter.has_flag( TFLAG_FLAMMABLE ) ||
-                                dst_ter.has_flag( TFLAG_FLAMMABLE_ASH ) ||
-                                dst_ter.has_flag( TFLAG_FLAMMABLE_HARD ) ) {
-                                field_entry *nearfire = dst.find_field( fd_fire );
-                                if( nearfire != nullptr ) {
-                                    nearfire->setFieldAge( nearfire->getFieldAge() - MINUTES(2) );
-                                } else {
-                                    dst.add_field( fd_fire, 1, 0 );
-                                }
-                                // Fueling fires above doesn't cost fuel
-                            }
-                        }
-
-                        // Our iterator will start at end_i + 1 and increment from there and then wrap around.
-                        // This guarantees it will check all neighbors, starting from a random one
-                        const size_t end_i = (size_t)rng( 0, neighs.size() - 1 );
-                        for( size_t i = ( end_i + 1 ) % neighs.size();
-                             i != end_i; i = ( i + 1 ) % neighs.size() ) {
-                            if( one_in( cur->getFieldDensity() * 2 ) ) {
-                                // Skip some processing to save on CPU
-                                continue;
-                            }
-
-                            maptile &dst = neighs[i];
-                            // No bounds checking here: we'll treat the invalid neighbors as valid.
-                            // We're using the maptile wrapper, so we can treat invalid tiles as sentinels.
-                            // This will create small oddities on map edges, but nothing more noticeable than
-                            // "cut-off" that happenes with bounds checks.
-
-                            field_entry *nearfire = dst.find_field(fd_fire);
-                            if( nearfire != nullptr ) {
-                                // We handled supporting fires in the section above, no need to do it here
-                                continue;
-                            }
-
-                            field_entry *nearwebfld = dst.find_field(fd_web);
-                            int spread_chance = 25 * (cur->getFieldDensity() - 1);
-                            if( nearwebfld != nullptr ) {
-                                spread_chance = 50 + spread_chance / 2;
-                            }
-
-                            const auto &dster = dst.get_ter_t();
-                            const auto &dsfrn = dst.get_furn_t();
-                            // Allow weaker fires to spread occasionally
-                            const int power = cur->getFieldDensity() + one_in( 5 );
-                            if( can_spread && rng(1, 100) < spread_chance &&
-                                  (in_pit == (dster.id.id() == t_pit)) &&
-                                  (
-                                    (power >= 3 && cur->getFieldAge() < 0 && one_in( 20 ) ) ||
-                                    (power >= 2 && ( ter_furn_has_flag( dster, dsfrn, TFLAG_FLAMMABLE ) && one_in(2) ) ) ||
-                                    (power >= 2 && ( ter_furn_has_flag( dster, dsfrn, TFLAG_FLAMMABLE_ASH ) && one_in(2) ) ) ||
-                                    (power >= 3 && ( ter_furn_has_flag( dster, dsfrn, TFLAG_FLAMMABLE_HARD ) && one_in(5) ) ) ||
-                                    nearwebfld || ( dst.get_item_count() > 0 && flammable_items_at( offset_by_index( i, p ) ) && one_in(5) )
-                                  ) ) {
-                                dst.add_field( fd_fire, 1, 0 ); // Nearby open flammable ground? Set it on fire.
-                                tmpfld = dst.find_field(fd_fire);
-                                if( tmpfld != nullptr ) {
-                                    // Make the new fire quite weak, so that it doesn't start jumping around instantly
-                                    tmpfld->setFieldAge( MINUTES(2) );
-                                    // Consume a bit of our fuel
-                                    cur->setFieldAge( cur->getFieldAge() + MINUTES(1) );
-                                }
-                                if( nearwebfld ) {
-                                    nearwebfld->setFieldDensity( 0 );
-                                }
-                            }
-                        }
-
-                        // Create smoke once - above us if possible, at us otherwise
-                        if( !ter_furn_has_flag( ter, frn, TFLAG_SUPPRESS_SMOKE ) &&
-                            rng(0, 100) <= smoke &&
-                            rng(3, 35) < cur->getFieldDensity() * 10 ) {
-                                bool smoke_up = zlevels && p.z < OVERMAP_HEIGHT;
-                                if( smoke_up ) {
-                                    tripoint up{p.x, p.y, p.z + 1};
-                                    maptile dst = maptile_at_internal( up );
-                                    const auto &dst_ter = dst.get_ter_t();
-                                    if( dst_ter.has_flag( TFLAG_NO_FLOOR ) ) {
-                                        dst.add_field( fd_smoke, rng( 1, cur->getFieldDensity() ), 0 );
-                                    } else {
-                                        // Can't create smoke above
-                                        smoke_up = false;
-                                    }
-                                }
-
-                                if( !smoke_up ) {
-                                    maptile dst = maptile_at_internal( p );
-                                    // Create thicker smoke
-                                    dst.add_field( fd_smoke, cur->getFieldDensity(), 0 );
-                                }
-
-                                dirty_transparency_cache = true; // Smoke affects transparency
-                            }
-
-                        // Hot air is a heavy load on the CPU and it doesn't do much
-                        // Don't produce too much of it if we have a lot fires nearby, they produce
-                        // radiant heat which does what hot air would do anyway
-                        if( rng( 0, adjacent_fires ) > 2 ) {
-                            create_hot_air( p, cur->getFieldDensity() );
-                        }
+                        // Feeding and setting fire to the neighbours is planned for all fires at once,
+                        // after every tile burned, see plan_fire_spread
+                        fires.push_back( { p, smoke } );
                     }
                     break;
 
-                    case fd_smoke:
-                        dirty_transparency_cache = true;
-                        spread_gas( cur, p, curtype, 50, 0 );
-                        break;
-
-                    case fd_tear_gas:
-                        dirty_transparency_cache = true;
-                        spread_gas( cur, p, curtype, 30, 0 );
-                        break;
-
-                    case fd_relax_gas:
-                        dirty_transparency_cache = true;
-                        spread_gas( cur, p, curtype, 25, 50 );
-                        break;
-
                     case fd_fungal_haze:
                         dirty_transparency_cache = true;
                         spread_gas( cur, p, curtype, 33,  5);
@@ -1193,16 +1572,6 @@ bool map::process_fields_in_submap( submap *const current_submap,
 
                         break;
 
-                    case fd_toxic_gas:
-                        dirty_transparency_cache = true;
-                        spread_gas( cur, p, curtype, 50, 30 );
-                        break;
-
-                    case fd_cigsmoke:
-                        dirty_transparency_cache = true;
-                        spread_gas( cur, p, curtype, 250, 65 );
-                        break;
-
                     case fd_weedsmoke:
                     {
                         dirty_transparency_cache = true;
@@ -1258,14 +1627,6 @@ bool map::process_fields_in_submap( submap *const current_submap,
                         break;
                     }
 
-                    case fd_hot_air1:
-                    case fd_hot_air2:
-                    case fd_hot_air3:
-                    case fd_hot_air4:
-                        // No transparency cache wrecking here!
-                        spread_gas( cur, p, curtype, 100, 1000 );
-                        break;
-
                     case fd_gas_vent:
                     {
                         dirty_transparency_cache = true;
@@ -1607,6 +1968,9 @@ bool map::process_fields_in_submap( submap *const current_submap,
                     ++it;
                 }
             }
+            if( curfield.fieldCount() == 0 ) {
+                current_submap->clear_field_tile( locx, locy );
+            }
         }
     }
     return dirty_transparency_cache;
@@ -2434,13 +2798,61 @@ int field_entry::setFieldAge(const int new_age){
 }
 
 field::field()
-    : field_list()
+    : entries()
+    , overflow()
     , draw_symbol( fd_null )
 {
 }
 
+field::field( const field &other )
+    : entries( other.entries )
+    , overflow()
+    , draw_symbol( other.draw_symbol )
+{
+    std::unique_ptr<overflow_entry> *tail = &overflow;
+    for( const overflow_entry *e = other.overflow.get(); e != nullptr; e = e->next.get() ) {
+        tail->reset( new overflow_entry{ e->value, nullptr } );
+        tail = &( *tail )->next;
+    }
+}
+
+field &field::operator=( const field &rhs )
+{
+    if( this != &rhs ) {
+        field copy( rhs );
+        *this = std::move( copy );
+    }
+    return *this;
+}
+
 field::~field()
 {
+    // Unlink the list one by one, a recursive destruction could run out of stack
+    while( overflow ) {
+        overflow = std::move( overflow->next );
+    }
+}
+
+const field::value_type *field::entry_after( const field_id type ) const
+{
+    const value_type *found = nullptr;
+    const auto consider = [&]( const value_type & e ) {
+        if( e.first > type && ( found == nullptr || e.first < found->first ) ) {
+            found = &e;
+        }
+    };
+    for( const value_type &e : entries ) {
+        consider( e );
+    }
+    for( const overflow_entry *e = overflow.get(); e != nullptr; e = e->next.get() ) {
+        consider( e->value );
+    }
+    return found;
+}
+
+field::value_type *field::entry_after( const field_id type )
+{
+    return const_cast<value_type *>( static_cast<const field *>( this )->entry_after( type ) );
 }
 
 /*
@@ -2450,18 +2862,23 @@ Good for checking for exitence of a field: if(myfield.findField(fd_fire)) would
 */
 field_entry *field::findField( const field_id field_to_find )
 {
-    const auto it = field_list.find( field_to_find );
-    if( it != field_list.end() ) {
-        return &it->second;
-    }
-    return nullptr;
+    return const_cast<field_entry *>( findFieldc( field_to_find ) );
 }
 
 const field_entry *field::findFieldc( const field_id field_to_find ) const
 {
-    const auto it = field_list.find( field_to_find );
-    if( it != field_list.end() ) {
-        return &it->second;
+    if( field_to_find == fd_null ) {
+        return nullptr;
+    }
+    for( const value_type &e : entries ) {
+        if( e.first == field_to_find ) {
+            return &e.second;
+        }
+    }
+    for( const overflow_entry *e = overflow.get(); e != nullptr; e = e->next.get() ) {
+        if( e->value.first == field_to_find ) {
+            return &e->value.second;
+        }
     }
     return nullptr;
 }
@@ -2480,41 +2897,65 @@ If you wish to modify an already existing field use findField and modify the res
 Density defaults to 1, and age to 0 (permanent) if not specified.
 */
 bool field::addField(const field_id field_to_add, const int new_density, const int new_age){
-    auto it = field_list.find(field_to_add);
+    if( field_to_add == fd_null ) {
+        return false;
+    }
+    field_entry *const existing = findField( field_to_add );
     if (fieldlist[field_to_add].priority >= fieldlist[draw_symbol].priority)
         draw_symbol = field_to_add;
-    if(it != field_list.end()) {
+    if( existing != nullptr ) {
         //Already exists, but lets update it. This is tentative.
-        it->second.setFieldDensity(it->second.getFieldDensity() + new_density);
+        existing->setFieldDensity( existing->getFieldDensity() + new_density );
         return false;
     }
-    field_list[field_to_add] = field_entry(field_to_add, new_density, new_age);
+    const value_type added( field_to_add, field_entry( field_to_add, new_density, new_age ) );
+    for( value_type &e : entries ) {
+        if( e.first == fd_null ) {
+            e = added;
+            return true;
+        }
+    }
+    // Prepending keeps all other entries where they are
+    std::unique_ptr<overflow_entry> e( new overflow_entry{ added, std::move( overflow ) } );
+    overflow = std::move( e );
     return true;
 }
 
 bool field::removeField( field_id const field_to_remove )
 {
-    const auto it = field_list.find( field_to_remove );
-    if( it == field_list.end() ) {
+    if( field_to_remove == fd_null ) {
         return false;
     }
-    removeField( it );
-    return true;
+    for( value_type &e : entries ) {
+        if( e.first == field_to_remove ) {
+            e = value_type();
+            update_draw_symbol();
+            return true;
+        }
+    }
+    for( std::unique_ptr<overflow_entry> *e = &overflow; *e; e = &( *e )->next ) {
+        if( ( *e )->value.first == field_to_remove ) {
+            *e = std::move( ( *e )->next );
+            update_draw_symbol();
+            return true;
+        }
+    }
+    return false;
 }
 
-void field::removeField( std::map<field_id, field_entry>::iterator const it )
+void field::removeField( iterator const it )
 {
-        field_list.erase( it );
-        if( field_list.empty() ) {
-            draw_symbol = fd_null;
-        } else {
-            draw_symbol = fd_null;
-            for( auto &fld : field_list ) {
-                if (fieldlist[fld.first].priority >= fieldlist[draw_symbol].priority) {
-                    draw_symbol = fld.first;
-                }
-            }
+    removeField( it->first );
+}
+
+void field::update_draw_symbol()
+{
+    draw_symbol = fd_null;
+    for( auto &fld : *this ) {
+        if (fieldlist[fld.first].priority >= fieldlist[draw_symbol].priority) {
+            draw_symbol = fld.first;
         }
+    }
 }
 
 /*
@@ -2523,27 +2964,34 @@ Returns the number of fields existing on the current tile.
 */
 unsigned int field::fieldCount() const
 {
-    return field_list.size();
+    unsigned int count = 0;
+    for( const value_type &e : entries ) {
+        count += e.first != fd_null;
+    }
+    for( const overflow_entry *e = overflow.get(); e != nullptr; e = e->next.get() ) {
+        count++;
+    }
+    return count;
 }
 
-std::map<field_id, field_entry>::iterator field::begin()
+field::iterator field::begin()
 {
-    return field_list.begin();
+    return iterator( this, entry_after( fd_null ) );
 }
 
-std::map<field_id, field_entry>::const_iterator field::begin() const
+field::const_iterator field::begin() const
 {
-    return field_list.begin();
+    return const_iterator( this, entry_after( fd_null ) );
 }
 
-std::map<field_id, field_entry>::iterator field::end()
+field::iterator field::end()
 {
-    return field_list.end();
+    return iterator( this, nullptr );
 }
 
-std::map<field_id, field_entry>::const_iterator field::end() const
+field::const_iterator field::end() const
 {
-    return field_list.end();
+    return const_iterator( this, nullptr );
 }
 
 std::string field_t::name( const int density ) const
@@ -2564,7 +3012,7 @@ field_id field::fieldSymbol() const
 int field::move_cost() const
 {
     int current_cost = 0;
-    for( auto & fld : field_list ) {
+    for( auto & fld : *this ) {
         current_cost += fld.second.move_cost();
     }
     return current_cost;
@@ -9,7 +9,10 @@
 #include <string>
 #include <map>
 #include <iosfwd>
+#include <iterator>
 #include <array>
+#include <memory>
+#include <utility>
 
 enum phase_id : int;
 
@@ -190,7 +193,7 @@ public:
     }
 
     //Returns true if this is an active field, false if it should be removed.
-    bool isAlive(){
+    bool isAlive() const {
         return is_alive;
     }
 
@@ -213,10 +216,63 @@ private:
  * Use @ref findField to get the field entry of a specific type, or iterate over
  * all entries via @ref begin and @ref end (allows range based iteration).
  * There is @ref fieldSymbol to specific which field should be drawn on the map.
+ *
+ * Most tiles hold no more than two fields, those entries are stored in the field itself.
+ * Further entries are allocated one by one, so entries never move: pointers and iterators
+ * stay valid when other fields are added or removed, the same as they would in a std::map.
+ * Iteration visits the entries ordered by their type.
 */
 class field{
 public:
+    using value_type = std::pair<field_id, field_entry>;
+
+    template<typename Field, typename Value>
+    class basic_iterator
+    {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Value;
+            using difference_type = std::ptrdiff_t;
+            using pointer = Value *;
+            using reference = Value &;
+
+            Value &operator*() const {
+                return *entry;
+            }
+            Value *operator->() const {
+                return entry;
+            }
+            basic_iterator &operator++() {
+                entry = owner->entry_after( entry->first );
+                return *this;
+            }
+            basic_iterator operator++( int ) {
+                basic_iterator old = *this;
+                ++*this;
+                return old;
+            }
+            bool operator==( const basic_iterator &rhs ) const {
+                return entry == rhs.entry;
+            }
+            bool operator!=( const basic_iterator &rhs ) const {
+                return entry != rhs.entry;
+            }
+
+        private:
+            friend class field;
+            basic_iterator( Field *owner, Value *entry ) : owner( owner ), entry( entry ) { }
+
+            Field *owner;
+            Value *entry;
+    };
+    using iterator = basic_iterator<field, value_type>;
+    using const_iterator = basic_iterator<const field, const value_type>;
+
     field();
+    field( const field &other );
+    field( field && ) = default;
+    field &operator=( const field &rhs );
+    field &operator=( field && ) = default;
     ~field();
 
     /**
@@ -253,9 +309,9 @@ public:
     bool removeField( field_id field_to_remove );
     /**
      * Make sure to decrement the field counter in the submap.
-     * Removes the field entry, the iterator must point into @ref field_list and must be valid.
+     * Removes the field entry, the iterator must point into this field and must be valid.
      */
-    void removeField( std::map<field_id, field_entry>::iterator );
+    void removeField( iterator it );
 
     //Returns the number of fields existing on the current tile.
     unsigned int fieldCount() const;
@@ -265,13 +321,13 @@ public:
      */
     field_id fieldSymbol() const;
 
-    //Returns the vector iterator to begin searching through the list.
-    std::map<field_id, field_entry>::iterator begin();
-    std::map<field_id, field_entry>::const_iterator begin() const;
+    //Returns the iterator to begin searching through the list.
+    iterator begin();
+    const_iterator begin() const;
 
-    //Returns the vector iterator to end searching through the list.
-    std::map<field_id, field_entry>::iterator end();
-    std::map<field_id, field_entry>::const_iterator end() const;
+    //Returns the iterator to end searching through the list.
+    iterator end();
+    const_iterator end() const;
 
     /**
      * Returns the total move cost from all fields.
@@ -279,7 +335,21 @@ public:
     int move_cost() const;
 
 private:
-    std::map<field_id, field_entry> field_list; //A pointer lookup table of all field effects on the current tile.    //Draw_symbol currently is equal to the last field added to the square. You can modify this behavior in the class functions if you wish.
+    /** Entries beyond the ones stored in place, as a singly linked list. */
+    struct overflow_entry {
+        value_type value;
+        std::unique_ptr<overflow_entry> next;
+    };
+
+    /** The entry with the lowest type above the given one, nullptr if there is none. */
+    const value_type *entry_after( field_id type ) const;
+    value_type *entry_after( field_id type );
+    void update_draw_symbol();
+
+    // The first field effects on the current tile, fd_null marks an unused slot.
+    std::array<value_type, 2> entries;
+    std::unique_ptr<overflow_entry> overflow;
+    //Draw_symbol currently is equal to the last field added to the square. You can modify this behavior in the class functions if you wish.
     field_id draw_symbol;
 };
 
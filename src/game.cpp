@@ -75,6 +75,7 @@
 #include "event.h"
 #include "coordinates.h"
 #include "creature_tracker.h"
+#include "worker_pool.h"
 #include "vehicle.h"
 #include "submap.h"
 #include "mapgen_functions.h"
@@ -105,6 +106,7 @@
 #include <sstream>
 #include <cmath>
 #include <vector>
+#include <unordered_map>
 #include <locale>
 #include <cassert>
 #include <iterator>
@@ -1402,6 +1404,7 @@ bool game::do_turn()
     if (is_game_over()) {
         return cleanup_at_end();
     }
+    get_map_cache_stats() = map_cache_stats();
     // Actual stuff
     if( new_game ) {
         new_game = false;
@@ -1518,7 +1521,7 @@ bool game::do_turn()
 
     // Process power and fuel consumption for all vehicles, including off-map ones.
     // m.vehmove used to do this, but now it only give them moves instead.
-    for( auto &elem : MAPBUFFER ) {
+    for( auto &elem : MAPBUFFER.vehicle_submaps() ) {
         tripoint sm_loc = elem.first;
         point sm_topleft = sm_to_ms_copy(sm_loc.x, sm_loc.y);
         point in_reality = m.getlocal(sm_topleft);
@@ -1527,6 +1530,9 @@ bool game::do_turn()
 
         const bool in_bubble_z = m.has_zlevels() || sm_loc.z == get_levz();
         for( auto &veh : sm->vehicles ) {
+            if( veh->is_dormant() ) {
+                continue;
+            }
             veh->power_parts();
             veh->idle( in_bubble_z && m.inbounds(in_reality.x, in_reality.y) );
         }
@@ -4079,7 +4085,7 @@ void game::debug()
             popup_top(
                 s.c_str(),
                 u.posx(), u.posy(), get_levx(), get_levy(),
-                overmap_buffer.ter( u.global_omt_location() )->get_name().c_str(),
+                overmap_buffer.get_ter( u.global_omt_location() )->get_name().c_str(),
                 int( calendar::turn ), int( nextspawn ),
                 ( get_option<bool>( "RANDOM_NPC" ) ? _( "NPCs are going to spawn." ) :
                   _( "NPCs are NOT going to spawn." ) ),
@@ -4911,7 +4917,7 @@ void game::draw_sidebar()
         wprintz( time_window, c_white, _( "Time: ???") );
     }
 
-    const oter_id &cur_ter = overmap_buffer.ter(u.global_omt_location());
+    const oter_id &cur_ter = overmap_buffer.get_ter(u.global_omt_location());
 
     werase(w_location);
     mvwprintz(w_location, 0, 0, cur_ter->get_color(), "%s", utf8_truncate( cur_ter->get_name(), 14 ).c_str());
@@ -5356,7 +5362,7 @@ void game::draw_minimap()
                 ter_color = c_cyan;
                 ter_sym = 'c';
             } else {
-                const oter_id &cur_ter = overmap_buffer.ter(omx, omy, get_levz());
+                const oter_id &cur_ter = overmap_buffer.get_ter(omx, omy, get_levz());
                 ter_sym = cur_ter->get_sym();
                 if (overmap_buffer.is_explored(omx, omy, get_levz())) {
                     ter_color = c_dkgray;
@@ -5906,21 +5912,67 @@ void game::monmove()
 
     mfactions monster_factions;
     const auto &playerfaction = mfaction_str_id( "player" );
+    const auto update_factions = [&]() {
+        // monster::plan() needs to know about all monsters on the same team as the monster.
+        monster_factions.clear();
+        for( monster &critter : all_monsters() ) {
+            if( critter.friendly == 0 ) {
+                // Only 1 faction per mon at the moment.
+                monster_factions[ critter.faction ].insert( &critter );
+            } else {
+                monster_factions[ playerfaction ].insert( &critter );
+            }
+        }
+        cached_lev = m.get_abs_sub();
+    };
+
+    // With several threads, the monsters about to move all plan at once, against the state
+    // at the start of the turn, and act on that plan in their first move.
+    // Plans refer to monsters by address, the weak pointers tell whether the planner and the
+    // target are still around, and not a creature spawned since at the address of a removed one.
+    struct pending_plan {
+        std::weak_ptr<monster> planner;
+        std::weak_ptr<Creature> target;
+        monster_plan plan;
+    };
+    std::unordered_map<const monster *, pending_plan> plans;
+    if( worker_pool *workers = shared_workers() ) {
+        update_factions();
+        std::unordered_map<const Creature *, std::weak_ptr<Creature>> creatures;
+        std::vector<std::shared_ptr<monster>> planners;
+        for( const auto &critter : critter_tracker->get_monsters_list() ) {
+            creatures.emplace( critter.get(), critter );
+            if( !critter->is_dead() && critter->moves > 0 && !critter->has_effect( effect_controlled ) ) {
+                planners.push_back( critter );
+            }
+        }
+        for( const auto &guy : active_npc ) {
+            creatures.emplace( guy.get(), guy );
+        }
+        // Fill the lazily computed light levels before the workers look at them.
+        for( int z = 0; z <= OVERMAP_HEIGHT; z++ ) {
+            natural_light_level( z );
+        }
+        std::vector<monster_plan> planned( planners.size() );
+        workers->run( planners.size(), [&]( const int index, int ) {
+            planned[index] = planners[index]->compute_plan( monster_factions );
+        } );
+        for( size_t i = 0; i < planners.size(); i++ ) {
+            pending_plan &pending = plans[planners[i].get()];
+            pending.planner = planners[i];
+            pending.plan = planned[i];
+            const auto target = creatures.find( planned[i].target );
+            if( target != creatures.end() ) {
+                pending.target = target->second;
+            }
+        }
+    }
+
     for( monster &critter : all_monsters() ) {
         // The first time through, and any time the map has been shifted,
         // recalculate monster factions.
         if( cached_lev != m.get_abs_sub() ) {
-            // monster::plan() needs to know about all monsters on the same team as the monster.
-            monster_factions.clear();
-            for( monster &critter : all_monsters() ) {
-                if( critter.friendly == 0 ) {
-                    // Only 1 faction per mon at the moment.
-                    monster_factions[ critter.faction ].insert( &critter );
-                } else {
-                    monster_factions[ playerfaction ].insert( &critter );
-                }
-            }
-            cached_lev = m.get_abs_sub();
+            update_factions();
         }
 
         while (!critter.is_dead() && !critter.can_move_to(critter.pos())) {
@@ -5961,8 +6013,23 @@ void game::monmove()
             critter.made_footstep = false;
             // Controlled critters don't make their own plans
             if (!critter.has_effect( effect_controlled)) {
-                // Formulate a path to follow
-                critter.plan( monster_factions );
+                auto planned = plans.find( &critter );
+                if( planned != plans.end() && planned->second.planner.lock().get() != &critter ) {
+                    // Spawned at the address of a removed monster, the plan isn't ours
+                    plans.erase( planned );
+                    planned = plans.end();
+                }
+                if( planned != plans.end() ) {
+                    monster_plan &plan = planned->second.plan;
+                    if( plan.target != nullptr && plan.target != &u && planned->second.target.expired() ) {
+                        plan.target = nullptr;
+                    }
+                    critter.apply_plan( plan );
+                    plans.erase( planned );
+                } else {
+                    // Formulate a path to follow
+                    critter.plan( monster_factions );
+                }
             }
             critter.move(); // Move one square, possibly hit u
             critter.process_triggers();
@@ -12951,8 +13018,8 @@ void game::vertical_notes( int z_before, int z_after )
                 // Already has a note -> never add an AUTO-note
                 continue;
             }
-            const oter_id &ter = overmap_buffer.ter(cursx, cursy, z_before);
-            const oter_id &ter2 = overmap_buffer.ter(cursx, cursy, z_after);
+            const oter_id &ter = overmap_buffer.get_ter(cursx, cursy, z_before);
+            const oter_id &ter2 = overmap_buffer.get_ter(cursx, cursy, z_after);
             if( z_after > z_before && ter->has_flag(known_up) &&
                 !ter2->has_flag(known_down) ) {
                 overmap_buffer.set_seen(cursx, cursy, z_after, true);
@@ -13056,7 +13123,7 @@ void game::update_overmap_seen()
             int sight_points = dist;
             for (auto it = line.begin();
                  it != line.end() && sight_points >= 0; ++it) {
-                const oter_id &ter = overmap_buffer.ter(it->x, it->y, ompos.z);
+                const oter_id &ter = overmap_buffer.get_ter(it->x, it->y, ompos.z);
                 sight_points -= int( ter->get_see_cost() );
             }
             if (sight_points >= 0) {
@@ -30,6 +30,7 @@ extern game *g;
 extern bool trigdist;
 extern bool use_tiles;
 extern bool fov_3d;
+extern int worker_threads;
 extern bool tile_iso;
 
 extern const int core_version;
@@ -834,6 +835,9 @@ class game
         /** Attempt to load first valid save (if any) in world */
         bool load( const std::string &world );
 
+        /** Monster movement for one turn, part of do_turn */
+        void monmove();
+
     private:
         // Game-start procedures
         void load( std::string worldname, const save_t &name ); // Load a player-specific save file
@@ -996,7 +1000,6 @@ private:
 
         // Routine loop functions, approximately in order of execution
         void cleanup_dead();     // Delete any dead NPCs/monsters
-        void monmove();          // Monster movement
         void rustCheck();        // Degrades practice levels
         void process_events();   // Processes and enacts long-term events
         void process_activity(); // Processes and enacts the player's activity
@@ -11,9 +11,14 @@
 #include "mtype.h"
 #include "weather.h"
 #include "shadowcasting.h"
+#include "worker_pool.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
 
 #define INBOUNDS(x, y) \
     (x >= 0 && x < SEEX * MAPSIZE && y >= 0 && y < SEEY * MAPSIZE)
@@ -51,19 +56,19 @@ void map::build_transparency_cache( const int zlev )
     auto &transparency_cache = map_cache.transparency_cache;
     auto &outside_cache = map_cache.outside_cache;
 
-    if( !map_cache.transparency_cache_dirty ) {
+    if( map_cache.transparency_cache_dirty.none() ) {
         return;
     }
 
-    // Default to just barely not transparent.
-    std::uninitialized_fill_n(
-        &transparency_cache[0][0], MAPSIZE*SEEX * MAPSIZE*SEEY, static_cast<float>( LIGHT_TRANSPARENCY_OPEN_AIR ) );
-
     float sight_penalty = weather_data(g->weather).sight_penalty;
 
-    // Traverse the submaps in order
+    // Traverse the submaps in order, rebuilding only the ones that changed
     for( int smx = 0; smx < my_MAPSIZE; ++smx ) {
         for( int smy = 0; smy < my_MAPSIZE; ++smy ) {
+            if( !map_cache.transparency_cache_dirty[smx + smy * my_MAPSIZE] ) {
+                continue;
+            }
+            get_map_cache_stats().transparency_submaps++;
             auto const cur_submap = get_submap_at_grid( smx, smy, zlev );
 
             for( int sx = 0; sx < SEEX; ++sx ) {
@@ -72,6 +77,8 @@ void map::build_transparency_cache( const int zlev )
                     const int y = sy + smy * SEEY;
 
                     auto &value = transparency_cache[x][y];
+                    // Default to just barely not transparent.
+                    value = LIGHT_TRANSPARENCY_OPEN_AIR;
 
                     if( !(cur_submap->ter[sx][sy].obj().transparent &&
                           cur_submap->frn[sx][sy].obj().transparent) ) {
@@ -127,7 +134,7 @@ void map::build_transparency_cache( const int zlev )
             }
         }
     }
-    map_cache.transparency_cache_dirty = false;
+    map_cache.transparency_cache_dirty.reset();
 }
 
 void map::apply_character_light( player &p )
@@ -148,6 +155,121 @@ void map::apply_character_light( player &p )
     }
 }
 
+namespace {
+
+// Sides of a circular light source that still need rays cast into them.
+enum light_sides : int {
+    light_north = 1,
+    light_east = 2,
+    light_south = 4,
+    light_west = 8
+};
+
+/**
+ * Where a single light is cast before being merged into the lightmap.
+ * Tiles the light doesn't reach stay negative.
+ */
+struct light_canvas {
+    float ( &lm )[LIGHTMAP_CACHE_X][LIGHTMAP_CACHE_Y];
+    // Light level at the source tile
+    float sm;
+    const float ( &transparency_cache )[LIGHTMAP_CACHE_X][LIGHTMAP_CACHE_Y];
+};
+
+}
+
+/* If we're a 5 luminance fire , we skip casting rays into ey && sx if we have
+     neighboring fires to the north and west that were applied via light_source_buffer
+   If there's a 1 luminance candle east in buffer, we still cast rays into ex since it's smaller
+   If there's a 100 luminance magnesium flare south added via apply_light_source instead od
+     add_light_source, it's unbuffered so we'll still cast rays into sy.
+
+      ey
+    nnnNnnn
+    w     e
+    w  5 +e
+ sx W 5*1+E ex
+    w ++++e
+    w+++++e
+    sssSsss
+       sy
+*/
+static int light_source_sides( const float (&light_source_buffer)[LIGHTMAP_CACHE_X][LIGHTMAP_CACHE_Y],
+                               const int x, const int y, float luminance )
+{
+    if( luminance <= 1 ) {
+        return 0;
+    } else if( luminance <= 2 ) {
+        luminance = 1.49f;
+    } else if( luminance <= LIGHT_SOURCE_LOCAL ) {
+        return 0;
+    }
+
+    const int peer_inbounds = LIGHTMAP_CACHE_X - 1;
+    int sides = 0;
+    if( y != 0 && light_source_buffer[x][y - 1] < luminance ) {
+        sides |= light_north;
+    }
+    if( y != peer_inbounds && light_source_buffer[x][y + 1] < luminance ) {
+        sides |= light_south;
+    }
+    if( x != peer_inbounds && light_source_buffer[x + 1][y] < luminance ) {
+        sides |= light_east;
+    }
+    if( x != 0 && light_source_buffer[x - 1][y] < luminance ) {
+        sides |= light_west;
+    }
+    return sides;
+}
+
+static light_source_key circle_light( const float (&light_source_buffer)[LIGHTMAP_CACHE_X][LIGHTMAP_CACHE_Y],
+                                      const tripoint &p, const float luminance )
+{
+    return light_source_key { light_source_key::circle, p.x, p.y, luminance,
+                              light_source_sides( light_source_buffer, p.x, p.y, luminance ), 0 };
+}
+
+// Lights unused for this many builds are forgotten. More than one so lights blinking
+// on odd/even turns keep their contributions.
+constexpr int light_contribution_lifetime = 4;
+
+/**
+ * Forget the cached lights that were cast through tiles whose transparency changed since.
+ */
+static void drop_stale_light_contributions( level_cache &map_cache )
+{
+    const auto &transparency_cache = map_cache.transparency_cache;
+    auto &cast_through = map_cache.light_contributions_transparency;
+    const float *current = &transparency_cache[0][0];
+    const int tiles = LIGHTMAP_CACHE_X * LIGHTMAP_CACHE_Y;
+    if( std::equal( current, current + tiles, &cast_through[0][0] ) ) {
+        return;
+    }
+
+    // Summed area table of the changed tiles, so each light checks its bounds in constant time.
+    static int changed[LIGHTMAP_CACHE_X + 1][LIGHTMAP_CACHE_Y + 1];
+    for( int x = 0; x < LIGHTMAP_CACHE_X; ++x ) {
+        for( int y = 0; y < LIGHTMAP_CACHE_Y; ++y ) {
+            const int here = transparency_cache[x][y] != cast_through[x][y] ? 1 : 0;
+            changed[x + 1][y + 1] = here + changed[x][y + 1] + changed[x + 1][y] - changed[x][y];
+        }
+    }
+
+    auto &contributions = map_cache.light_contributions;
+    for( auto iter = contributions.begin(); iter != contributions.end(); ) {
+        const light_contribution &c = iter->second;
+        const bool stale = c.max_x >= c.min_x &&
+                           changed[c.max_x + 1][c.max_y + 1] - changed[c.min_x][c.max_y + 1] -
+                           changed[c.max_x + 1][c.min_y] + changed[c.min_x][c.min_y] > 0;
+        if( stale ) {
+            iter = contributions.erase( iter );
+        } else {
+            ++iter;
+        }
+    }
+    std::copy( current, current + tiles, &cast_through[0][0] );
+}
+
 void map::generate_lightmap( const int zlev )
 {
     auto &map_cache = get_cache( zlev );
@@ -157,6 +279,13 @@ void map::generate_lightmap( const int zlev )
     std::memset(lm, 0, sizeof(lm));
     std::memset(sm, 0, sizeof(sm));
 
+    // Every light is merged in from what it cast in an earlier build unless it or the
+    // transparency within its reach changed, so a quiet turn casts next to nothing.
+    map_cache.lightmap_build++;
+    map_cache.lights_cast = 0;
+    map_cache.lights_reused = 0;
+    drop_stale_light_contributions( map_cache );
+
     /* Bulk light sources wastefully cast rays into neighbors; a burning hospital can produce
          significant slowdown, so for stuff like fire and lava:
      * Step 1: Store the position and luminance in buffer via add_light_source, for efficient
@@ -370,12 +499,26 @@ void map::generate_lightmap( const int zlev )
     */
     const tripoint cache_start( 0, 0, zlev );
     const tripoint cache_end( LIGHTMAP_CACHE_X, LIGHTMAP_CACHE_Y, zlev );
+    std::vector<light_source_key> buffered_lights;
     for( const tripoint &p : points_in_rectangle( cache_start, cache_end ) ) {
         if( light_source_buffer[p.x][p.y] > 0.0 ) {
-            apply_light_source( p, light_source_buffer[p.x][p.y] );
+            buffered_lights.push_back( circle_light( light_source_buffer, p, light_source_buffer[p.x][p.y] ) );
         }
     }
+    cast_missing_lights( zlev, buffered_lights );
+    for( const light_source_key &key : buffered_lights ) {
+        apply_cached_light( zlev, key );
+    }
+
 
+    auto &contributions = map_cache.light_contributions;
+    for( auto iter = contributions.begin(); iter != contributions.end(); ) {
+        if( map_cache.lightmap_build - iter->second.last_build >= light_contribution_lifetime ) {
+            iter = contributions.erase( iter );
+        } else {
+            ++iter;
+        }
+    }
 
     if (g->u.has_active_bionic( bionic_id( "bio_night" ) ) ) {
         for( const tripoint &p : points_in_rectangle( cache_start, cache_end ) ) {
@@ -656,6 +799,118 @@ void cast_zlight(
     }
 }
 
+using layer_caches = std::array<float (*)[MAPSIZE*SEEX][MAPSIZE*SEEY], OVERMAP_LAYERS>;
+
+using sight_octant = void ( * )( float (&)[MAPSIZE*SEEX][MAPSIZE*SEEY],
+                                 const float (&)[MAPSIZE*SEEX][MAPSIZE*SEEY],
+                                 int, int, int, float, int, float, float, double );
+// The octants of the field of vision, in the order they have always been cast.
+static const std::array<sight_octant, 8> sight_octants = {{
+    castLight<0, 1, 1, 0, sight_calc, sight_check>,
+    castLight<1, 0, 0, 1, sight_calc, sight_check>,
+    castLight<0, -1, 1, 0, sight_calc, sight_check>,
+    castLight<-1, 0, 0, 1, sight_calc, sight_check>,
+    castLight<0, 1, -1, 0, sight_calc, sight_check>,
+    castLight<1, 0, 0, -1, sight_calc, sight_check>,
+    castLight<0, -1, -1, 0, sight_calc, sight_check>,
+    castLight<-1, 0, 0, -1, sight_calc, sight_check>
+}};
+
+using sight_zoctant = void ( * )( const layer_caches &,
+                                  const std::array<const float (*)[MAPSIZE*SEEX][MAPSIZE*SEEY], OVERMAP_LAYERS> &,
+                                  const std::array<const bool (*)[MAPSIZE*SEEX][MAPSIZE*SEEY], OVERMAP_LAYERS> &,
+                                  const tripoint &, int, float, int, float, float, float, float, double );
+// Same for the 3D field of vision, the first eight look down and the rest up.
+static const std::array<sight_zoctant, 16> sight_zoctants = {{
+    cast_zlight<0, 1, 0, 1, 0, 0, -1, sight_calc, sight_check>,
+    cast_zlight<1, 0, 0, 0, 1, 0, -1, sight_calc, sight_check>,
+    cast_zlight<0, -1, 0, 1, 0, 0, -1, sight_calc, sight_check>,
+    cast_zlight<-1, 0, 0, 0, 1, 0, -1, sight_calc, sight_check>,
+    cast_zlight<0, 1, 0, -1, 0, 0, -1, sight_calc, sight_check>,
+    cast_zlight<1, 0, 0, 0, -1, 0, -1, sight_calc, sight_check>,
+    cast_zlight<0, -1, 0, -1, 0, 0, -1, sight_calc, sight_check>,
+    cast_zlight<-1, 0, 0, 0, -1, 0, -1, sight_calc, sight_check>,
+    cast_zlight<0, 1, 0, 1, 0, 0, 1, sight_calc, sight_check>,
+    cast_zlight<1, 0, 0, 0, 1, 0, 1, sight_calc, sight_check>,
+    cast_zlight<0, -1, 0, 1, 0, 0, 1, sight_calc, sight_check>,
+    cast_zlight<-1, 0, 0, 0, 1, 0, 1, sight_calc, sight_check>,
+    cast_zlight<0, 1, 0, -1, 0, 0, 1, sight_calc, sight_check>,
+    cast_zlight<1, 0, 0, 0, -1, 0, 1, sight_calc, sight_check>,
+    cast_zlight<0, -1, 0, -1, 0, 0, 1, sight_calc, sight_check>,
+    cast_zlight<-1, 0, 0, 0, -1, 0, 1, sight_calc, sight_check>
+}};
+
+/**
+ * Runs the octants cast from origin on the workers. Each worker casts into its own copy of
+ * outputs (null entries are layers that aren't cast into), and the copies are merged back with
+ * max(). Casting only ever raises values, so the result is bit-identical to casting the
+ * octants one after another into outputs, whichever worker took which octant.
+ */
+static void cast_in_parallel( worker_pool &workers, const layer_caches &outputs, const tripoint &origin,
+                              const int octants, const std::function<void( int, const layer_caches & )> &cast )
+{
+    // Octants are cast no further than 60 tiles.
+    const int min_x = std::max( origin.x - 60, 0 );
+    const int min_y = std::max( origin.y - 60, 0 );
+    const int max_x = std::min( origin.x + 60, LIGHTMAP_CACHE_X - 1 );
+    const int max_y = std::min( origin.y + 60, LIGHTMAP_CACHE_Y - 1 );
+    const int tiles = LIGHTMAP_CACHE_X * LIGHTMAP_CACHE_Y;
+
+    static std::vector<std::vector<float>> scratch;
+    scratch.resize( workers.size() );
+    std::vector<layer_caches> worker_outputs( workers.size() );
+    std::vector<char> used( workers.size(), 0 );
+    workers.run( octants, [&]( const int octant, const int worker ) {
+        layer_caches &local = worker_outputs[worker];
+        if( !used[worker] ) {
+            used[worker] = 1;
+            auto &buffer = scratch[worker];
+            buffer.resize( OVERMAP_LAYERS * tiles );
+            for( int layer = 0; layer < OVERMAP_LAYERS; layer++ ) {
+                if( outputs[layer] == nullptr ) {
+                    continue;
+                }
+                local[layer] = reinterpret_cast<float (*)[MAPSIZE*SEEX][MAPSIZE*SEEY]>( &buffer[layer * tiles] );
+                for( int x = min_x; x <= max_x; x++ ) {
+                    std::fill( &( *local[layer] )[x][min_y], &( *local[layer] )[x][max_y] + 1,
+                               std::numeric_limits<float>::lowest() );
+                }
+            }
+        }
+        cast( octant, local );
+    } );
+
+    for( int worker = 0; worker < workers.size(); worker++ ) {
+        if( !used[worker] ) {
+            continue;
+        }
+        for( int layer = 0; layer < OVERMAP_LAYERS; layer++ ) {
+            if( outputs[layer] == nullptr ) {
+                continue;
+            }
+            auto &output = *outputs[layer];
+            const auto &local = *worker_outputs[worker][layer];
+            for( int x = min_x; x <= max_x; x++ ) {
+                for( int y = min_y; y <= max_y; y++ ) {
+                    output[x][y] = std::max( output[x][y], local[x][y] );
+                }
+            }
+        }
+    }
+}
+
+void map::cast_sight( const tripoint &origin, float (&output)[MAPSIZE*SEEX][MAPSIZE*SEEY] ) const
+{
+    const auto &transparency_cache = get_cache_ref( origin.z ).transparency_cache;
+    constexpr float light_transparency_solid = LIGHT_TRANSPARENCY_SOLID;
+    std::uninitialized_fill_n( &output[0][0], MAPSIZE*SEEX * MAPSIZE*SEEY, light_transparency_solid );
+    output[origin.x][origin.y] = LIGHT_TRANSPARENCY_CLEAR;
+    for( const sight_octant cast_octant : sight_octants ) {
+        cast_octant( output, transparency_cache, origin.x, origin.y, 0,
+                     1.0f, 1, 1.0f, 0.0f, LIGHT_TRANSPARENCY_OPEN_AIR );
+    }
+}
+
 /**
  * Calculates the Field Of View for the provided map from the given x, y
  * coordinates. Returns a lightmap for a result where the values represent a
@@ -681,25 +936,22 @@ void map::build_seen_cache( const tripoint &origin, const int target_z )
     if( !fov_3d ) {
         seen_cache[origin.x][origin.y] = LIGHT_TRANSPARENCY_CLEAR;
 
-        castLight<0, 1, 1, 0, sight_calc, sight_check>(
-            seen_cache, transparency_cache, origin.x, origin.y, 0 );
-        castLight<1, 0, 0, 1, sight_calc, sight_check>(
-            seen_cache, transparency_cache, origin.x, origin.y, 0 );
-
-        castLight<0, -1, 1, 0, sight_calc, sight_check>(
-            seen_cache, transparency_cache, origin.x, origin.y, 0 );
-        castLight<-1, 0, 0, 1, sight_calc, sight_check>(
-            seen_cache, transparency_cache, origin.x, origin.y, 0 );
-
-        castLight<0, 1, -1, 0, sight_calc, sight_check>(
-            seen_cache, transparency_cache, origin.x, origin.y, 0 );
-        castLight<1, 0, 0, -1, sight_calc, sight_check>(
-            seen_cache, transparency_cache, origin.x, origin.y, 0 );
-
-        castLight<0, -1, -1, 0, sight_calc, sight_check>(
-            seen_cache, transparency_cache, origin.x, origin.y, 0 );
-        castLight<-1, 0, 0, -1, sight_calc, sight_check>(
-            seen_cache, transparency_cache, origin.x, origin.y, 0 );
+        const auto cast_octant = [&]( const int octant, float (&output)[MAPSIZE*SEEX][MAPSIZE*SEEY] ) {
+            sight_octants[octant]( output, transparency_cache, origin.x, origin.y, 0,
+                                   1.0f, 1, 1.0f, 0.0f, LIGHT_TRANSPARENCY_OPEN_AIR );
+        };
+        if( worker_pool *workers = shared_workers() ) {
+            layer_caches outputs {};
+            outputs[0] = &seen_cache;
+            cast_in_parallel( *workers, outputs, origin, sight_octants.size(),
+            [&]( const int octant, const layer_caches &worker_outputs ) {
+                cast_octant( octant, *worker_outputs[0] );
+            } );
+        } else {
+            for( size_t octant = 0; octant < sight_octants.size(); octant++ ) {
+                cast_octant( octant, seen_cache );
+            }
+        }
     } else {
         if( origin.z == target_z ) {
             seen_cache[origin.x][origin.y] = LIGHT_TRANSPARENCY_CLEAR;
@@ -707,7 +959,7 @@ void map::build_seen_cache( const tripoint &origin, const int target_z )
 
         // Cache the caches (pointers to them)
         std::array<const float (*)[MAPSIZE*SEEX][MAPSIZE*SEEY], OVERMAP_LAYERS> transparency_caches;
-        std::array<float (*)[MAPSIZE*SEEX][MAPSIZE*SEEY], OVERMAP_LAYERS> seen_caches;
+        layer_caches seen_caches;
         std::array<const bool (*)[MAPSIZE*SEEX][MAPSIZE*SEEY], OVERMAP_LAYERS> floor_caches;
         for( int z = -OVERMAP_DEPTH; z <= OVERMAP_HEIGHT; z++ ) {
             auto &cur_cache = get_cache( z );
@@ -716,45 +968,17 @@ void map::build_seen_cache( const tripoint &origin, const int target_z )
             floor_caches[z + OVERMAP_DEPTH] = &cur_cache.floor_cache;
         }
 
-        // Down
-        cast_zlight<0, 1, 0, 1, 0, 0, -1, sight_calc, sight_check>(
-            seen_caches, transparency_caches, floor_caches, origin, 0 );
-        cast_zlight<1, 0, 0, 0, 1, 0, -1, sight_calc, sight_check>(
-            seen_caches, transparency_caches, floor_caches, origin, 0 );
-
-        cast_zlight<0, -1, 0, 1, 0, 0, -1, sight_calc, sight_check>(
-            seen_caches, transparency_caches, floor_caches, origin, 0 );
-        cast_zlight<-1, 0, 0, 0, 1, 0, -1, sight_calc, sight_check>(
-            seen_caches, transparency_caches, floor_caches, origin, 0 );
-
-        cast_zlight<0, 1, 0, -1, 0, 0, -1, sight_calc, sight_check>(
-            seen_caches, transparency_caches, floor_caches, origin, 0 );
-        cast_zlight<1, 0, 0, 0, -1, 0, -1, sight_calc, sight_check>(
-            seen_caches, transparency_caches, floor_caches, origin, 0 );
-
-        cast_zlight<0, -1, 0, -1, 0, 0, -1, sight_calc, sight_check>(
-            seen_caches, transparency_caches, floor_caches, origin, 0 );
-        cast_zlight<-1, 0, 0, 0, -1, 0, -1, sight_calc, sight_check>(
-            seen_caches, transparency_caches, floor_caches, origin, 0 );
-        cast_zlight<0, 1, 0, 1, 0, 0, 1, sight_calc, sight_check>(
-            seen_caches, transparency_caches, floor_caches, origin, 0 );
-        cast_zlight<1, 0, 0, 0, 1, 0, 1, sight_calc, sight_check>(
-            seen_caches, transparency_caches, floor_caches, origin, 0 );
-        // Up
-        cast_zlight<0, -1, 0, 1, 0, 0, 1, sight_calc, sight_check>(
-            seen_caches, transparency_caches, floor_caches, origin, 0 );
-        cast_zlight<-1, 0, 0, 0, 1, 0, 1, sight_calc, sight_check>(
-            seen_caches, transparency_caches, floor_caches, origin, 0 );
-
-        cast_zlight<0, 1, 0, -1, 0, 0, 1, sight_calc, sight_check>(
-            seen_caches, transparency_caches, floor_caches, origin, 0 );
-        cast_zlight<1, 0, 0, 0, -1, 0, 1, sight_calc, sight_check>(
-            seen_caches, transparency_caches, floor_caches, origin, 0 );
-
-        cast_zlight<0, -1, 0, -1, 0, 0, 1, sight_calc, sight_check>(
-            seen_caches, transparency_caches, floor_caches, origin, 0 );
-        cast_zlight<-1, 0, 0, 0, -1, 0, 1, sight_calc, sight_check>(
-            seen_caches, transparency_caches, floor_caches, origin, 0 );
+        const auto cast_octant = [&]( const int octant, const layer_caches &outputs ) {
+            sight_zoctants[octant]( outputs, transparency_caches, floor_caches, origin, 0,
+                                    1.0f, 1, 0.0f, 1.0f, 0.0f, 1.0f, LIGHT_TRANSPARENCY_OPEN_AIR );
+        };
+        if( worker_pool *workers = shared_workers() ) {
+            cast_in_parallel( *workers, seen_caches, origin, sight_zoctants.size(), cast_octant );
+        } else {
+            for( size_t octant = 0; octant < sight_zoctants.size(); octant++ ) {
+                cast_octant( octant, seen_caches );
+            }
+        }
     }
 
     int part;
@@ -921,21 +1145,16 @@ static bool light_check( const float &transparency, const float &intensity ) {
     return transparency > LIGHT_TRANSPARENCY_SOLID && intensity > LIGHT_AMBIENT_LOW;
 }
 
-void map::apply_light_source( const tripoint &p, float luminance )
+static void cast_light_source( light_canvas &canvas, const int x, const int y, const bool in_bounds,
+                               float luminance, const int sides )
 {
-    auto &cache = get_cache( p.z );
-    float (&lm)[MAPSIZE*SEEX][MAPSIZE*SEEY] = cache.lm;
-    float (&sm)[MAPSIZE*SEEX][MAPSIZE*SEEY] = cache.sm;
-    float (&transparency_cache)[MAPSIZE*SEEX][MAPSIZE*SEEY] = cache.transparency_cache;
-    float (&light_source_buffer)[MAPSIZE*SEEX][MAPSIZE*SEEY] = cache.light_source_buffer;
+    auto &lm = canvas.lm;
+    auto &transparency_cache = canvas.transparency_cache;
 
-    const int x = p.x;
-    const int y = p.y;
-
-    if( inbounds( p ) ) {
+    if( in_bounds ) {
         lm[x][y] = std::max(lm[x][y], static_cast<float>(LL_LOW));
         lm[x][y] = std::max(lm[x][y], luminance);
-        sm[x][y] = std::max(sm[x][y], luminance);
+        canvas.sm = std::max(canvas.sm, luminance);
     }
     if ( luminance <= 1 ) {
         return;
@@ -945,58 +1164,33 @@ void map::apply_light_source( const tripoint &p, float luminance )
         return;
     }
 
-    /* If we're a 5 luminance fire , we skip casting rays into ey && sx if we have
-         neighboring fires to the north and west that were applied via light_source_buffer
-       If there's a 1 luminance candle east in buffer, we still cast rays into ex since it's smaller
-       If there's a 100 luminance magnesium flare south added via apply_light_source instead od
-         add_light_source, it's unbuffered so we'll still cast rays into sy.
-
-          ey
-        nnnNnnn
-        w     e
-        w  5 +e
-     sx W 5*1+E ex
-        w ++++e
-        w+++++e
-        sssSsss
-           sy
-    */
-    const int peer_inbounds = LIGHTMAP_CACHE_X - 1;
-    bool north = (y != 0 && light_source_buffer[x][y - 1] < luminance );
-    bool south = (y != peer_inbounds && light_source_buffer[x][y + 1] < luminance );
-    bool east = (x != peer_inbounds && light_source_buffer[x + 1][y] < luminance );
-    bool west = (x != 0 && light_source_buffer[x - 1][y] < luminance );
-
-    if( north ) {
+    if( sides & light_north ) {
         castLight<1, 0, 0, -1, light_calc, light_check>( lm, transparency_cache, x, y, 0, luminance );
         castLight<-1, 0, 0, -1, light_calc, light_check>( lm, transparency_cache, x, y, 0, luminance );
     }
 
-    if( east ) {
+    if( sides & light_east ) {
         castLight<0, -1, 1, 0, light_calc, light_check>( lm, transparency_cache, x, y, 0, luminance );
         castLight<0, -1, -1, 0, light_calc, light_check>( lm, transparency_cache, x, y, 0, luminance );
     }
 
 
-    if( south ) {
+    if( sides & light_south ) {
         castLight<1, 0, 0, 1, light_calc, light_check>( lm, transparency_cache, x, y, 0, luminance );
         castLight<-1, 0, 0, 1, light_calc, light_check>( lm, transparency_cache, x, y, 0, luminance );
     }
 
-    if( west ) {
+    if( sides & light_west ) {
         castLight<0, 1, 1, 0, light_calc, light_check>( lm, transparency_cache, x, y, 0, luminance );
         castLight<0, 1, -1, 0, light_calc, light_check>( lm, transparency_cache, x, y, 0, luminance );
     }
 }
 
-void map::apply_directional_light( const tripoint &p, int direction, float luminance )
+static void cast_directional_light( light_canvas &canvas, const int x, const int y,
+                                    const int direction, const float luminance )
 {
-    const int x = p.x;
-    const int y = p.y;
-
-    auto &cache = get_cache( p.z );
-    float (&lm)[MAPSIZE*SEEX][MAPSIZE*SEEY] = cache.lm;
-    float (&transparency_cache)[MAPSIZE*SEEX][MAPSIZE*SEEY] = cache.transparency_cache;
+    auto &lm = canvas.lm;
+    auto &transparency_cache = canvas.transparency_cache;
 
     if( direction == 90 ) {
         castLight<1, 0, 0, -1, light_calc, light_check>( lm, transparency_cache, x, y, 0, luminance );
@@ -1013,60 +1207,8 @@ void map::apply_directional_light( const tripoint &p, int direction, float lumin
     }
 }
 
-void map::apply_light_arc( const tripoint &p, int angle, float luminance, int wideangle )
-{
-    if (luminance <= LIGHT_SOURCE_LOCAL) {
-        return;
-    }
-
-    bool lit[LIGHTMAP_CACHE_X][LIGHTMAP_CACHE_Y] {};
-
-    apply_light_source( p, LIGHT_SOURCE_LOCAL );
-
-    // Normalise (should work with negative values too)
-    const double wangle = wideangle / 2.0;
-
-    int nangle = angle % 360;
-
-    tripoint end;
-    double rad = PI * (double)nangle / 180;
-    int range = LIGHT_RANGE(luminance);
-    calc_ray_end( nangle, range, p, end );
-    apply_light_ray(lit, p, end , luminance);
-
-    tripoint test;
-    calc_ray_end(wangle + nangle, range, p, test );
-
-    const float wdist = hypot( end.x - test.x, end.y - test.y );
-    if (wdist <= 0.5) {
-        return;
-    }
-
-    // attempt to determine beam density required to cover all squares
-    const double wstep = ( wangle / ( wdist * SQRT_2 ) );
-
-    for( double ao = wstep; ao <= wangle; ao += wstep ) {
-        if( trigdist ) {
-            double fdist = (ao * HALFPI) / wangle;
-            double orad = ( PI * ao / 180.0 );
-            end.x = int( p.x + ( (double)range - fdist * 2.0) * cos(rad + orad) );
-            end.y = int( p.y + ( (double)range - fdist * 2.0) * sin(rad + orad) );
-            apply_light_ray( lit, p, end, luminance );
-
-            end.x = int( p.x + ( (double)range - fdist * 2.0) * cos(rad - orad) );
-            end.y = int( p.y + ( (double)range - fdist * 2.0) * sin(rad - orad) );
-            apply_light_ray( lit, p, end, luminance );
-        } else {
-            calc_ray_end( nangle + ao, range, p, end );
-            apply_light_ray( lit, p, end, luminance );
-            calc_ray_end( nangle - ao, range, p, end );
-            apply_light_ray( lit, p, end, luminance );
-        }
-    }
-}
-
-void map::apply_light_ray(bool lit[LIGHTMAP_CACHE_X][LIGHTMAP_CACHE_Y],
-                          const tripoint &s, const tripoint &e, float luminance)
+static void cast_light_ray( light_canvas &canvas, bool lit[LIGHTMAP_CACHE_X][LIGHTMAP_CACHE_Y],
+                            const tripoint &s, const tripoint &e, float luminance )
 {
     int ax = abs(e.x - s.x) * 2;
     int ay = abs(e.y - s.y) * 2;
@@ -1080,8 +1222,8 @@ void map::apply_light_ray(bool lit[LIGHTMAP_CACHE_X][LIGHTMAP_CACHE_Y],
         return;
     }
 
-    auto &lm = get_cache( s.z ).lm;
-    auto &transparency_cache = get_cache( s.z ).transparency_cache;
+    auto &lm = canvas.lm;
+    auto &transparency_cache = canvas.transparency_cache;
 
     float distance = 1.0;
     float transparency = LIGHT_TRANSPARENCY_OPEN_AIR;
@@ -1151,3 +1293,180 @@ void map::apply_light_ray(bool lit[LIGHTMAP_CACHE_X][LIGHTMAP_CACHE_Y],
         } while(!(x == e.x && y == e.y));
     }
 }
+
+static void cast_light_arc( light_canvas &canvas, const tripoint &p, const bool in_bounds,
+                            const int angle, const float luminance, const int wideangle )
+{
+    if (luminance <= LIGHT_SOURCE_LOCAL) {
+        return;
+    }
+
+    bool lit[LIGHTMAP_CACHE_X][LIGHTMAP_CACHE_Y] {};
+
+    cast_light_source( canvas, p.x, p.y, in_bounds, LIGHT_SOURCE_LOCAL, 0 );
+
+    // Normalise (should work with negative values too)
+    const double wangle = wideangle / 2.0;
+
+    int nangle = angle % 360;
+
+    tripoint end;
+    double rad = PI * (double)nangle / 180;
+    int range = LIGHT_RANGE(luminance);
+    calc_ray_end( nangle, range, p, end );
+    cast_light_ray( canvas, lit, p, end , luminance );
+
+    tripoint test;
+    calc_ray_end(wangle + nangle, range, p, test );
+
+    const float wdist = hypot( end.x - test.x, end.y - test.y );
+    if (wdist <= 0.5) {
+        return;
+    }
+
+    // attempt to determine beam density required to cover all squares
+    const double wstep = ( wangle / ( wdist * SQRT_2 ) );
+
+    for( double ao = wstep; ao <= wangle; ao += wstep ) {
+        if( trigdist ) {
+            double fdist = (ao * HALFPI) / wangle;
+            double orad = ( PI * ao / 180.0 );
+            end.x = int( p.x + ( (double)range - fdist * 2.0) * cos(rad + orad) );
+            end.y = int( p.y + ( (double)range - fdist * 2.0) * sin(rad + orad) );
+            cast_light_ray( canvas, lit, p, end, luminance );
+
+            end.x = int( p.x + ( (double)range - fdist * 2.0) * cos(rad - orad) );
+            end.y = int( p.y + ( (double)range - fdist * 2.0) * sin(rad - orad) );
+            cast_light_ray( canvas, lit, p, end, luminance );
+        } else {
+            calc_ray_end( nangle + ao, range, p, end );
+            cast_light_ray( canvas, lit, p, end, luminance );
+            calc_ray_end( nangle - ao, range, p, end );
+            cast_light_ray( canvas, lit, p, end, luminance );
+        }
+    }
+}
+
+light_contribution map::cast_light_contribution( const int zlev, const light_source_key &key ) const
+{
+    // Lights are cast one at a time on each thread, so they can share the thread's canvas.
+    static thread_local float canvas_lm[LIGHTMAP_CACHE_X][LIGHTMAP_CACHE_Y];
+    std::fill_n( &canvas_lm[0][0], LIGHTMAP_CACHE_X * LIGHTMAP_CACHE_Y, -1.0f );
+    light_canvas canvas = { canvas_lm, -1.0f, get_cache_ref( zlev ).transparency_cache };
+
+    const tripoint p( key.x, key.y, zlev );
+    switch( key.kind ) {
+        case light_source_key::circle:
+            cast_light_source( canvas, p.x, p.y, inbounds( p ), key.luminance, key.a );
+            break;
+        case light_source_key::directional:
+            cast_directional_light( canvas, p.x, p.y, key.a, key.luminance );
+            break;
+        case light_source_key::arc:
+            cast_light_arc( canvas, p, inbounds( p ), key.a, key.luminance, key.b / 2 );
+            break;
+    }
+
+    light_contribution result;
+    result.min_x = LIGHTMAP_CACHE_X;
+    result.min_y = LIGHTMAP_CACHE_Y;
+    result.max_x = -1;
+    result.max_y = -1;
+    for( int x = 0; x < LIGHTMAP_CACHE_X; ++x ) {
+        for( int y = 0; y < LIGHTMAP_CACHE_Y; ++y ) {
+            if( canvas_lm[x][y] >= 0.0f ) {
+                result.min_x = std::min( result.min_x, x );
+                result.min_y = std::min( result.min_y, y );
+                result.max_x = std::max( result.max_x, x );
+                result.max_y = std::max( result.max_y, y );
+            }
+        }
+    }
+    if( result.max_x >= result.min_x ) {
+        result.lm.reserve( ( result.max_x - result.min_x + 1 ) * ( result.max_y - result.min_y + 1 ) );
+        for( int x = result.min_x; x <= result.max_x; ++x ) {
+            result.lm.insert( result.lm.end(), &canvas_lm[x][result.min_y],
+                              &canvas_lm[x][result.max_y] + 1 );
+        }
+    }
+    result.sm = canvas.sm;
+    result.last_build = 0;
+    return result;
+}
+
+void map::apply_cached_light( const int zlev, const light_source_key &key )
+{
+    auto &map_cache = get_cache( zlev );
+    auto iter = map_cache.light_contributions.find( key );
+    if( iter == map_cache.light_contributions.end() ) {
+        iter = map_cache.light_contributions.emplace( key, cast_light_contribution( zlev, key ) ).first;
+        iter->second.last_build = map_cache.lightmap_build;
+        map_cache.lights_cast++;
+    } else if( iter->second.last_build != map_cache.lightmap_build ) {
+        iter->second.last_build = map_cache.lightmap_build;
+        map_cache.lights_reused++;
+    }
+    const light_contribution &contribution = iter->second;
+
+    auto &lm = map_cache.lm;
+    auto value = contribution.lm.begin();
+    for( int x = contribution.min_x; x <= contribution.max_x; ++x ) {
+        for( int y = contribution.min_y; y <= contribution.max_y; ++y ) {
+            lm[x][y] = std::max( lm[x][y], *value++ );
+        }
+    }
+    if( contribution.sm >= 0.0f ) {
+        auto &sm = map_cache.sm;
+        sm[key.x][key.y] = std::max( sm[key.x][key.y], contribution.sm );
+    }
+}
+
+void map::cast_missing_lights( const int zlev, const std::vector<light_source_key> &keys )
+{
+    worker_pool *workers = shared_workers();
+    if( workers == nullptr ) {
+        return;
+    }
+
+    auto &map_cache = get_cache( zlev );
+    std::vector<light_source_key> missing;
+    for( const light_source_key &key : keys ) {
+        if( map_cache.light_contributions.count( key ) == 0 ) {
+            missing.push_back( key );
+        }
+    }
+    // Each light is cast on its own canvas, so they can't interfere with each other.
+    std::vector<light_contribution> cast( missing.size() );
+    workers->run( missing.size(), [&]( const int index, int ) {
+        cast[index] = cast_light_contribution( zlev, missing[index] );
+    } );
+    for( size_t i = 0; i < missing.size(); i++ ) {
+        cast[i].last_build = map_cache.lightmap_build;
+        if( map_cache.light_contributions.emplace( missing[i], std::move( cast[i] ) ).second ) {
+            map_cache.lights_cast++;
+        }
+    }
+}
+
+void map::apply_light_source( const tripoint &p, float luminance )
+{
+    apply_cached_light( p.z, circle_light( get_cache( p.z ).light_source_buffer, p, luminance ) );
+}
+
+void map::apply_directional_light( const tripoint &p, int direction, float luminance )
+{
+    const light_source_key key = { light_source_key::directional, p.x, p.y, luminance, direction, 0 };
+    apply_cached_light( p.z, key );
+}
+
+void map::apply_light_arc( const tripoint &p, int angle, float luminance, int wideangle )
+{
+    if (luminance <= LIGHT_SOURCE_LOCAL) {
+        return;
+    }
+
+    const light_source_key key = { light_source_key::arc, p.x, p.y, luminance, angle,
+                                   wideangle * 2 + ( trigdist ? 1 : 0 )
+                                 };
+    apply_cached_light( p.z, key );
+}
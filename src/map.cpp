@@ -44,6 +44,7 @@
 #include <cstring>
 #include <algorithm>
 #include <cassert>
+#include <unordered_map>
 
 const mtype_id mon_zombie( "mon_zombie" );
 
@@ -123,6 +124,7 @@ map::map( int mapsize, bool zlev )
 
     dbg(D_INFO) << "map::map(): my_MAPSIZE: " << my_MAPSIZE << " zlevels enabled:" << zlevels;
     traplocs.resize( trap::count() );
+    invalidate_los_memo();
 }
 
 map::~map()
@@ -1358,6 +1360,7 @@ vehicle *map::displace_vehicle( tripoint &p, const tripoint &dp )
     }
     veh->pivot_anchor[0] = veh->pivot_anchor[1];
     veh->pivot_rotation[0] = veh->pivot_rotation[1];
+    veh->refresh_part_positions();
 
     veh->posx = dst_offset_x;
     veh->posy = dst_offset_y;
@@ -1369,6 +1372,7 @@ vehicle *map::displace_vehicle( tripoint &p, const tripoint &dp )
         dst_submap->vehicles.push_back( veh );
         src_submap->vehicles.erase( src_submap->vehicles.begin() + our_i );
         dst_submap->is_uniform = false;
+        MAPBUFFER.add_vehicle_submap( tripoint( abs_sub.x + veh->smx, abs_sub.y + veh->smy, veh->smz ) );
     }
 
     p = p2;
@@ -1554,19 +1558,19 @@ void map::furn_set( const tripoint &p, const furn_id new_furniture )
     }
 
     if( old_t.transparent != new_t.transparent ) {
-        set_transparency_cache_dirty( p.z );
+        set_transparency_cache_dirty( p );
     }
 
     if( old_t.has_flag( TFLAG_INDOORS ) != new_t.has_flag( TFLAG_INDOORS ) ) {
-        set_outside_cache_dirty( p.z );
+        set_outside_cache_dirty( p );
     }
 
     if( old_t.has_flag( TFLAG_NO_FLOOR ) != new_t.has_flag( TFLAG_NO_FLOOR ) ) {
-        set_floor_cache_dirty( p.z );
+        set_floor_cache_dirty( p );
     }
 
     // @todo Limit to changes that affect move cost, traps and stairs
-    set_pathfinding_cache_dirty( p.z );
+    set_pathfinding_cache_dirty( p );
 
     // Make sure the furniture falls if it needs to
     support_dirty( p );
@@ -1756,21 +1760,21 @@ void map::ter_set( const tripoint &p, const ter_id new_terrain )
     }
 
     if( old_t.transparent != new_t.transparent ) {
-        set_transparency_cache_dirty( p.z );
+        set_transparency_cache_dirty( p );
     }
 
     if( old_t.has_flag( TFLAG_INDOORS ) != new_t.has_flag( TFLAG_INDOORS ) ) {
-        set_outside_cache_dirty( p.z );
+        set_outside_cache_dirty( p );
     }
 
     if( new_t.has_flag( TFLAG_NO_FLOOR ) && !old_t.has_flag( TFLAG_NO_FLOOR ) ) {
-        set_floor_cache_dirty( p.z );
+        set_floor_cache_dirty( p );
         // It's a set, not a flag
         support_cache_dirty.insert( p );
     }
 
     // @todo Limit to changes that affect move cost, traps and stairs
-    set_pathfinding_cache_dirty( p.z );
+    set_pathfinding_cache_dirty( p );
 
     tripoint above( p.x, p.y, p.z + 1 );
     // Make sure that if we supported something and no longer do so, it falls down
@@ -2912,7 +2916,8 @@ void map::decay_fields_and_scent( const int amount )
                     break;
                 }
 
-                for( int sy = 0; sy < SEEY; ++sy ) {
+                for( int sy = cur_submap->next_field_tile( sx, 0 ); sy < SEEY;
+                     sy = cur_submap->next_field_tile( sx, sy + 1 ) ) {
                     const int x = sx + smx * SEEX;
                     const int y = sy + smy * SEEY;
 
@@ -5485,6 +5490,7 @@ bool map::add_field(const tripoint &p, const field_id t, int density, const int
     if( current_submap->fld[lx][ly].addField( t, density, age ) ) {
         //Only adding it to the count if it doesn't exist.
         current_submap->field_count++;
+        current_submap->set_field_tile( lx, ly );
     }
 
     if( g != nullptr && this == &g->m && p == g->u.pos() ) {
@@ -5493,11 +5499,11 @@ bool map::add_field(const tripoint &p, const field_id t, int density, const int
 
     // Dirty the transparency cache now that field processing doesn't always do it
     // TODO: Make it skip transparent fields
-    set_transparency_cache_dirty( p.z );
+    set_transparency_cache_dirty( p );
 
     const field_t &ft = fieldlist[t];
     if( field_type_dangerous( t ) ) {
-        set_pathfinding_cache_dirty( p.z );
+        set_pathfinding_cache_dirty( p );
     }
 
     // Ensure blood type fields don't hang in the air
@@ -5520,17 +5526,20 @@ void map::remove_field( const tripoint &p, const field_id field_to_remove )
     if( current_submap->fld[lx][ly].removeField( field_to_remove ) ) {
         // Only adjust the count if the field actually existed.
         current_submap->field_count--;
+        if( current_submap->fld[lx][ly].fieldCount() == 0 ) {
+            current_submap->clear_field_tile( lx, ly );
+        }
         const auto &fdata = fieldlist[ field_to_remove ];
         for( int i = 0; i < 3; ++i ) {
             if( !fdata.transparent[i] ) {
-                set_transparency_cache_dirty( p.z );
+                set_transparency_cache_dirty( p );
                 break;
             }
         }
 
         for( int i = 0; i < 3; ++i ) {
             if( fdata.dangerous[i] ) {
-                set_pathfinding_cache_dirty( p.z );
+                set_pathfinding_cache_dirty( p );
                 break;
             }
         }
@@ -6145,10 +6154,71 @@ void map::draw_from_above( WINDOW* w, player &u, const tripoint &p,
     }
 }
 
+namespace
+{
+struct los_line {
+    tripoint from;
+    tripoint to;
+
+    bool operator==( const los_line &rhs ) const {
+        return from == rhs.from && to == rhs.to;
+    }
+};
+
+struct los_line_hash {
+    std::size_t operator()( const los_line &line ) const {
+        const std::hash<tripoint> hash;
+        return hash( line.from ) * 31 + hash( line.to );
+    }
+};
+
+/**
+ * The results of map::sees for one map and one state of its caches. Each thread keeps its
+ * own, so creatures can look around from several threads at once.
+ */
+struct los_memo {
+    const map *owner = nullptr;
+    unsigned int generation = 0;
+    std::unordered_map<los_line, bool, los_line_hash> visible;
+};
+
+thread_local los_memo sees_memo;
+// More than this many lines are not worth keeping around
+const size_t max_los_memo_size = 1 << 16;
+}
+
+void map::invalidate_los_memo()
+{
+    // Map generations are unique, so the memo of a destroyed map can't be mistaken
+    // for one of a new map at the same address.
+    static unsigned int last_generation = 0;
+    los_generation = ++last_generation;
+}
+
 bool map::sees( const tripoint &F, const tripoint &T, const int range ) const
 {
+    if( ( range >= 0 && range < rl_dist( F, T ) ) || !inbounds( T ) ) {
+        return false; // Out of range!
+    }
+
+    los_memo &memo = sees_memo;
+    if( memo.owner != this || memo.generation != los_generation ||
+        memo.visible.size() >= max_los_memo_size ) {
+        memo.owner = this;
+        memo.generation = los_generation;
+        memo.visible.clear();
+    }
+    const los_line line{ F, T };
+    const auto iter = memo.visible.find( line );
+    if( iter != memo.visible.end() ) {
+        return iter->second;
+    }
+
     int dummy = 0;
-    return sees( F, T, range, dummy );
+    // Already checked the range above
+    const bool visible = sees( F, T, -1, dummy );
+    memo.visible.emplace( line, visible );
+    return visible;
 }
 
 /**
@@ -6669,7 +6739,7 @@ void map::loadn( const int gridx, const int gridy, const int gridz, const bool u
         int overx = newmapx;
         int overy = newmapy;
         sm_to_omt( overx, overy );
-        oter_id terrain_type = overmap_buffer.ter( overx, overy, gridz );
+        oter_id terrain_type = overmap_buffer.get_ter( overx, overy, gridz );
         if( terrain_type == rock || terrain_type == air ) {
             generate_uniform( newmapx, newmapy, gridz, terrain_type );
         } else {
@@ -7449,88 +7519,100 @@ long map::determine_wall_corner( const tripoint &p ) const
 void map::build_outside_cache( const int zlev )
 {
     auto &ch = get_cache( zlev );
-    if( !ch.outside_cache_dirty ) {
+    if( ch.outside_cache_dirty.none() ) {
         return;
     }
 
-    // Make a bigger cache to avoid bounds checking
-    // We will later copy it to our regular cache
-    const size_t padded_w = ( MAPSIZE * SEEX ) + 2;
-    const size_t padded_h = ( MAPSIZE * SEEY ) + 2;
-    bool padded_cache[padded_w][padded_h];
+    // Transparency of outside tiles depends on the weather
+    ch.transparency_cache_dirty |= ch.outside_cache_dirty;
 
     auto &outside_cache = ch.outside_cache;
     if( zlev < 0 )
     {
         std::uninitialized_fill_n(
             &outside_cache[0][0], ( MAPSIZE * SEEX ) * ( MAPSIZE * SEEY ), false );
+        ch.outside_cache_dirty.reset();
         return;
     }
 
-    std::uninitialized_fill_n(
-            &padded_cache[0][0], padded_w * padded_h, true );
-
+    const int map_w = my_MAPSIZE * SEEX;
+    const int map_h = my_MAPSIZE * SEEY;
     for( int smx = 0; smx < my_MAPSIZE; ++smx ) {
         for( int smy = 0; smy < my_MAPSIZE; ++smy ) {
-            auto const cur_submap = get_submap_at_grid( smx, smy, zlev );
+            if( !ch.outside_cache_dirty[smx + smy * my_MAPSIZE] ) {
+                continue;
+            }
+            get_map_cache_stats().outside_submaps++;
+
+            // Indoor tiles of the submap and the ring of tiles around it.
+            // A tile is outside if no tile next to it (or itself) is indoors.
+            bool indoors[SEEX + 2][SEEY + 2];
+            for( int dx = 0; dx < SEEX + 2; dx++ ) {
+                for( int dy = 0; dy < SEEY + 2; dy++ ) {
+                    const int x = smx * SEEX + dx - 1;
+                    const int y = smy * SEEY + dy - 1;
+                    if( x < 0 || y < 0 || x >= map_w || y >= map_h ) {
+                        indoors[dx][dy] = false;
+                        continue;
+                    }
+                    auto const cur_submap = get_submap_at_grid( x / SEEX, y / SEEY, zlev );
+                    const int sx = x % SEEX;
+                    const int sy = y % SEEY;
+                    indoors[dx][dy] = cur_submap->get_ter( sx, sy ).obj().has_flag( TFLAG_INDOORS ) ||
+                                      cur_submap->get_furn( sx, sy ).obj().has_flag( TFLAG_INDOORS );
+                }
+            }
 
             for( int sx = 0; sx < SEEX; ++sx ) {
                 for( int sy = 0; sy < SEEY; ++sy ) {
-                    if( cur_submap->get_ter( sx, sy ).obj().has_flag( TFLAG_INDOORS ) ||
-                        cur_submap->get_furn( sx, sy ).obj().has_flag( TFLAG_INDOORS ) ) {
-                        const int x = sx + ( smx * SEEX );
-                        const int y = sy + ( smy * SEEY );
-                        // Add 1 to both coords, because we're operating on the padded cache
-                        for( int dx = 0; dx <= 2; dx++ )
-                        {
-                            for( int dy = 0; dy <= 2; dy++ )
-                            {
-                                padded_cache[x + dx][y + dy] = false;
+                    bool outside = true;
+                    for( int dx = 0; dx <= 2 && outside; dx++ ) {
+                        for( int dy = 0; dy <= 2; dy++ ) {
+                            if( indoors[sx + dx][sy + dy] ) {
+                                outside = false;
+                                break;
                             }
                         }
                     }
+                    outside_cache[sx + smx * SEEX][sy + smy * SEEY] = outside;
                 }
             }
         }
     }
 
-    // Copy the padded cache back to the proper one, but with no padding
-    for( int x = 0; x < my_MAPSIZE * SEEX; x++ ) {
-        std::copy_n( &padded_cache[x + 1][1], my_MAPSIZE * SEEX, &outside_cache[x][0] );
-    }
-
-    ch.outside_cache_dirty = false;
+    ch.outside_cache_dirty.reset();
 }
 
 void map::build_floor_cache( const int zlev )
 {
     auto &ch = get_cache( zlev );
-    if( !ch.floor_cache_dirty ) {
+    if( ch.floor_cache_dirty.none() ) {
         return;
     }
+    // Lines of sight between z-levels depend on the floors
+    invalidate_los_memo();
 
     auto &floor_cache = ch.floor_cache;
-    std::uninitialized_fill_n(
-            &floor_cache[0][0], ( MAPSIZE * SEEX ) * ( MAPSIZE * SEEY ), true );
-
     for( int smx = 0; smx < my_MAPSIZE; ++smx ) {
         for( int smy = 0; smy < my_MAPSIZE; ++smy ) {
+            if( !ch.floor_cache_dirty[smx + smy * my_MAPSIZE] ) {
+                continue;
+            }
+            get_map_cache_stats().floor_submaps++;
             auto const cur_submap = get_submap_at_grid( smx, smy, zlev );
 
             for( int sx = 0; sx < SEEX; ++sx ) {
                 for( int sy = 0; sy < SEEY; ++sy ) {
                     // Note: furniture currently can't affect existence of floor
-                    if( cur_submap->get_ter( sx, sy ).obj().has_flag( TFLAG_NO_FLOOR ) ) {
-                        const int x = sx + ( smx * SEEX );
-                        const int y = sy + ( smy * SEEY );
-                        floor_cache[x][y] = false;
-                    }
+                    const int x = sx + ( smx * SEEX );
+                    const int y = sy + ( smy * SEEY );
+                    floor_cache[x][y] = !cur_submap->get_ter( sx, sy ).obj().has_flag( TFLAG_NO_FLOOR );
                 }
             }
         }
     }
 
-    ch.floor_cache_dirty = false;
+    ch.floor_cache_dirty.reset();
 }
 
 void map::build_floor_caches()
@@ -7544,6 +7626,7 @@ void map::build_floor_caches()
 
 void map::build_map_cache( const int zlev, bool skip_lightmap )
 {
+    invalidate_los_memo();
     const int minz = zlevels ? -OVERMAP_DEPTH : zlev;
     const int maxz = zlevels ? OVERMAP_HEIGHT : zlev;
     for( int z = minz; z <= maxz; z++ ) {
@@ -8117,12 +8200,16 @@ const level_cache &map::access_cache( int zlev ) const
 level_cache::level_cache()
 {
     const int map_dimensions = SEEX * MAPSIZE * SEEY * MAPSIZE;
-    transparency_cache_dirty = true;
-    outside_cache_dirty = true;
-    floor_cache_dirty = false;
+    transparency_cache_dirty.set();
+    outside_cache_dirty.set();
+    floor_cache_dirty.reset();
     std::fill_n( &lm[0][0], map_dimensions, 0.0f );
     std::fill_n( &sm[0][0], map_dimensions, 0.0f );
     std::fill_n( &light_source_buffer[0][0], map_dimensions, 0.0f );
+    std::fill_n( &light_contributions_transparency[0][0], map_dimensions, 0.0f );
+    lightmap_build = 0;
+    lights_cast = 0;
+    lights_reused = 0;
     std::fill_n( &outside_cache[0][0], map_dimensions, false );
     std::fill_n( &floor_cache[0][0], map_dimensions, false );
     std::fill_n( &transparency_cache[0][0], map_dimensions, 0.0f );
@@ -8135,6 +8222,7 @@ level_cache::level_cache()
 pathfinding_cache::pathfinding_cache()
 {
     dirty = true;
+    portals.dirty.set();
 }
 
 pathfinding_cache::~pathfinding_cache()
@@ -8145,9 +8233,81 @@ pathfinding_cache &map::get_pathfinding_cache( int zlev ) const {
     return *pathfinding_caches[zlev + OVERMAP_DEPTH];
 }
 
+map_cache_stats &get_map_cache_stats()
+{
+    static map_cache_stats stats;
+    return stats;
+}
+
+void map::set_transparency_cache_dirty( const tripoint &p )
+{
+    if( inbounds( p ) ) {
+        get_cache( p.z ).transparency_cache_dirty.set( p.x / SEEX + p.y / SEEY * my_MAPSIZE );
+        invalidate_los_memo();
+    }
+}
+
+void map::set_outside_cache_dirty( const tripoint &p )
+{
+    if( !inbounds( p ) ) {
+        return;
+    }
+    // Indoor tiles make the tiles around them not outside, even across submap borders
+    auto &dirty = get_cache( p.z ).outside_cache_dirty;
+    const int max_x = my_MAPSIZE * SEEX - 1;
+    const int max_y = my_MAPSIZE * SEEY - 1;
+    for( int smx = std::max( p.x - 1, 0 ) / SEEX; smx <= std::min( p.x + 1, max_x ) / SEEX; smx++ ) {
+        for( int smy = std::max( p.y - 1, 0 ) / SEEY; smy <= std::min( p.y + 1, max_y ) / SEEY; smy++ ) {
+            dirty.set( smx + smy * my_MAPSIZE );
+        }
+    }
+}
+
+void map::set_floor_cache_dirty( const tripoint &p )
+{
+    if( inbounds( p ) ) {
+        get_cache( p.z ).floor_cache_dirty.set( p.x / SEEX + p.y / SEEY * my_MAPSIZE );
+        invalidate_los_memo();
+    }
+}
+
 void map::set_pathfinding_cache_dirty( const int zlev ) {
     if( inbounds_z( zlev ) ) {
-        get_pathfinding_cache( zlev ).dirty = true;
+        auto &cache = get_pathfinding_cache( zlev );
+        cache.dirty = true;
+        cache.revision++;
+        cache.portals.dirty.set();
+    }
+}
+
+int map::pathfinding_revision( const int zlev ) const
+{
+    return inbounds_z( zlev ) ? get_pathfinding_cache( zlev ).revision : 0;
+}
+
+void map::set_pathfinding_cache_dirty( const tripoint &p ) {
+    if( !inbounds( p ) ) {
+        return;
+    }
+
+    auto &cache = get_pathfinding_cache( p.z );
+    cache.dirty = true;
+    cache.revision++;
+    // Portals on the shared borders depend on both submaps
+    const int smx = p.x / SEEX;
+    const int smy = p.y / SEEY;
+    cache.portals.dirty.set( smx + smy * my_MAPSIZE );
+    if( smx > 0 ) {
+        cache.portals.dirty.set( smx - 1 + smy * my_MAPSIZE );
+    }
+    if( smx < my_MAPSIZE - 1 ) {
+        cache.portals.dirty.set( smx + 1 + smy * my_MAPSIZE );
+    }
+    if( smy > 0 ) {
+        cache.portals.dirty.set( smx + ( smy - 1 ) * my_MAPSIZE );
+    }
+    if( smy < my_MAPSIZE - 1 ) {
+        cache.portals.dirty.set( smx + ( smy + 1 ) * my_MAPSIZE );
     }
 }
 
@@ -8233,6 +8393,46 @@ void map::update_pathfinding_cache( int zlev ) const
         }
     }
 
+    // Tiles off the map are never walked on, so they don't break up open areas
+    constexpr pf_special non_open = PF_SLOW | PF_WALL | PF_VEHICLE | PF_TRAP | PF_UPDOWN;
+    const int mapsize_x = my_MAPSIZE * SEEX;
+    const int mapsize_y = my_MAPSIZE * SEEY;
+    for( int x = 0; x < mapsize_x; x++ ) {
+        for( int y = 0; y < mapsize_y; y++ ) {
+            bool open = true;
+            for( int nx = std::max( x - 1, 0 ); open && nx <= std::min( x + 1, mapsize_x - 1 ); nx++ ) {
+                for( int ny = std::max( y - 1, 0 ); ny <= std::min( y + 1, mapsize_y - 1 ); ny++ ) {
+                    if( cache.special[nx][ny] & non_open ) {
+                        open = false;
+                        break;
+                    }
+                }
+            }
+            cache.open_area[x][y] = open;
+        }
+    }
+
+    for( int y = 0; y < mapsize_y; y++ ) {
+        for( int x = 0; x < mapsize_x; x++ ) {
+            const bool next_open = x > 0 && cache.open_area[x - 1][y];
+            cache.jump_length[0][x][y] = next_open ? cache.jump_length[0][x - 1][y] + 1 : 1;
+        }
+        for( int x = mapsize_x - 1; x >= 0; x-- ) {
+            const bool next_open = x < mapsize_x - 1 && cache.open_area[x + 1][y];
+            cache.jump_length[1][x][y] = next_open ? cache.jump_length[1][x + 1][y] + 1 : 1;
+        }
+    }
+    for( int x = 0; x < mapsize_x; x++ ) {
+        for( int y = 0; y < mapsize_y; y++ ) {
+            const bool next_open = y > 0 && cache.open_area[x][y - 1];
+            cache.jump_length[2][x][y] = next_open ? cache.jump_length[2][x][y - 1] + 1 : 1;
+        }
+        for( int y = mapsize_y - 1; y >= 0; y-- ) {
+            const bool next_open = y < mapsize_y - 1 && cache.open_area[x][y + 1];
+            cache.jump_length[3][x][y] = next_open ? cache.jump_length[3][x][y + 1] + 1 : 1;
+        }
+    }
+
     cache.dirty = false;
 }
 
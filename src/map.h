@@ -8,6 +8,7 @@
 #include <map>
 #include <memory>
 #include <array>
+#include <bitset>
 #include <list>
 #include <utility>
 
@@ -33,6 +34,9 @@ class tripoint_range;
 enum field_id : int;
 class field;
 class field_entry;
+struct gas_spread;
+struct fire_source;
+struct fire_spread;
 class vehicle;
 struct submap;
 struct maptile;
@@ -89,7 +93,9 @@ using mongroup_id = string_id<MonsterGroup>;
 class map;
 enum ter_bitflags : int;
 struct pathfinding_cache;
+struct pathfinding_flow_field;
 struct pathfinding_settings;
+enum pf_special : char;
 template<typename T>
 struct weighted_int_list;
 
@@ -140,19 +146,94 @@ struct bash_params {
     bool bashed_solid; // Did we bash furniture, terrain or vehicle
 };
 
+/**
+ * Identifies one light cast by @ref map::generate_lightmap: everything other than the
+ * transparency around it that decides how it lights the map.
+ */
+struct light_source_key {
+    enum kind_type : int {
+        circle,
+        directional,
+        arc
+    };
+    kind_type kind;
+    int x;
+    int y;
+    float luminance;
+    // circle: sides to cast into, directional: direction, arc: angle
+    int a;
+    // arc: width, doubled, plus one if trigdist was on
+    int b;
+
+    bool operator<( const light_source_key &rhs ) const {
+        if( kind != rhs.kind ) {
+            return kind < rhs.kind;
+        }
+        if( x != rhs.x ) {
+            return x < rhs.x;
+        }
+        if( y != rhs.y ) {
+            return y < rhs.y;
+        }
+        if( luminance != rhs.luminance ) {
+            return luminance < rhs.luminance;
+        }
+        if( a != rhs.a ) {
+            return a < rhs.a;
+        }
+        return b < rhs.b;
+    }
+};
+
+/**
+ * What a single light added to the lightmap, kept between lightmap builds so lights that
+ * didn't change don't have to be cast again.
+ */
+struct light_contribution {
+    // Inclusive bounds of the tiles the light reached. Empty if max_x < min_x.
+    int min_x;
+    int min_y;
+    int max_x;
+    int max_y;
+    // Light levels over the bounds, x major. Negative where the light didn't reach.
+    std::vector<float> lm;
+    // Light level at the source tile, negative if the source was out of bounds.
+    float sm;
+    // Value of level_cache::lightmap_build when this was last used.
+    int last_build;
+};
+
+/** Running totals of the submaps rebuilt by @ref map::build_map_cache, for profiling. */
+struct map_cache_stats {
+    long transparency_submaps = 0;
+    long outside_submaps = 0;
+    long floor_submaps = 0;
+};
+
+/** Work done during the current turn, game::do_turn resets it at the start of every turn. */
+map_cache_stats &get_map_cache_stats();
+
 struct level_cache {
     level_cache(); // Zeroes all relevant values
     level_cache( const level_cache &other ) = default;
 
-    bool transparency_cache_dirty;
-    bool outside_cache_dirty;
-    bool floor_cache_dirty;
+    // Submaps (at smx + smy * my_MAPSIZE) whose part of the cache has to be rebuilt
+    std::bitset<MAPSIZE * MAPSIZE> transparency_cache_dirty;
+    std::bitset<MAPSIZE * MAPSIZE> outside_cache_dirty;
+    std::bitset<MAPSIZE * MAPSIZE> floor_cache_dirty;
 
     float lm[MAPSIZE * SEEX][MAPSIZE * SEEY];
     float sm[MAPSIZE * SEEX][MAPSIZE * SEEY];
     // To prevent redundant ray casting into neighbors: precalculate bulk light source positions.
     // This is only valid for the duration of generate_lightmap
     float light_source_buffer[MAPSIZE * SEEX][MAPSIZE * SEEY];
+    // Lights cast by recent lightmap builds and the transparency they were cast through.
+    std::map<light_source_key, light_contribution> light_contributions;
+    float light_contributions_transparency[MAPSIZE * SEEX][MAPSIZE * SEEY];
+    int lightmap_build;
+    // How many lights the last lightmap build had to cast and how many it reused.
+    int lights_cast;
+    int lights_reused;
     bool outside_cache[MAPSIZE * SEEX][MAPSIZE * SEEY];
     bool floor_cache[MAPSIZE * SEEX][MAPSIZE * SEEY];
     float transparency_cache[MAPSIZE * SEEX][MAPSIZE * SEEY];
@@ -209,23 +290,34 @@ class map
         /*@{*/
         void set_transparency_cache_dirty( const int zlev ) {
             if( inbounds_z( zlev ) ) {
-                get_cache( zlev ).transparency_cache_dirty = true;
+                get_cache( zlev ).transparency_cache_dirty.set();
+                invalidate_los_memo();
             }
         }
 
         void set_outside_cache_dirty( const int zlev ) {
             if( inbounds_z( zlev ) ) {
-                get_cache( zlev ).outside_cache_dirty = true;
+                get_cache( zlev ).outside_cache_dirty.set();
             }
         }
 
         void set_floor_cache_dirty( const int zlev ) {
             if( inbounds_z( zlev ) ) {
-                get_cache( zlev ).floor_cache_dirty = true;
+                get_cache( zlev ).floor_cache_dirty.set();
+                invalidate_los_memo();
             }
         }
 
+        /** Like above, but only rebuild the submaps whose cache entries can depend on `p` */
+        void set_transparency_cache_dirty( const tripoint &p );
+        void set_outside_cache_dirty( const tripoint &p );
+        void set_floor_cache_dirty( const tripoint &p );
+
         void set_pathfinding_cache_dirty( const int zlev );
+        /** Like above, but lets the portal graph rebuild only the submaps around `p` */
+        void set_pathfinding_cache_dirty( const tripoint &p );
+        /** Changes whenever the pathfinding cache of the z-level gets dirty */
+        int pathfinding_revision( int zlev ) const;
         /*@}*/
 
 
@@ -391,9 +483,18 @@ class map
         // 3D Sees:
         /**
         * Returns whether `F` sees `T` with a view range of `range`.
+        * The lines tested are remembered until the transparency of the map changes,
+        * see @ref invalidate_los_memo.
         */
         bool sees( const tripoint &F, const tripoint &T, int range ) const;
     private:
+        /**
+         * Forgets the lines of sight remembered by @ref sees. Called whenever the caches it
+         * reads may change: when they are rebuilt and when they are marked dirty.
+         */
+        void invalidate_los_memo();
+        /** Identifies the current state of the caches read by @ref sees, unique over all maps. */
+        unsigned int los_generation;
         /**
          * Don't expose the slope adjust outside map functions.
          *
@@ -459,6 +560,31 @@ class map
         std::vector<tripoint> route( const tripoint &f, const tripoint &t,
                                      const pathfinding_settings &settings,
         const std::set<tripoint> &pre_closed = {{ }} ) const;
+        /**
+         * Like @ref route, but follows a flow field toward `t` that is built once and then
+         * shared by every caller with the same settings until the map changes.
+         * Meant for targets many creatures path to at once, such as the player.
+         * Falls back to @ref route when the field can't be used.
+         */
+        std::vector<tripoint> route_shared( const tripoint &f, const tripoint &t,
+                                            const pathfinding_settings &settings,
+        const std::set<tripoint> &pre_closed = {{ }} ) const;
+        /**
+         * Paths from each of `origins` to `t`, as @ref route would return them, but found
+         * with a single search backwards from `t`. For groups that share a destination.
+         */
+        std::vector<std::vector<tripoint>> route_many( const std::vector<tripoint> &origins,
+                                        const tripoint &t, const pathfinding_settings &settings,
+        const std::set<tripoint> &pre_closed = {{ }} ) const;
+        /**
+         * Updates a `path` from `f` planned earlier by @ref route, so that it leads to `t`
+         * (which can be a few tiles away from its old end) and avoids tiles that got blocked.
+         * Only the affected parts are searched again.
+         * @returns false if the path can't be repaired cheaply and should be planned anew.
+         */
+        bool repair_route( std::vector<tripoint> &path, const tripoint &f, const tripoint &t,
+                           const pathfinding_settings &settings,
+                           const std::set<tripoint> &pre_closed = {{ }} ) const;
 
         int coord_to_angle( const int x, const int y, const int tgtx, const int tgty ) const;
         // Vehicles: Common to 2D and 3D
@@ -965,8 +1091,32 @@ class map
         const std::vector<tripoint> &trap_locations( trap_id t ) const;
 
         bool process_fields(); // See fields.cpp
+        /** Processes the fields of one submap in place, fires only burn their own tile, the ones
+         *  left to spread are added to `fires`. See fields.cpp */
         bool process_fields_in_submap( submap *const current_submap,
-                                       const int submap_x, const int submap_y, const int submap_z ); // See fields.cpp
+                                       const int submap_x, const int submap_y, const int submap_z,
+                                       std::vector<fire_source> &fires );
+        /**
+         * First step of spreading the gases that do nothing else (see field.cpp). Only reads the
+         * map and adds the changes for the fields on the given submap to `changes`, so submaps
+         * can be planned in parallel. Random numbers come from `seed` and the submap position.
+         * @return Whether the changes affect transparency.
+         */
+        bool plan_gas_spread( int submap_x, int submap_y, int submap_z, unsigned int seed,
+                              std::vector<gas_spread> &changes );
+        /** Second step: applies changes made by @ref plan_gas_spread. */
+        void apply_gas_spread( const std::vector<gas_spread> &changes );
+        /**
+         * Plans how the `fires` of one submap, which already burned their own tiles this turn,
+         * grow and spread to their neighbours, the same way as @ref plan_gas_spread.
+         * @return Whether the changes affect transparency.
+         */
+        bool plan_fire_spread( const std::vector<fire_source> &fires, unsigned int seed,
+                               std::vector<fire_spread> &changes );
+        /** Applies changes made by @ref plan_fire_spread. */
+        void apply_fire_spread( const std::vector<fire_spread> &changes );
+        /** The 8 tiles around p on the same z-level, null tiles where outside of the map. */
+        std::array<maptile, 8> get_neighbors( const tripoint &p );
         /**
          * Apply field effects to the creature when it's on a square with fields.
          */
@@ -1334,6 +1484,11 @@ class map
         void build_floor_cache( int zlev );
         // We want this visible in `game`, because we want it built earlier in the turn than the rest
         void build_floor_caches();
+        /**
+         * Casts the field of vision from origin over the transparency cache of its z-level,
+         * like the player's seen cache. Places above LIGHT_TRANSPARENCY_SOLID in output are seen.
+         */
+        void cast_sight( const tripoint &origin, float (&output)[MAPSIZE*SEEX][MAPSIZE*SEEY] ) const;
 
     protected:
         void generate_lightmap( int zlev );
@@ -1441,8 +1596,13 @@ class map
         // Handle just cardinal directions and 45 deg angles.
         void apply_directional_light( const tripoint &p, int direction, float luminance );
         void apply_light_arc( const tripoint &p, int angle, float luminance, int wideangle = 30 );
-        void apply_light_ray( bool lit[MAPSIZE * SEEX][MAPSIZE * SEEY],
-                              const tripoint &s, const tripoint &e, float luminance );
+        // Merge a light into the lightmap, reusing what it cast in an earlier build if neither it
+        // nor the transparency in its reach changed since.
+        void apply_cached_light( int zlev, const light_source_key &key );
+        light_contribution cast_light_contribution( int zlev, const light_source_key &key ) const;
+        // Casts the lights that have no cached contribution yet in parallel, if threaded
+        // lighting is enabled.
+        void cast_missing_lights( int zlev, const std::vector<light_source_key> &keys );
         void add_light_from_items( const tripoint &p, std::list<item>::iterator begin,
                                    std::list<item>::iterator end );
         vehicle *add_vehicle_to_map( std::unique_ptr<vehicle> veh, bool merge_wrecks );
@@ -1521,6 +1681,38 @@ class map
 
         pathfinding_cache &get_pathfinding_cache( int zlev ) const;
 
+        /**
+         * Cost of stepping from `cur` onto the adjacent `p` (which has `p_special` flags)
+         * as used by @ref route, or a negative value if it can't be done.
+         */
+        int cost_to_pass( const tripoint &cur, const tripoint &p, const pathfinding_settings &settings,
+                          pf_special p_special ) const;
+        /**
+         * Dijkstra backwards from `t` over its z-level, limited to the box from `min` (inclusive)
+         * to `max` (exclusive) and to `max_length` cost. Fills `dist` and `next` as described in
+         * @ref pathfinding_flow_field. Never leads through `pre_closed` tiles, except `origins`.
+         * Stops once all `origins` are reached, if any are given.
+         */
+        void reverse_search( const tripoint &t, const pathfinding_settings &settings,
+                             const std::set<tripoint> &pre_closed, const std::vector<tripoint> &origins,
+                             const point &min, const point &max, int max_length,
+                             std::vector<int> &dist, std::vector<char> &next ) const;
+        /**
+         * Returns an up to date flow field toward `t`, building it if needed. A field is
+         * rebuilt at most once per turn, nullptr if it went out of date again since.
+         */
+        const pathfinding_flow_field *get_flow_field( const tripoint &t,
+                const pathfinding_settings &settings ) const;
+        /** Rebuilds dirty submaps of the portal graph, expects up to date `special` cache */
+        void update_portal_graph( int zlev ) const;
+        /**
+         * Plans a route over @ref pathfinding_portal_graph and refines it with @ref route.
+         * Returns an empty vector if the coarse graph doesn't give a usable path.
+         */
+        std::vector<tripoint> route_hierarchical( const tripoint &f, const tripoint &t,
+                const pathfinding_settings &settings,
+                const std::set<tripoint> &pre_closed ) const;
+
         visibility_variables visibility_variables_cache;
 
     public:
@@ -37,6 +37,7 @@ void mapbuffer::reset()
         delete elem.second;
     }
     submaps.clear();
+    submaps_with_vehicles.clear();
 }
 
 bool mapbuffer::add_submap( const tripoint &p, submap *sm )
@@ -46,6 +47,9 @@ bool mapbuffer::add_submap( const tripoint &p, submap *sm )
     }
 
     submaps[p] = sm;
+    if( !sm->vehicles.empty() ) {
+        submaps_with_vehicles[p] = sm;
+    }
 
     return true;
 }
@@ -76,6 +80,27 @@ void mapbuffer::remove_submap( tripoint addr )
     }
     delete m_target->second;
     submaps.erase( m_target );
+    submaps_with_vehicles.erase( addr );
+}
+
+void mapbuffer::add_vehicle_submap( const tripoint &p )
+{
+    const auto iter = submaps.find( p );
+    if( iter != submaps.end() && iter->second != nullptr ) {
+        submaps_with_vehicles[p] = iter->second;
+    }
+}
+
+const mapbuffer::submap_map_t &mapbuffer::vehicle_submaps()
+{
+    for( auto iter = submaps_with_vehicles.begin(); iter != submaps_with_vehicles.end(); ) {
+        if( iter->second->vehicles.empty() ) {
+            iter = submaps_with_vehicles.erase( iter );
+        } else {
+            ++iter;
+        }
+    }
+    return submaps_with_vehicles;
 }
 
 submap *mapbuffer::lookup_submap( int x, int y, int z )
@@ -564,6 +589,7 @@ void mapbuffer::deserialize( JsonIn &jsin )
                         int age = jsin.get_int();
                         if( sm->fld[i][j].findField( field_id( type ) ) == NULL ) {
                             sm->field_count++;
+                            sm->set_field_tile( i, j );
                         }
                         sm->fld[i][j].addField( field_id( type ), density, age );
                     }
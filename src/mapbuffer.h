@@ -69,6 +69,18 @@ class mapbuffer
             return submaps.end();
         }
 
+        /**
+         * Note that the submap at the given absolute submap position now holds
+         * a vehicle. Submaps that are not in the buffer yet are ignored, their
+         * vehicles are noted by @ref add_submap once they are added.
+         */
+        void add_vehicle_submap( const tripoint &p );
+        /**
+         * All buffered submaps that hold vehicles, in the same order as iterating
+         * over the buffer. Submaps whose vehicles are all gone are dropped here.
+         */
+        const submap_map_t &vehicle_submaps();
+
     private:
         // There's a very good reason this is private,
         // if not handled carefully, this can erase in-use submaps and crash the game.
@@ -79,6 +91,7 @@ class mapbuffer
                         const tripoint &om_addr, std::list<tripoint> &submaps_to_delete,
                         bool delete_after_save );
         submap_map_t submaps;
+        submap_map_t submaps_with_vehicles;
 };
 
 extern mapbuffer MAPBUFFER;
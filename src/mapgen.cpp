@@ -140,23 +140,23 @@ void map::generate(const int x, const int y, const int z, const int turn)
     int overy = y;
     sm_to_omt(overx, overy);
     const regional_settings *rsettings = &overmap_buffer.get_settings(overx, overy, z);
-    oter_id terrain_type = overmap_buffer.ter(overx, overy, z);
-    oter_id t_above = overmap_buffer.ter( overx    , overy    , z + 1 );
-    oter_id t_north = overmap_buffer.ter( overx    , overy - 1, z );
-    oter_id t_neast = overmap_buffer.ter( overx + 1, overy - 1, z );
-    oter_id t_east  = overmap_buffer.ter( overx + 1, overy    , z );
-    oter_id t_seast = overmap_buffer.ter( overx + 1, overy + 1, z );
-    oter_id t_south = overmap_buffer.ter( overx    , overy + 1, z );
-    oter_id t_swest = overmap_buffer.ter( overx - 1, overy + 1, z );
-    oter_id t_west  = overmap_buffer.ter( overx - 1, overy    , z );
-    oter_id t_nwest = overmap_buffer.ter( overx - 1, overy - 1, z );
+    oter_id terrain_type = overmap_buffer.get_ter(overx, overy, z);
+    oter_id t_above = overmap_buffer.get_ter( overx    , overy    , z + 1 );
+    oter_id t_north = overmap_buffer.get_ter( overx    , overy - 1, z );
+    oter_id t_neast = overmap_buffer.get_ter( overx + 1, overy - 1, z );
+    oter_id t_east  = overmap_buffer.get_ter( overx + 1, overy    , z );
+    oter_id t_seast = overmap_buffer.get_ter( overx + 1, overy + 1, z );
+    oter_id t_south = overmap_buffer.get_ter( overx    , overy + 1, z );
+    oter_id t_swest = overmap_buffer.get_ter( overx - 1, overy + 1, z );
+    oter_id t_west  = overmap_buffer.get_ter( overx - 1, overy    , z );
+    oter_id t_nwest = overmap_buffer.get_ter( overx - 1, overy - 1, z );
 
     // This attempts to scale density of zombies inversely with distance from the nearest city.
     // In other words, make city centers dense and perimiters sparse.
     float density = 0.0;
     for (int i = overx - MON_RADIUS; i <= overx + MON_RADIUS; i++) {
         for (int j = overy - MON_RADIUS; j <= overy + MON_RADIUS; j++) {
-            density += overmap_buffer.ter(i, j, z)->get_mondensity();
+            density += overmap_buffer.get_ter(i, j, z)->get_mondensity();
         }
     }
     density = density / 100;
@@ -7366,7 +7366,7 @@ void map::place_spawns(const mongroup_id& group, const int chance,
 {
     if( !group.is_valid() ) {
         const point omt = sm_to_omt_copy( get_abs_sub().x, get_abs_sub().y );
-        const oter_id &oid = overmap_buffer.ter( omt.x, omt.y, get_abs_sub().z );
+        const oter_id &oid = overmap_buffer.get_ter( omt.x, omt.y, get_abs_sub().z );
         debugmsg("place_spawns: invalid mongroup '%s', om_terrain = '%s' (%s)", group.c_str(), oid.id().c_str(), oid->get_mapgen_id().c_str() );
         return;
     }
@@ -7485,7 +7485,7 @@ std::vector<item *> map::place_items( items_location loc, int chance, int x1, in
     }
     if (!item_group::group_is_defined(loc)) {
         const point omt = sm_to_omt_copy( get_abs_sub().x, get_abs_sub().y );
-        const oter_id &oid = overmap_buffer.ter( omt.x, omt.y, get_abs_sub().z );
+        const oter_id &oid = overmap_buffer.get_ter( omt.x, omt.y, get_abs_sub().z );
         debugmsg("place_items: invalid item group '%s', om_terrain = '%s' (%s)",
                  loc.c_str(), oid.id().c_str(), oid->get_mapgen_id().c_str() );
         return res;
@@ -7618,6 +7618,8 @@ vehicle *map::add_vehicle(const vproto_id &type, const tripoint &p, const int di
         submap *place_on_submap = get_submap_at_grid( placed_vehicle->smx, placed_vehicle->smy, placed_vehicle->smz );
         place_on_submap->vehicles.push_back(placed_vehicle);
         place_on_submap->is_uniform = false;
+        MAPBUFFER.add_vehicle_submap( tripoint( abs_sub.x + placed_vehicle->smx,
+                                                abs_sub.y + placed_vehicle->smy, placed_vehicle->smz ) );
 
         auto &ch = get_cache( placed_vehicle->smz );
         ch.vehicle_list.insert(placed_vehicle);
@@ -8012,6 +8014,12 @@ void map::rotate(int turns)
             }
         }
     }
+    // Fields were swapped between tiles directly
+    for( int gridx = 0; gridx < my_MAPSIZE; gridx++ ) {
+        for( int gridy = 0; gridy < my_MAPSIZE; gridy++ ) {
+            getsubmap( get_nonant( gridx, gridy ) )->update_field_tiles();
+        }
+    }
 }
 
 // Hideous function, I admit...
@@ -9443,8 +9451,8 @@ void mx_roadblock(map &m, const tripoint &abs_sub)
 {
     // Currently doesn't handle adjacency to turns or intersections well, we may want to abort in future
     bool rotated = false;
-    std::string north = overmap_buffer.ter( abs_sub.x/2, abs_sub.y/2 -1, abs_sub.z ).id().c_str();
-    std::string south = overmap_buffer.ter( abs_sub.x/2, abs_sub.y/2 +1, abs_sub.z ).id().c_str();
+    std::string north = overmap_buffer.get_ter( abs_sub.x/2, abs_sub.y/2 -1, abs_sub.z ).id().c_str();
+    std::string south = overmap_buffer.get_ter( abs_sub.x/2, abs_sub.y/2 +1, abs_sub.z ).id().c_str();
     if (north.find("road_") == 0 && south.find("road_") == 0) {
         rotated = true;
         //Rotate the terrain -90 so that all of the items will be in the correct position
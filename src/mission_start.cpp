@@ -416,7 +416,7 @@ void mission_start::place_npc_software( mission *miss )
     compmap.load( place.x * 2, place.y * 2, place.z, false );
     tripoint comppoint;
 
-    oter_id oter = overmap_buffer.ter( place.x, place.y, place.z );
+    oter_id oter = overmap_buffer.get_ter( place.x, place.y, place.z );
     if( is_ot_type( "house", oter ) || is_ot_type( "s_pharm", oter ) || oter == "" ) {
         std::vector<tripoint> valid;
         for( int x = 0; x < SEEX * 2; x++ ) {
@@ -1686,7 +1686,7 @@ void reveal_target( mission *miss, const std::string &omter_id )
 
     const tripoint destination = reveal_destination( omter_id );
     if( destination != overmap::invalid_tripoint ) {
-        const oter_id oter = overmap_buffer.ter( destination );
+        const oter_id oter = overmap_buffer.get_ter( destination );
         add_msg( _( "%s has marked the only %s known to them on your map." ),
                  p->name.c_str(), oter->get_name().c_str() );
         miss->set_target( destination );
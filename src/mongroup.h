@@ -2,6 +2,8 @@
 #ifndef MONGROUP_H
 #define MONGROUP_H
 
+#include <algorithm>
+#include <functional>
 #include <vector>
 #include <map>
 #include <set>
@@ -130,6 +132,14 @@ struct mongroup : public JsonSerializer, public JsonDeserializer {
         target.y = y;
     }
     void wander( overmap & );
+    /**
+     * Picks where a horde at `pos` wanders to and how interested it is in getting there:
+     * the nearest city of `om` if `to_city` and the overmap has any, somewhere around
+     * `pos` otherwise. `roll( lo, hi )` draws the random numbers.
+     */
+    static void choose_wander_target( const overmap &om, bool to_city, const tripoint &pos,
+                                      const std::function<int( int, int )> &roll,
+                                      tripoint &target, int &interest );
     void inc_interest( int inc ) {
         interest += inc;
         if( interest > 100 ) {
@@ -137,10 +147,11 @@ struct mongroup : public JsonSerializer, public JsonDeserializer {
         }
     }
     void dec_interest( int dec ) {
-        interest -= dec;
-        if( interest < 15 ) {
-            interest = 15;
-        }
+        interest = decreased_interest( interest, dec );
+    }
+    /** Interest left after losing `dec` of it, it never drops below 15. */
+    static int decreased_interest( int interest, int dec ) {
+        return std::max( interest - dec, 15 );
     }
     void set_interest( int set ) {
         if( set < 15 ) {
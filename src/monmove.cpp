@@ -1,6 +1,7 @@
 // Monster movement code; essentially, the AI
 
 #include "monster.h"
+#include "creature_tracker.h"
 #include "map.h"
 #include "map_iterator.h"
 #include "debug.h"
@@ -21,6 +22,7 @@
 #include "field.h"
 #include "scent_map.h"
 
+#include <algorithm>
 #include <stdlib.h>
 //Used for e^(x) functions
 #include <stdio.h>
@@ -193,11 +195,12 @@ float monster::rate_target( Creature &c, float best, bool smart ) const
     return INT_MAX;
 }
 
-void monster::plan( const mfactions &factions )
+monster_plan monster::compute_plan( const mfactions &factions ) const
 {
+    monster_plan result;
     // Bots are more intelligent than most living stuff
     bool smart_planning = has_flag( MF_PRIORITIZE_TARGETS );
-    Creature *target = nullptr;
+    Creature *&target = result.target;
     // 8.6f is rating for tank drone 60 tiles away, moose 16 or boomer 33
     float dist = !smart_planning ? 1000 : 8.6f;
     bool fleeing = false;
@@ -209,6 +212,12 @@ void monster::plan( const mfactions &factions )
     bool group_morale = has_flag( MF_GROUP_MORALE ) && morale < type->morale;
     bool swarms = has_flag( MF_SWARMS );
     auto mood = attitude();
+    // Nothing further away can be seen, see Creature::sees
+    const int vision_range = std::max( { 1, sight_range( DAYLIGHT_LEVEL ), sight_range( 0 ) } );
+    // Planning doesn't change the monster, these are the values as they would be after this plan
+    int planned_anger = anger;
+    int planned_morale = morale;
+    int planned_wandf = wandf;
 
     // If we can see the player, move toward them or flee, simpleminded animals are too dumb to follow the player.
     if( friendly == 0 && sees( g->u ) && !has_flag( MF_PET_WONT_FOLLOW ) ) {
@@ -216,12 +225,16 @@ void monster::plan( const mfactions &factions )
         fleeing = fleeing || is_fleeing( g->u );
         target = &g->u;
         if( dist <= 5 ) {
-            anger += angers_hostile_near;
-            morale -= fears_hostile_near;
+            planned_anger += angers_hostile_near;
+            planned_morale -= fears_hostile_near;
         }
     } else if( friendly != 0 && !docile ) {
         // Target unfriendly monsters, only if we aren't interacting with the player.
-        for( monster &tmp : g->all_monsters() ) {
+        g->critter_tracker->visit_nearby( pos(), vision_range, [&]( monster & tmp, const int min_dist ) {
+            // The rest is too far away to be closer than the current target
+            if( !smart_planning && min_dist >= dist ) {
+                return false;
+            }
             if( tmp.friendly == 0 ) {
                 float rating = rate_target( tmp, dist, smart_planning );
                 if( rating < dist ) {
@@ -229,15 +242,16 @@ void monster::plan( const mfactions &factions )
                     dist = rating;
                 }
             }
-        }
+            return true;
+        } );
     }
 
     if( docile ) {
         if( friendly != 0 && target != nullptr ) {
-            set_dest( target->pos() );
+            result.approach_target = true;
         }
 
-        return;
+        return result;
     }
 
     for( npc &who : g->all_npcs() ) {
@@ -247,42 +261,47 @@ void monster::plan( const mfactions &factions )
         }
 
         float rating = rate_target( who, dist, smart_planning );
-        bool fleeing_from = is_fleeing( who );
+        const monster_attitude att = attitude( &who, planned_anger, planned_morale );
+        bool fleeing_from = effect_cache[FLEEING] || att == MATT_FLEE ||
+                            ( att == MATT_FOLLOW && rl_dist( pos(), who.pos() ) <= 4 );
         // Switch targets if closer and hostile or scarier than current target
         if( ( rating < dist && fleeing ) ||
-            ( rating < dist && attitude( &who ) == MATT_ATTACK ) ||
+            ( rating < dist && att == MATT_ATTACK ) ||
             ( !fleeing && fleeing_from ) ) {
             target = &who;
             dist = rating;
         }
         fleeing = fleeing || fleeing_from;
         if( rating <= 5 ) {
-            anger += angers_hostile_near;
-            morale -= fears_hostile_near;
+            planned_anger += angers_hostile_near;
+            planned_morale -= fears_hostile_near;
         }
     }
 
     fleeing = fleeing || ( mood == MATT_FLEE );
     if( friendly == 0 ) {
-        for( const auto &fac : factions ) {
-            auto faction_att = faction.obj().attitude( fac.first );
+        const mfaction_id playerfaction = mfaction_str_id( "player" );
+        g->critter_tracker->visit_nearby( pos(), vision_range, [&]( monster & mon, const int min_dist ) {
+            // The rest is too far away to be closer than the current target
+            if( !smart_planning && min_dist >= dist ) {
+                return false;
+            }
+            const auto faction_att = faction.obj().attitude( mon.friendly == 0 ? mon.faction : playerfaction );
             if( faction_att == MFA_NEUTRAL || faction_att == MFA_FRIENDLY ) {
-                continue;
+                return true;
             }
 
-            for( monster *const mon_ptr : fac.second ) {
-                monster &mon = *mon_ptr;
-                float rating = rate_target( mon, dist, smart_planning );
-                if( rating < dist ) {
-                    target = &mon;
-                    dist = rating;
-                }
-                if( rating <= 5 ) {
-                    anger += angers_hostile_near;
-                    morale -= fears_hostile_near;
-                }
+            float rating = rate_target( mon, dist, smart_planning );
+            if( rating < dist ) {
+                target = &mon;
+                dist = rating;
             }
-        }
+            if( rating <= 5 ) {
+                planned_anger += angers_hostile_near;
+                planned_morale -= fears_hostile_near;
+            }
+            return true;
+        } );
     }
 
     // Friendly monsters here
@@ -302,16 +321,16 @@ void monster::plan( const mfactions &factions )
             monster &mon = *mon_ptr;
             float rating = rate_target( mon, dist, smart_planning );
             if( group_morale && rating <= 10 ) {
-                morale += 10 - rating;
+                planned_morale += 10 - rating;
             }
             if( swarms ) {
                 if( rating < 5 ) { // Too crowded here
-                    wander_pos.x = posx() * rng( 1, 3 ) - mon.posx();
-                    wander_pos.y = posy() * rng( 1, 3 ) - mon.posy();
-                    wandf = 2;
+                    result.crowded++;
+                    result.crowded_by = mon.pos();
+                    planned_wandf = 2;
                     target = nullptr;
                     // Swarm to the furthest ally you can see
-                } else if( rating < INT_MAX && rating > dist && wandf <= 0 ) {
+                } else if( rating < INT_MAX && rating > dist && planned_wandf <= 0 ) {
                     target = &mon;
                     dist = rating;
                 }
@@ -320,24 +339,58 @@ void monster::plan( const mfactions &factions )
     }
 
     if( target != nullptr ) {
-
-        tripoint dest = target->pos();
-        auto att_to_target = attitude_to( *target );
+        auto att_to_target = attitude_to( *target, planned_anger, planned_morale );
         if( att_to_target == Attitude::A_HOSTILE && !fleeing ) {
-            set_dest( dest );
+            result.approach_target = true;
         } else if( fleeing ) {
-            set_dest( tripoint( posx() * 2 - dest.x, posy() * 2 - dest.y, posz() ) );
+            result.flee_target = true;
         }
         if( angers_hostile_weak && att_to_target != Attitude::A_FRIENDLY ) {
             int hp_per = target->hp_percentage();
             if( hp_per <= 70 ) {
-                anger += 10 - int( hp_per / 10 );
+                planned_anger += 10 - int( hp_per / 10 );
             }
         }
+    } else if( friendly < 0 ) {
+        result.follows_player = sees( g->u );
+    }
+    result.anger_change = planned_anger - anger;
+    result.morale_change = planned_morale - morale;
+    return result;
+}
+
+void monster::apply_plan( const monster_plan &plan )
+{
+    anger += plan.anger_change;
+    morale += plan.morale_change;
+    // Roll once per crowding ally like planning on the spot always did, only the last roll sticks
+    for( int i = 0; i < plan.crowded; i++ ) {
+        wander_pos.x = posx() * rng( 1, 3 ) - plan.crowded_by.x;
+        wander_pos.y = posy() * rng( 1, 3 ) - plan.crowded_by.y;
+        wandf = 2;
+    }
+
+    // The target may have died since the plan was made.
+    Creature *target = plan.target;
+    if( target != nullptr ) {
+        const monster *const target_mon = dynamic_cast<const monster *>( target );
+        if( target_mon != nullptr ? target_mon->is_dead() : target->is_dead_state() ) {
+            target = nullptr;
+        }
+    }
+    if( target != nullptr ) {
+        const tripoint dest = target->pos();
+        if( plan.approach_target ) {
+            set_dest( dest );
+        } else if( plan.flee_target ) {
+            set_dest( tripoint( posx() * 2 - dest.x, posy() * 2 - dest.y, posz() ) );
+        }
+    } else if( friendly != 0 && has_effect( effect_docile ) ) {
+        return;
     } else if( friendly > 0 && one_in( 3 ) ) {
         // Grow restless with no targets
         friendly--;
-    } else if( friendly < 0 && sees( g->u ) ) {
+    } else if( friendly < 0 && plan.follows_player ) {
         if( rl_dist( pos(), g->u.pos() ) > 2 ) {
             set_dest( g->u.pos() );
         } else {
@@ -346,6 +399,11 @@ void monster::plan( const mfactions &factions )
     }
 }
 
+void monster::plan( const mfactions &factions )
+{
+    apply_plan( compute_plan( factions ) );
+}
+
 /**
  * Method to make monster movement speed consistent in the face of staggering behavior and
  * differing distance metrics.
@@ -499,7 +557,12 @@ void monster::move()
         if( pf_settings.max_dist >= rl_dist( pos(), goal ) &&
             ( path.empty() || rl_dist( pos(), path.front() ) >= 2 || path.back() != goal ) ) {
             // We need a new path
-            path = g->m.route( pos(), goal, pf_settings, get_path_avoid() );
+            if( goal == g->u.pos() ) {
+                // Whole hordes chase the player, share the search between them
+                path = g->m.route_shared( pos(), goal, pf_settings, get_path_avoid() );
+            } else {
+                path = g->m.route( pos(), goal, pf_settings, get_path_avoid() );
+            }
         }
 
         // Try to respect old paths, even if we can't pathfind at the moment
@@ -691,6 +691,12 @@ bool monster::is_fleeing(player &u) const
 }
 
 Creature::Attitude monster::attitude_to( const Creature &other ) const
+{
+    return attitude_to( other, anger, morale );
+}
+
+Creature::Attitude monster::attitude_to( const Creature &other, const int cur_anger,
+        const int cur_morale ) const
 {
     const auto m = dynamic_cast<const monster *>( &other );
     const auto p = dynamic_cast<const player *>( &other );
@@ -706,14 +712,14 @@ Creature::Attitude monster::attitude_to( const Creature &other ) const
             // Unfriendly monsters go by faction attitude
             return A_FRIENDLY;
         } else if( ( friendly == 0 && m->friendly == 0 && faction_att == MFA_NEUTRAL ) ||
-                     morale < 0 || anger < 10 ) {
+                     cur_morale < 0 || cur_anger < 10 ) {
             // Stuff that won't attack is neutral to everything
             return A_NEUTRAL;
         } else {
             return A_HOSTILE;
         }
     } else if( p != nullptr ) {
-        switch( attitude( const_cast<player *>( p ) ) ) {
+        switch( attitude( p, cur_anger, cur_morale ) ) {
             case MATT_FRIEND:
             case MATT_ZLAVE:
                 return A_FRIENDLY;
@@ -734,6 +740,12 @@ Creature::Attitude monster::attitude_to( const Creature &other ) const
 }
 
 monster_attitude monster::attitude( const Character *u ) const
+{
+    return attitude( u, anger, morale );
+}
+
+monster_attitude monster::attitude( const Character *u, const int cur_anger,
+                                    const int cur_morale ) const
 {
     if( friendly != 0 ) {
         if( has_effect( effect_docile ) ) {
@@ -755,8 +767,8 @@ monster_attitude monster::attitude( const Character *u ) const
         return MATT_ZLAVE;
     }
 
-    int effective_anger  = anger;
-    int effective_morale = morale;
+    int effective_anger  = cur_anger;
+    int effective_morale = cur_morale;
 
     if( u != nullptr ) {
         // Those are checked quite often, so avoiding string construction is a good idea
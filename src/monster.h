@@ -52,6 +52,25 @@ enum monster_effect_cache_fields {
     NUM_MEFF
 };
 
+/**
+ * What @ref monster::plan decided, as computed by @ref monster::compute_plan and
+ * carried out by @ref monster::apply_plan.
+ */
+struct monster_plan {
+    Creature *target = nullptr;
+    /** Set the destination to the target */
+    bool approach_target = false;
+    /** Set the destination away from the target */
+    bool flee_target = false;
+    /** Follow the player, only for pets without a target. */
+    bool follows_player = false;
+    /** Number of swarming allies crowding the monster, it wanders away from the last one at crowded_by. */
+    int crowded = 0;
+    tripoint crowded_by;
+    int anger_change = 0;
+    int morale_change = 0;
+};
+
 class monster : public Creature, public JsonSerializer, public JsonDeserializer
 {
         friend class editmap;
@@ -170,6 +189,13 @@ class monster : public Creature, public JsonSerializer, public JsonDeserializer
         // Pass all factions to mon, so that hordes of same-faction mons
         // do not iterate over each other
         void plan( const mfactions &factions );
+        /**
+         * The decisions of @ref plan without acting on them. Doesn't change anything (not even
+         * the random number generator), so it can run for many monsters at once.
+         */
+        monster_plan compute_plan( const mfactions &factions ) const;
+        /** Acts on a plan from @ref compute_plan, same as @ref plan would. */
+        void apply_plan( const monster_plan &plan );
         void move(); // Actual movement
         void footsteps( const tripoint &p ); // noise made by movement
 
@@ -453,6 +479,9 @@ class monster : public Creature, public JsonSerializer, public JsonDeserializer
         /** Found path. Note: Not used by monsters that don't pathfind! **/
         std::vector<tripoint> path;
         std::bitset<NUM_MEFF> effect_cache;
+        /** @ref attitude and @ref attitude_to as if the monster had the given anger and morale. */
+        monster_attitude attitude( const Character *u, int cur_anger, int cur_morale ) const;
+        Attitude attitude_to( const Creature &other, int cur_anger, int cur_morale ) const;
 
     protected:
         void store( JsonOut &jsout ) const;
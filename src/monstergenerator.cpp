@@ -205,6 +205,8 @@ void MonsterGenerator::finalize_pathfinding_settings( mtype &mon )
     if( mon.has_flag( MF_CLIMBS ) ) {
         mon.path_settings.climb_cost = 3;
     }
+
+    mon.path_settings.allow_hierarchical = mon.path_settings.plain_walking();
 }
 
 template <typename T>
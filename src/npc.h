@@ -797,6 +797,7 @@ class npc : public player
         int  worst_item_value; // The value of our least-wanted item
 
         std::vector<tripoint> path; // Our movement plans
+        int path_repairs = 0; // Times `path` was repaired since it was last planned from scratch
 
         // Personality & other defining characteristics
         std::string fac_id; // A temp variable used to inform the game which faction to link
@@ -22,6 +22,8 @@
 #include "gates.h"
 
 #include <algorithm>
+#include <map>
+#include <set>
 #include <sstream>
 
 // @todo Get rid of this include
@@ -70,6 +72,63 @@ void print_action( const char *prepend, npc_action action );
 
 hp_part most_damaged_hp_part( const Character &c );
 
+// Paths of the NPCs following the player, all planned by a single search.
+// Valid for one turn, one goal and one state of the map. Creatures moving during the turn
+// don't invalidate it, the followers repair their paths when something stands in the way.
+struct squad_route_cache {
+    int turn = -1;
+    tripoint goal = tripoint_min;
+    tripoint abs_sub = tripoint_min;
+    int revision = -1;
+    pathfinding_settings settings;
+    // Not yet handed out paths, by the position of the NPC they were planned for
+    std::map<tripoint, std::vector<tripoint>> paths;
+};
+
+// Path of a following NPC to `p`. The first follower that asks plans the paths
+// of all followers that may need one; each of them takes its own later on.
+static std::vector<tripoint> squad_route( const npc &guy, const tripoint &p, bool no_bashing,
+        const pathfinding_settings &settings, const std::set<tripoint> &avoid )
+{
+    static squad_route_cache cache;
+    const int turn = calendar::turn;
+    const tripoint abs_sub = g->m.get_abs_sub();
+    const int revision = g->m.pathfinding_revision( p.z );
+    if( cache.turn != turn || cache.goal != p || cache.abs_sub != abs_sub ||
+        cache.revision != revision || !( cache.settings == settings ) ) {
+        cache.turn = turn;
+        cache.goal = p;
+        cache.abs_sub = abs_sub;
+        cache.revision = revision;
+        cache.settings = settings;
+        cache.paths.clear();
+
+        std::vector<tripoint> origins( 1, guy.pos() );
+        for( const npc &other : g->all_npcs() ) {
+            if( &other != &guy && other.is_following() && other.posz() == guy.posz() &&
+                ( other.path.empty() || other.path.back() != p ) &&
+                other.get_pathfinding_settings( no_bashing ) == settings ) {
+                origins.push_back( other.pos() );
+            }
+        }
+        if( origins.size() == 1 ) {
+            return g->m.route( guy.pos(), p, settings, avoid );
+        }
+        auto paths = g->m.route_many( origins, p, settings, avoid );
+        for( size_t i = 0; i < origins.size(); i++ ) {
+            cache.paths[origins[i]] = std::move( paths[i] );
+        }
+    }
+
+    const auto iter = cache.paths.find( guy.pos() );
+    if( iter == cache.paths.end() ) {
+        return g->m.route( guy.pos(), p, settings, avoid );
+    }
+    std::vector<tripoint> ret = std::move( iter->second );
+    cache.paths.erase( iter );
+    return ret;
+}
+
 // Used in npc::drop_items()
 struct ratio_index {
     double ratio;
@@ -1389,7 +1448,27 @@ bool npc::update_path( const tripoint &p, const bool no_bashing, bool force )
         }
     }
 
-    auto new_path = g->m.route( pos(), p, get_pathfinding_settings( no_bashing ), get_path_avoid() );
+    // Following a moving target mostly needs small changes to the old path
+    constexpr int max_path_repairs = 20;
+    const auto &settings = get_pathfinding_settings( no_bashing );
+    const auto avoid = get_path_avoid();
+    if( !path.empty() && path_repairs < max_path_repairs ) {
+        auto repaired = path;
+        if( g->m.repair_route( repaired, pos(), p, settings, avoid ) ) {
+            path = std::move( repaired );
+            path_repairs++;
+            return true;
+        }
+    }
+
+    path_repairs = 0;
+    // Followers all head for the player, so their paths are planned with a single search
+    std::vector<tripoint> new_path;
+    if( is_following() && p == g->u.pos() ) {
+        new_path = squad_route( *this, p, no_bashing, settings, avoid );
+    } else {
+        new_path = g->m.route( pos(), p, settings, avoid );
+    }
     if( new_path.empty() ) {
         add_msg( m_debug, "Failed to path %d,%d,%d->%d,%d,%d",
                  posx(), posy(), posz(), p.x, p.y, p.z );
@@ -37,6 +37,7 @@ bool use_tiles;
 bool log_from_top;
 int message_ttl;
 bool fov_3d;
+int worker_threads;
 bool tile_iso;
 
 #ifdef TILES
@@ -1296,6 +1297,11 @@ void options_manager::init()
         false
         );
 
+    add( "WORKER_THREADS", "debug", translate_marker( "Worker threads" ),
+        translate_marker( "Number of threads used to cast light and field of vision, spread fire and simple gases like smoke, plan the monsters' turns and move the hordes of the overmaps around the player.  1 runs everything on the main thread, the other fields always change there.  With more than 1, all monsters plan at the start of the turn and act on that plan in their first move.  Otherwise the results are the same with any number of threads." ),
+        1, 64, 1
+        );
+
     add( "ENCODING_CONV", "debug", translate_marker( "Experimental path name encoding conversion" ),
         translate_marker( "If true, file path names are going to be transcoded from system encoding to UTF-8 when reading and will be transcoded back when writing.  Mainly for CJK Windows users." ),
         true
@@ -1981,6 +1987,7 @@ bool options_manager::save()
     log_from_top = ::get_option<std::string>( "LOG_FLOW" ) == "new_top";
     message_ttl = ::get_option<int>( "MESSAGE_TTL" );
     fov_3d = ::get_option<bool>( "FOV_3D" );
+    worker_threads = ::get_option<int>( "WORKER_THREADS" );
 
     update_music_volume();
 
@@ -2009,6 +2016,7 @@ void options_manager::load()
     log_from_top = ::get_option<std::string>( "LOG_FLOW" ) == "new_top";
     message_ttl = ::get_option<int>( "MESSAGE_TTL" );
     fov_3d = ::get_option<bool>( "FOV_3D" );
+    worker_threads = ::get_option<int>( "WORKER_THREADS" );
 }
 
 bool options_manager::load_legacy()
@@ -38,8 +38,10 @@
 #include "messages.h"
 #include "rotatable_symbols.h"
 #include "string_input_popup.h"
+#include "worker_pool.h"
 
 #include <cassert>
+#include <climits>
 #include <stdlib.h>
 #include <time.h>
 #include <math.h>
@@ -49,6 +51,7 @@
 #include <ostream>
 #include <algorithm>
 #include <numeric>
+#include <random>
 
 #define dbg(x) DebugLog((DebugLevel)(x),D_MAP_GEN) << __FILE__ << ":" << __LINE__ << ": "
 
@@ -1859,7 +1862,7 @@ std::vector<point> overmap::find_terrain(const std::string &term, int zlevel)
     for (int x = 0; x < OMAPX; x++) {
         for (int y = 0; y < OMAPY; y++) {
             if (seen(x, y, zlevel) &&
-                lcmatch( ter(x, y, zlevel)->get_name(), term ) ) {
+                lcmatch( get_ter(x, y, zlevel)->get_name(), term ) ) {
                 found.push_back( global_base_point() + point( x, y ) );
             }
         }
@@ -2122,7 +2125,7 @@ void overmap::draw(WINDOW *w, WINDOW *wbar, const tripoint &center,
             const bool see = has_debug_vision || overmap_buffer.seen(omx, omy, z);
             if (see) {
                 // Only load terrain if we can actually see it
-                cur_ter = overmap_buffer.ter(omx, omy, z);
+                cur_ter = overmap_buffer.get_ter(omx, omy, z);
             }
 
             tripoint const cur_pos {omx, omy, z};
@@ -2698,7 +2701,7 @@ tripoint overmap::draw_overmap(const tripoint &orig, const draw_data_t &data)
                         }
 
                         if( om->seen( om_relative_x, om_relative_y, curs.z ) &&
-                            lcmatch( om->ter( om_relative_x, om_relative_y, curs.z )->get_name(), term ) ) {
+                            lcmatch( om->get_ter( om_relative_x, om_relative_y, curs.z )->get_name(), term ) ) {
                             locations.push_back( om->global_base_point() + point( om_relative_x, om_relative_y ) );
                         }
                     }
@@ -2934,11 +2937,20 @@ void overmap::clear_mon_groups()
 }
 
 void mongroup::wander( overmap &om )
+{
+    choose_wander_target( om, horde_behaviour == "city", pos, []( const int lo, const int hi ) {
+        return rng( lo, hi );
+    }, target, interest );
+}
+
+void mongroup::choose_wander_target( const overmap &om, const bool to_city, const tripoint &pos,
+                                     const std::function<int( int, int )> &roll,
+                                     tripoint &target, int &interest )
 {
     const city *target_city = nullptr;
     int target_distance = 0;
 
-    if( horde_behaviour == "city" ) {
+    if( to_city ) {
         // Find a nearby city to return to..
         for(const city &check_city : om.cities ) {
             // Check if this is the nearest city so far.
@@ -2954,41 +2966,114 @@ void mongroup::wander( overmap &om )
         // TODO: somehow use the same algorithm that distributes zombie
         // density at world gen to spread the hordes over the actual
         // city, rather than the center city tile
-        target.x = target_city->x * 2 + rng( -5, 5 );
-        target.y = target_city->y * 2 + rng( -5, 5 );
+        target.x = target_city->x * 2 + roll( -5, 5 );
+        target.y = target_city->y * 2 + roll( -5, 5 );
         interest = 100;
     } else {
-        target.x = pos.x + rng( -10, 10 );
-        target.y = pos.y + rng( -10, 10 );
+        target.x = pos.x + roll( -10, 10 );
+        target.y = pos.y + roll( -10, 10 );
         interest = 30;
     }
 }
 
+static horde_movement to_horde_movement( const std::string &behaviour )
+{
+    if( behaviour == "city" ) {
+        return horde_movement::city;
+    } else if( behaviour == "roam" ) {
+        return horde_movement::roam;
+    }
+    return horde_movement::unset;
+}
+
+static std::string to_horde_behaviour( const horde_movement movement )
+{
+    switch( movement ) {
+        case horde_movement::city:
+            return "city";
+        case horde_movement::roam:
+            return "roam";
+        case horde_movement::unset:
+            break;
+    }
+    return "";
+}
+
 void overmap::move_hordes()
 {
-    // Prevent hordes to be moved twice by putting them in here after moving.
-    decltype(zg) tmpzg;
-    //MOVE ZOMBIE GROUPS
-    for( auto it = zg.begin(); it != zg.end(); ) {
-        mongroup &mg = it->second;
+    move_hordes( { this } );
+}
+
+void overmap::move_hordes( const std::vector<overmap *> &overmaps )
+{
+    std::vector<horde_table> hordes;
+    std::vector<unsigned int> seeds;
+    hordes.reserve( overmaps.size() );
+    for( overmap *om : overmaps ) {
+        hordes.push_back( om->gather_hordes() );
+        seeds.push_back( rng( 0, INT_MAX ) );
+    }
+    const auto plan = [&]( const int index, int ) {
+        overmaps[index]->plan_horde_moves( hordes[index], seeds[index] );
+    };
+    worker_pool *workers = shared_workers();
+    if( workers != nullptr && overmaps.size() > 1 ) {
+        workers->run( overmaps.size(), plan );
+    } else {
+        for( size_t index = 0; index < overmaps.size(); index++ ) {
+            plan( index, 0 );
+        }
+    }
+    for( size_t index = 0; index < overmaps.size(); index++ ) {
+        overmaps[index]->apply_horde_moves( hordes[index] );
+    }
+}
+
+horde_table overmap::gather_hordes()
+{
+    horde_table hordes;
+    for( auto it = zg.begin(); it != zg.end(); ++it ) {
+        const mongroup &mg = it->second;
         if( !mg.horde ) {
-            ++it;
             continue;
         }
+        hordes.groups.push_back( it );
+        hordes.pos.push_back( mg.pos );
+        hordes.target.push_back( mg.target );
+        hordes.interest.push_back( mg.interest );
+        hordes.movement.push_back( to_horde_movement( mg.horde_behaviour ) );
+    }
+    hordes.moved.assign( hordes.groups.size(), false );
+    return hordes;
+}
+
+void overmap::plan_horde_moves( horde_table &hordes, const unsigned int seed ) const
+{
+    std::minstd_rand engine( seed );
+    const auto roll = [&engine]( const int lo, const int hi ) {
+        return std::uniform_int_distribution<int>( lo, hi )( engine );
+    };
+
+    for( size_t i = 0; i < hordes.groups.size(); i++ ) {
+        tripoint &pos = hordes.pos[i];
+        tripoint &target = hordes.target[i];
+        int &interest = hordes.interest[i];
+        horde_movement &movement = hordes.movement[i];
 
-        if(mg.horde_behaviour == "") {
-            mg.horde_behaviour = one_in(2) ? "city" : "roam";
+        if( movement == horde_movement::unset ) {
+            movement = roll( 0, 1 ) == 0 ? horde_movement::city : horde_movement::roam;
         }
 
         // Gradually decrease interest.
-        mg.dec_interest( 1 );
+        interest = mongroup::decreased_interest( interest, 1 );
 
-        if( (mg.pos.x == mg.target.x && mg.pos.y == mg.target.y) || mg.interest <= 15 ) {
-            mg.wander(*this);
+        if( ( pos.x == target.x && pos.y == target.y ) || interest <= 15 ) {
+            mongroup::choose_wander_target( *this, movement == horde_movement::city, pos, roll,
+                                            target, interest );
         }
 
         // Decrease movement chance according to the terrain we're currently on.
-        const oter_id& walked_into = ter(mg.pos.x, mg.pos.y, mg.pos.z);
+        const oter_id walked_into = get_ter( pos.x, pos.y, pos.z );
         int movement_chance = 1;
         if(walked_into == ot_forest || walked_into == ot_forest_water) {
             movement_chance = 3;
@@ -2998,32 +3083,41 @@ void overmap::move_hordes()
             movement_chance = 10;
         }
 
-        if( one_in(movement_chance) && rng(0, 100) < mg.interest ) {
+        if( roll( 0, movement_chance - 1 ) == 0 && roll( 0, 100 ) < interest ) {
             // TODO: Adjust for monster speed.
             // TODO: Handle moving to adjacent overmaps.
-            if( mg.pos.x > mg.target.x) {
-                mg.pos.x--;
+            if( pos.x > target.x) {
+                pos.x--;
             }
-            if( mg.pos.x < mg.target.x) {
-                mg.pos.x++;
+            if( pos.x < target.x) {
+                pos.x++;
             }
-            if( mg.pos.y > mg.target.y) {
-                mg.pos.y--;
+            if( pos.y > target.y) {
+                pos.y--;
             }
-            if( mg.pos.y < mg.target.y) {
-                mg.pos.y++;
+            if( pos.y < target.y) {
+                pos.y++;
             }
+            hordes.moved[i] = true;
+        }
+    }
+}
 
+void overmap::apply_horde_moves( const horde_table &hordes )
+{
+    for( size_t i = 0; i < hordes.groups.size(); i++ ) {
+        const auto it = hordes.groups[i];
+        mongroup &mg = it->second;
+        mg.target = hordes.target[i];
+        mg.interest = hordes.interest[i];
+        mg.horde_behaviour = to_horde_behaviour( hordes.movement[i] );
+        if( hordes.moved[i] ) {
             // Erase the group at it's old location, add the group with the new location
-            tmpzg.insert( std::pair<tripoint, mongroup>( mg.pos, mg ) );
-            zg.erase( it++ );
-        } else {
-            ++it;
+            mg.pos = hordes.pos[i];
+            zg.emplace( mg.pos, std::move( mg ) );
+            zg.erase( it );
         }
     }
-    // and now back into the monster group map.
-    zg.insert( tmpzg.begin(), tmpzg.end() );
-
 
     if(get_option<bool>( "WANDER_SPAWNS" ) ) {
         static const mongroup_id GROUP_ZOMBIE("GROUP_ZOMBIE");
@@ -3090,38 +3184,47 @@ void overmap::move_hordes()
 */
 void overmap::signal_hordes( const tripoint &p, const int sig_power)
 {
-    for( auto &elem : zg ) {
-        mongroup &mg = elem.second;
-        if( !mg.horde ) {
-            continue;
+    // zg is ordered by x first, so the hordes of each column within reach are one range of it.
+    // Nothing outside the square can be in reach, rl_dist is never shorter than dx or dy.
+    for( int x = p.x - sig_power; x <= p.x + sig_power; x++ ) {
+        const auto column_end = zg.upper_bound( tripoint( x, p.y + sig_power, INT_MAX ) );
+        for( auto it = zg.lower_bound( tripoint( x, p.y - sig_power, INT_MIN ) ); it != column_end; ++it ) {
+            signal_horde( it->second, p, sig_power );
+        }
+    }
+}
+
+void overmap::signal_horde( mongroup &mg, const tripoint &p, const int sig_power )
+{
+    if( !mg.horde ) {
+        return;
+    }
+    const int dist = rl_dist( p, mg.pos );
+    if( sig_power < dist ) {
+        return;
+    }
+    // TODO: base this in monster attributes, foremost GOODHEARING.
+    const int inter_per_sig_power = 15; //Interest per signal value
+    const int min_initial_inter = 30; //Min initial interest for horde
+    const int calculated_inter = ( sig_power + 1 - dist ) * inter_per_sig_power; // Calculated interest
+    const int roll = rng( 0, mg.interest );
+    // Minimum capped calculated interest. Used to give horde enough interest to really investigate the target at start.
+    const int min_capped_inter = std::max( min_initial_inter, calculated_inter );
+    if( roll < min_capped_inter ) { //Rolling if horde interested in new signal
+        // TODO: Z coord for mongroup targets
+        const int targ_dist = rl_dist( p, mg.target );
+        // TODO: Base this on targ_dist:dist ratio.
+        if ( targ_dist < 5 ) { // If signal source already pursued by horde
+            mg.set_target( (mg.target.x + p.x) / 2, (mg.target.y + p.y) / 2 );
+            const int min_inc_inter = 3; // Min interest increase to already targeted source
+            const int inc_roll = rng( min_inc_inter, calculated_inter );
+            mg.inc_interest( inc_roll );
+            add_msg( m_debug, "horde inc interest %d dist %d", inc_roll, dist ) ;
+        } else { // New signal source
+            mg.set_target( p.x, p.y );
+            mg.set_interest( min_capped_inter );
+            add_msg( m_debug, "horde set interest %d dist %d", min_capped_inter, dist );
         }
-            const int dist = rl_dist( p, mg.pos );
-            if( sig_power < dist ) {
-                continue;
-            }
-            // TODO: base this in monster attributes, foremost GOODHEARING.
-            const int inter_per_sig_power = 15; //Interest per signal value
-            const int min_initial_inter = 30; //Min initial interest for horde
-            const int calculated_inter = ( sig_power + 1 - dist ) * inter_per_sig_power; // Calculated interest
-            const int roll = rng( 0, mg.interest );
-            // Minimum capped calculated interest. Used to give horde enough interest to really investigate the target at start.
-            const int min_capped_inter = std::max( min_initial_inter, calculated_inter );
-            if( roll < min_capped_inter ) { //Rolling if horde interested in new signal
-                // TODO: Z coord for mongroup targets
-                const int targ_dist = rl_dist( p, mg.target );
-                // TODO: Base this on targ_dist:dist ratio.
-                if ( targ_dist < 5 ) { // If signal source already pursued by horde
-                    mg.set_target( (mg.target.x + p.x) / 2, (mg.target.y + p.y) / 2 );
-                    const int min_inc_inter = 3; // Min interest increase to already targeted source
-                    const int inc_roll = rng( min_inc_inter, calculated_inter );
-                    mg.inc_interest( inc_roll );
-                    add_msg( m_debug, "horde inc interest %d dist %d", inc_roll, dist ) ;
-                } else { // New signal source
-                    mg.set_target( p.x, p.y );
-                    mg.set_interest( min_capped_inter );
-                    add_msg( m_debug, "horde set interest %d dist %d", min_capped_inter, dist );
-                }
-            }
     }
 }
 
@@ -3844,9 +3947,71 @@ pf::path overmap::lay_out_street( const overmap_connection &connection, const po
     return pf::straight_path( source, static_cast<int>( dir ), actual_len );
 }
 
+const overmap_connection_graph &overmap::get_connection_graph( const overmap_connection &connection,
+        const int z ) const
+{
+    const auto key = std::make_pair( connection.id, z );
+    const auto iter = connection_graphs.find( key );
+    if( iter != connection_graphs.end() ) {
+        return iter->second;
+    }
+
+    overmap_connection_graph &graph = connection_graphs[key];
+    const auto on_network = [&]( const point &p ) {
+        return inbounds( p.x, p.y, z ) && connection.has( get_ter( p.x, p.y, z ) );
+    };
+
+    for( int x = 0; x < OMAPX; x++ ) {
+        for( int y = 0; y < OMAPY; y++ ) {
+            const point p( x, y );
+            if( !on_network( p ) ) {
+                continue;
+            }
+            int neighbors = 0;
+            for( const auto dir : om_direction::all ) {
+                if( on_network( p + om_direction::displace( dir ) ) ) {
+                    neighbors++;
+                }
+            }
+            // Border tiles lead to the neighboring overmaps
+            if( neighbors != 2 || x == 0 || y == 0 || x == OMAPX - 1 || y == OMAPY - 1 ) {
+                graph.node_at[p] = graph.nodes.size();
+                graph.nodes.push_back( { p, {} } );
+            }
+        }
+    }
+
+    for( auto &n : graph.nodes ) {
+        for( const auto dir : om_direction::all ) {
+            point prev = n.pos;
+            point cur = n.pos + om_direction::displace( dir );
+            if( !on_network( cur ) ) {
+                continue;
+            }
+            int length = 1;
+            // Tiles between nodes have exactly two neighbors, keep going away from the previous one
+            while( graph.node_at.count( cur ) == 0 ) {
+                for( const auto next_dir : om_direction::all ) {
+                    const point next = cur + om_direction::displace( next_dir );
+                    if( next != prev && on_network( next ) ) {
+                        prev = cur;
+                        cur = next;
+                        break;
+                    }
+                }
+                length++;
+            }
+            n.edges.push_back( { graph.node_at[cur], length, dir } );
+        }
+    }
+
+    return graph;
+}
+
 void overmap::build_connection( const overmap_connection &connection, const pf::path &path, int z )
 {
     om_direction::type prev_dir = om_direction::type::invalid;
+    clear_connection_graphs();
 
     for( const auto &node : path.nodes ) {
         const tripoint pos( node.x, node.y, z );
@@ -4241,6 +4406,7 @@ void overmap::place_special( const overmap_special &special, const tripoint &p,
     assert( dir != om_direction::type::invalid );
 
     const bool blob = special.flags.count( "BLOB" ) > 0;
+    clear_connection_graphs();
 
     for( const auto &elem : special.terrains ) {
         const tripoint location = p + om_direction::rotate( elem.p, dir );
@@ -4549,6 +4715,7 @@ void overmap::open( overmap_special_batch &enabled_specials )
         // pointers looks like (north, south, west, east)
         generate( pointers[0], pointers[3], pointers[1], pointers[2], enabled_specials );
     }
+    clear_connection_graphs();
 }
 
 // Note: this may throw io errors from std::ofstream
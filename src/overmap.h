@@ -28,6 +28,28 @@ class overmap_connection;
 
 struct mongroup;
 
+/** Where a horde heads when it loses interest, see @ref mongroup::horde_behaviour. */
+enum class horde_movement : int {
+    unset,
+    city,
+    roam
+};
+
+/**
+ * The hordes of an overmap with every field the horde passes update in an array of its own,
+ * so a pass over thousands of hordes only touches what it uses.
+ * See @ref overmap::plan_horde_moves.
+ */
+struct horde_table {
+    std::vector<std::multimap<tripoint, mongroup>::iterator> groups;
+    std::vector<tripoint> pos;
+    std::vector<tripoint> target;
+    std::vector<int> interest;
+    std::vector<horde_movement> movement;
+    /** Whether the horde stepped and needs to be filed under its new position. */
+    std::vector<char> moved;
+};
+
 namespace pf
 {
     struct path;
@@ -213,6 +235,33 @@ struct map_layer {
     std::vector<om_note> notes;
 };
 
+/**
+ * Sparse graph of a connection network (e.g. roads) on one z-level of an overmap.
+ * Nodes are junctions, dead ends and tiles on the overmap border, edges are the unbranched
+ * stretches of connection between them, so routes along the network skip everything in
+ * between. Adjacent tiles of the network count as connected.
+ */
+struct overmap_connection_graph {
+    struct edge {
+        /** Index of the node at the other end */
+        int to;
+        /** Number of steps to get there */
+        int length;
+        /** Direction of the first step */
+        om_direction::type dir;
+    };
+
+    struct node {
+        /** Local overmap terrain coordinates */
+        point pos;
+        std::vector<edge> edges;
+    };
+
+    std::vector<node> nodes;
+    /** Index of the node at every position that has one */
+    std::unordered_map<point, int> node_at;
+};
+
 // Wrapper around an overmap special to track progress of placing specials.
 struct overmap_special_placement {
     int instances_placed;
@@ -383,6 +432,17 @@ class overmap
     // Returns a batch of the default enabled specials.
     overmap_special_batch get_enabled_specials() const;
 
+    /**
+     * Graph of the given connection network on z-level z. Built on first use and kept
+     * until the terrain of the overmap changes.
+     */
+    const overmap_connection_graph &get_connection_graph( const overmap_connection &connection,
+            int z ) const;
+    /** Drops the graphs of @ref get_connection_graph, needed after writing terrain through @ref ter */
+    void clear_connection_graphs() {
+        connection_graphs.clear();
+    }
+
     void clear_mon_groups();
 private:
     std::multimap<tripoint, mongroup> zg;
@@ -423,6 +483,10 @@ public:
     std::array<map_layer, OVERMAP_LAYERS> layer;
     std::unordered_map<tripoint, scent_trace> scents;
 
+    /** Cache of @ref get_connection_graph, see @ref clear_connection_graphs */
+    mutable std::map<std::pair<string_id<overmap_connection>, int>, overmap_connection_graph>
+    connection_graphs;
+
     /**
      * When monsters despawn during map-shifting they will be added here.
      * map::spawn_monsters will load them and place them into the reality bubble
@@ -457,8 +521,27 @@ public:
     const city &get_nearest_city( const tripoint &p ) const;
 
     void signal_hordes( const tripoint &p, int sig_power );
+    /** Lets a single group react to a signal, see @ref signal_hordes. */
+    void signal_horde( mongroup &mg, const tripoint &p, int sig_power );
     void process_mongroups();
     void move_hordes();
+    /** Collects the hordes of this overmap for @ref plan_horde_moves. */
+    horde_table gather_hordes();
+    /**
+     * Picks new targets and steps for the hordes. Draws from its own random stream seeded
+     * with `seed` and only reads the terrain and cities of this overmap, so several overmaps
+     * can be planned at once.
+     */
+    void plan_horde_moves( horde_table &hordes, unsigned int seed ) const;
+    /** Writes the planned moves back to the hordes and lets wandering zombies join them. */
+    void apply_horde_moves( const horde_table &hordes );
+ public:
+    /**
+     * Moves the hordes of all the given overmaps. The overmaps are planned on the
+     * shared workers, the results don't depend on the number of threads.
+     */
+    static void move_hordes( const std::vector<overmap *> &overmaps );
+ private:
 
     static bool obsolete_terrain( const std::string &ter );
     void convert_terrain( const std::unordered_map<tripoint, std::string> &needs_conversion );
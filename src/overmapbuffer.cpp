@@ -389,9 +389,7 @@ void overmapbuffer::move_hordes()
     // arbitrary radius to include nearby overmaps (aside from the current one)
     const auto radius = MAPSIZE * 2;
     const auto center = g->u.global_sm_location();
-    for( auto &om : get_overmaps_near( center, radius ) ) {
-        om->move_hordes();
-    }
+    overmap::move_hordes( get_overmaps_near( center, radius ) );
 }
 
 std::vector<mongroup*> overmapbuffer::monsters_at(int x, int y, int z)
@@ -515,9 +513,16 @@ void overmapbuffer::set_seen(int x, int y, int z, bool seen)
 
 oter_id& overmapbuffer::ter(int x, int y, int z) {
     overmap &om = get_om_global(x, y);
+    // The terrain may get changed through the reference
+    om.clear_connection_graphs();
     return om.ter(x, y, z);
 }
 
+const oter_id overmapbuffer::get_ter(int x, int y, int z) {
+    const overmap &om = get_om_global(x, y);
+    return om.get_ter(x, y, z);
+}
+
 bool overmapbuffer::reveal(const point &center, int radius, int z)
 {
     return reveal( tripoint( center, z ), radius );
@@ -537,6 +542,176 @@ bool overmapbuffer::reveal( const tripoint &center, int radius )
     return result;
 }
 
+std::vector<tripoint> overmapbuffer::find_connection_route( const overmap_connection &connection,
+        const tripoint &source, const tripoint &dest, const int max_dist )
+{
+    struct visit {
+        int cost;
+        tripoint parent;
+        // Direction of the first step from the parent and number of steps
+        om_direction::type dir;
+        int length;
+        bool closed;
+    };
+    struct hop {
+        tripoint to;
+        int length;
+        om_direction::type dir;
+    };
+
+    const auto on_network = [&]( const tripoint &p ) {
+        int x = p.x;
+        int y = p.y;
+        const overmap &om = get_om_global( x, y );
+        return connection.has( om.get_ter( x, y, p.z ) );
+    };
+    const auto is_node = [&]( const tripoint &p ) {
+        int x = p.x;
+        int y = p.y;
+        const overmap &om = get_om_global( x, y );
+        return om.get_connection_graph( connection, p.z ).node_at.count( point( x, y ) ) > 0;
+    };
+    // Longest unbranched stretch an overmap can hold, walks going further circle a loop without nodes
+    const int max_stretch = OMAPX * OMAPY;
+    // Follows an unbranched stretch of the network, stopping at a node, at dest, back at the start
+    // or after max_length steps
+    const auto walk = [&]( const tripoint &from, const om_direction::type dir, const int max_length,
+    std::vector<tripoint> *tiles ) {
+        tripoint prev = from;
+        tripoint cur = from + om_direction::displace( dir );
+        om_direction::type last_dir = dir;
+        int length = 1;
+        while( length < max_length && cur != dest && cur != from && !is_node( cur ) ) {
+            if( tiles != nullptr ) {
+                tiles->push_back( cur );
+            }
+            for( const auto next_dir : om_direction::all ) {
+                const tripoint next = cur + om_direction::displace( next_dir );
+                if( next != prev && on_network( next ) ) {
+                    prev = cur;
+                    cur = next;
+                    last_dir = next_dir;
+                    break;
+                }
+            }
+            length++;
+        }
+        if( tiles != nullptr ) {
+            tiles->push_back( cur );
+        }
+        return std::make_pair( hop{ cur, length, dir }, last_dir );
+    };
+
+    std::vector<tripoint> route;
+    if( !on_network( source ) || !on_network( dest ) ) {
+        return route;
+    }
+
+    // Ends of the stretch the destination is on, where the search can leave the graph toward it
+    std::vector<hop> to_dest;
+    if( !is_node( dest ) ) {
+        for( const auto dir : om_direction::all ) {
+            if( on_network( dest + om_direction::displace( dir ) ) ) {
+                const auto end = walk( dest, dir, max_stretch, nullptr );
+                if( !is_node( end.first.to ) ) {
+                    continue;
+                }
+                to_dest.push_back( { end.first.to, end.first.length, om_direction::opposite( end.second ) } );
+            }
+        }
+    }
+
+    const auto hops_from = [&]( const tripoint &p ) {
+        std::vector<hop> hops;
+        int x = p.x;
+        int y = p.y;
+        const overmap &om = get_om_global( x, y );
+        const auto &graph = om.get_connection_graph( connection, p.z );
+        const auto iter = graph.node_at.find( point( x, y ) );
+        if( iter == graph.node_at.end() ) {
+            // Only the source can be between nodes
+            for( const auto dir : om_direction::all ) {
+                if( !on_network( p + om_direction::displace( dir ) ) ) {
+                    continue;
+                }
+                const hop h = walk( p, dir, max_stretch, nullptr ).first;
+                if( h.to == dest || is_node( h.to ) ) {
+                    hops.push_back( h );
+                }
+            }
+            return hops;
+        }
+
+        const point base = om.global_base_point();
+        for( const auto &e : graph.nodes[iter->second].edges ) {
+            const point &to = graph.nodes[e.to].pos;
+            hops.push_back( { tripoint( base.x + to.x, base.y + to.y, p.z ), e.length, e.dir } );
+        }
+        for( const auto dir : om_direction::all ) {
+            // Crossings into the neighboring overmaps
+            const tripoint next = p + om_direction::displace( dir );
+            if( omt_to_om_copy( next ) != omt_to_om_copy( p ) && is_node( next ) ) {
+                hops.push_back( { next, 1, dir } );
+            }
+        }
+        for( const hop &h : to_dest ) {
+            if( h.to == p ) {
+                hops.push_back( { dest, h.length, h.dir } );
+            }
+        }
+        return hops;
+    };
+
+    const auto estimate = [&]( const tripoint &p ) {
+        return std::abs( dest.x - p.x ) + std::abs( dest.y - p.y );
+    };
+
+    std::unordered_map<tripoint, visit> visited;
+    pf::bucket_queue<tripoint> open;
+    visited[source] = { 0, source, om_direction::type::invalid, 0, false };
+    open.push( source, estimate( source ) );
+    while( !open.empty() ) {
+        const tripoint cur = open.pop();
+        visit &cur_visit = visited[cur];
+        if( cur_visit.closed ) {
+            continue;
+        }
+        if( cur == dest ) {
+            break;
+        }
+        cur_visit.closed = true;
+        const int cost = cur_visit.cost;
+
+        for( const hop &h : hops_from( cur ) ) {
+            if( std::abs( h.to.x - source.x ) > max_dist || std::abs( h.to.y - source.y ) > max_dist ) {
+                continue;
+            }
+            const auto iter = visited.find( h.to );
+            if( iter == visited.end() || ( !iter->second.closed && iter->second.cost > cost + h.length ) ) {
+                visited[h.to] = { cost + h.length, cur, h.dir, h.length, false };
+                open.push( h.to, cost + h.length + estimate( h.to ) );
+            }
+        }
+    }
+
+    const auto iter = visited.find( dest );
+    if( iter == visited.end() ) {
+        return route;
+    }
+
+    // Hops from the destination back to the source, then their tiles from the source on
+    std::vector<tripoint> hops;
+    for( tripoint cur = dest; cur != source; cur = visited[cur].parent ) {
+        hops.push_back( cur );
+    }
+    route.push_back( source );
+    for( auto it = hops.rbegin(); it != hops.rend(); ++it ) {
+        const visit &v = visited[*it];
+        walk( v.parent, v.dir, v.length, &route );
+    }
+    return route;
+}
+
 bool overmapbuffer::reveal_route( const tripoint &source, const tripoint &dest, int radius, bool road_only )
 {
     static const int RADIUS = 4;            // Maximal radius of search (in overmaps)
@@ -565,16 +740,20 @@ bool overmapbuffer::reveal_route( const tripoint &source, const tripoint &dest,
         return false;
     }
 
+    if( road_only ) {
+        const auto route = find_connection_route( connection.obj(), source, dest, OX - 1 );
+        for( const tripoint &p : route ) {
+            reveal( p, radius );
+        }
+        return !route.empty();
+    }
+
     const auto estimate = [&]( const pf::node &cur, const pf::node * ) {
         int res = 0;
 
         const auto oter = get_ter_at( cur.x, cur.y );
 
         if( !connection->has( oter ) ) {
-            if( road_only ) {
-                return pf::rejected;
-            }
-
             if( is_river( oter ) ) {
                 return pf::rejected; // Can't walk on water
             }
@@ -901,7 +1080,7 @@ city_reference overmapbuffer::closest_known_city( const tripoint &center )
 
 std::string overmapbuffer::get_description_at( const tripoint &where )
 {
-    const std::string ter_name = ter( sm_to_omt_copy( where ) )->get_name();
+    const std::string ter_name = get_ter( sm_to_omt_copy( where ) )->get_name();
 
     if( where.z != 0 ) {
         return ter_name;
@@ -21,6 +21,7 @@ struct oter_t;
 using oter_id = int_id<oter_t>;
 
 class overmap;
+class overmap_connection;
 class overmap_special;
 class overmap_special_batch;
 struct radio_tower;
@@ -78,6 +79,12 @@ public:
      */
     oter_id& ter(int x, int y, int z);
     oter_id& ter(const tripoint& p) { return ter(p.x, p.y, p.z); }
+    /**
+     * Like @ref ter, but only for reading. @ref ter assumes the terrain gets changed
+     * and drops the cached connection graphs of the overmap.
+     */
+    const oter_id get_ter(int x, int y, int z);
+    const oter_id get_ter(const tripoint& p) { return get_ter(p.x, p.y, p.z); }
     /**
      * Uses global overmap terrain coordinates.
      */
@@ -231,6 +238,17 @@ public:
     bool reveal( const tripoint &center, int radius );
 
     bool reveal_route( const tripoint &source, const tripoint &dest, int radius = 0, bool road_only = false );
+    /**
+     * Shortest route between two tiles of a connection network (e.g. roads). Searches over
+     * the connection graphs of the overmaps on the way instead of going tile by tile.
+     * @param source Start of the route, absolute overmap terrain coordinates.
+     * @param dest End of the route, absolute overmap terrain coordinates.
+     * @param max_dist Maximal distance of the route from the source along either axis.
+     * @returns All tiles of the route including both ends (absolute overmap terrain
+     * coordinates), or empty vector if there is no such route.
+     */
+    std::vector<tripoint> find_connection_route( const overmap_connection &connection,
+            const tripoint &source, const tripoint &dest, int max_dist );
     /**
      * Returns the closest point of terrain type.
      * This function may create new overmaps if needed.
@@ -14,17 +14,43 @@
 #include "cata_utility.h"
 
 #include <algorithm>
+#include <climits>
+#include <functional>
 #include <queue>
 #include <set>
 
 #include "messages.h"
 
+pathfinding_stats &get_pathfinding_stats()
+{
+    static thread_local pathfinding_stats stats;
+    return stats;
+}
+
+// Special results of map::cost_to_pass
+enum : int {
+    // Can't be entered from any side, no point in checking it again
+    PF_IMPASSABLE = -1,
+    // Can't be entered from this side, but maybe from another one
+    PF_IMPASSABLE_FROM_HERE = -2,
+    // Trap ledge in z-levels, the tile below can be stepped on instead
+    PF_LEDGE = -3
+};
+
 enum astar_state {
     ASL_NONE,
     ASL_OPEN,
     ASL_CLOSED
 };
 
+// 7 3 5
+// 1 . 2
+// 6 4 8
+constexpr std::array<int, 8> x_offset{{ -1,  1,  0,  0,  1, -1, -1, 1 }};
+constexpr std::array<int, 8> y_offset{{  0,  0, -1,  1, -1,  1, -1, 1 }};
+// Index of the offset pointing the other way
+constexpr std::array<char, 8> opposite_offset{{ 1, 0, 3, 2, 5, 4, 7, 6 }};
+
 // Turns two indexed to a 2D array into an index to equivalent 1D array
 constexpr int flat_index( const int x, const int y )
 {
@@ -33,43 +59,142 @@ constexpr int flat_index( const int x, const int y )
 
 // Flattened 2D array representing a single z-level worth of pathfinding data
 struct path_data_layer {
+    // Generation (upper bits) and astar_state (lowest 2 bits) of every cell
+    // Cells stamped with an older generation are unvisited, so layers never need clearing
     // State is accessed way more often than all other values here
-    std::array< astar_state, SEEX *MAPSIZE *SEEY *MAPSIZE > state;
+    std::array< unsigned int, SEEX *MAPSIZE *SEEY *MAPSIZE > stamp;
     std::array< int, SEEX *MAPSIZE *SEEY *MAPSIZE > score;
     std::array< int, SEEX *MAPSIZE *SEEY *MAPSIZE > gscore;
-    std::array< tripoint, SEEX *MAPSIZE *SEEY *MAPSIZE > parent;
+    // Flat index of the parent cell times 4 plus z-level difference to the parent plus 1
+    std::array< int, SEEX *MAPSIZE *SEEY *MAPSIZE > parent;
+    unsigned int generation = 0;
+
+    astar_state state( const int index ) const {
+        const unsigned int st = stamp[index];
+        return ( st >> 2 ) == generation ? static_cast<astar_state>( st & 3 ) : ASL_NONE;
+    }
+
+    void set_state( const int index, const astar_state st ) {
+        stamp[index] = ( generation << 2 ) | st;
+    }
+
+    void set_parent( const int index, const tripoint &cur, const tripoint &par ) {
+        parent[index] = flat_index( par.x, par.y ) * 4 + ( par.z - cur.z + 1 );
+    }
 
-    void init( const int minx, const int miny, const int maxx, const int maxy ) {
-        for( int x = minx; x <= maxx; x++ ) {
-            for( int y = miny; y <= maxy; y++ ) {
-                const int ind = flat_index( x, y );
-                state[ind] = ASL_NONE; // Mark as unvisited
+    tripoint get_parent( const int index, const tripoint &cur ) const {
+        const int packed = parent[index] / 4;
+        return tripoint( packed / ( MAPSIZE * SEEY ), packed % ( MAPSIZE * SEEY ),
+                         cur.z + parent[index] % 4 - 1 );
+    }
+};
+
+/**
+ * Monotone priority queue for small non-negative integer keys.
+ * Keys below the last popped one are treated as equal to it, which only happens
+ * for the inexact estimates of z-level moves.
+ * Bucket storage is kept between searches, so it stops allocating once warmed up.
+ */
+class radix_heap
+{
+    public:
+        void clear() {
+            for( auto &bucket : buckets ) {
+                bucket.clear();
             }
+            last = 0;
+            count = 0;
         }
-    };
+
+        bool empty() const {
+            return count == 0;
+        }
+
+        void push( const int key, const tripoint &p ) {
+            const unsigned int ukey = std::max( static_cast<unsigned int>( key ), last );
+            insert( bucket_of( ukey ), ukey, p );
+            count++;
+        }
+
+        tripoint pop() {
+            if( buckets[0].empty() ) {
+                size_t i = 1;
+                while( buckets[i].empty() ) {
+                    i++;
+                }
+                auto &from = buckets[i];
+                last = std::min_element( from.begin(), from.end() )->first;
+                for( const auto &entry : from ) {
+                    insert( bucket_of( entry.first ), entry.first, entry.second );
+                }
+                from.clear();
+            }
+            const tripoint p = buckets[0].back().second;
+            buckets[0].pop_back();
+            count--;
+            return p;
+        }
+
+    private:
+        size_t bucket_of( unsigned int key ) const {
+            size_t bits = 0;
+            for( unsigned int diff = key ^ last; diff != 0; diff >>= 1 ) {
+                bits++;
+            }
+            return bits;
+        }
+
+        void insert( const size_t bucket, const unsigned int key, const tripoint &p ) {
+            auto &vec = buckets[bucket];
+            if( vec.size() == vec.capacity() ) {
+                get_pathfinding_stats().arena_allocations++;
+            }
+            vec.emplace_back( key, p );
+        }
+
+        std::array< std::vector< std::pair<unsigned int, tripoint> >, 33 > buckets;
+        unsigned int last = 0;
+        size_t count = 0;
 };
 
+// Search state reused by all the routes on a thread, see get_pathfinder()
 struct pathfinder {
     int minx;
     int miny;
     int maxx;
     int maxy;
-    pathfinder( int _minx, int _miny, int _maxx, int _maxy ) :
-        minx( _minx ), miny( _miny ), maxx( _maxx ), maxy( _maxy ) {
-    }
 
-    std::priority_queue< std::pair<int, tripoint>, std::vector< std::pair<int, tripoint> >, pair_greater_cmp >
-    open;
+    radix_heap open;
     std::array< std::unique_ptr< path_data_layer >, OVERMAP_LAYERS > path_data;
+    unsigned int generation = 0;
+
+    // Forgets the previous search in O(1)
+    void reset( const int _minx, const int _miny, const int _maxx, const int _maxy ) {
+        minx = _minx;
+        miny = _miny;
+        maxx = _maxx;
+        maxy = _maxy;
+        open.clear();
+        generation++;
+        if( generation >= ( 1u << 30 ) ) {
+            // Stamps would overflow, start over with clean layers
+            generation = 1;
+            for( auto &ptr : path_data ) {
+                if( ptr != nullptr ) {
+                    ptr->stamp.fill( 0 );
+                    ptr->generation = 0;
+                }
+            }
+        }
+    }
 
     path_data_layer &get_layer( const int z ) {
         auto &ptr = path_data[z + OVERMAP_DEPTH];
-        if( ptr != nullptr ) {
-            return *ptr;
+        if( ptr == nullptr ) {
+            ptr = std::unique_ptr<path_data_layer>( new path_data_layer() );
+            get_pathfinding_stats().arena_allocations++;
         }
-
-        ptr = std::unique_ptr<path_data_layer>( new path_data_layer() );
-        ptr->init( minx, miny, maxx, maxy );
+        ptr->generation = generation;
         return *ptr;
     }
 
@@ -78,39 +203,45 @@ struct pathfinder {
     }
 
     tripoint get_next() {
-        auto pt = open.top();
-        open.pop();
-        return pt.second;
+        return open.pop();
     }
 
     void add_point( const int gscore, const int score, const tripoint &from, const tripoint &to ) {
         auto &layer = get_layer( to.z );
         const int index = flat_index( to.x, to.y );
-        if( ( layer.state[index] == ASL_OPEN && gscore >= layer.gscore[index] ) ||
-            layer.state[index] == ASL_CLOSED ) {
+        const astar_state st = layer.state( index );
+        if( ( st == ASL_OPEN && gscore >= layer.gscore[index] ) || st == ASL_CLOSED ) {
             return;
         }
 
-        layer.state [index] = ASL_OPEN;
+        layer.set_state( index, ASL_OPEN );
         layer.gscore[index] = gscore;
-        layer.parent[index] = from;
+        layer.set_parent( index, to, from );
         layer.score [index] = score;
-        open.push( std::make_pair( score, to ) );
+        open.push( score, to );
     }
 
     void close_point( const tripoint &p ) {
         auto &layer = get_layer( p.z );
         const int index = flat_index( p.x, p.y );
-        layer.state[index] = ASL_CLOSED;
+        layer.set_state( index, ASL_CLOSED );
     }
 
     void unclose_point( const tripoint &p ) {
         auto &layer = get_layer( p.z );
         const int index = flat_index( p.x, p.y );
-        layer.state[index] = ASL_NONE;
+        layer.set_state( index, ASL_NONE );
     }
 };
 
+// The search never recurses while the pathfinder is in use, so one per thread is enough
+static pathfinder &get_pathfinder( const int minx, const int miny, const int maxx, const int maxy )
+{
+    static thread_local pathfinder pf;
+    pf.reset( minx, miny, maxx, maxy );
+    return pf;
+}
+
 // Returns a tile with `flag` in the overmap tile that `t` is on
 template<ter_bitflags flag>
 tripoint vertical_move_destination( const map &m, const tripoint &t )
@@ -141,6 +272,113 @@ tripoint vertical_move_destination( const map &m, const tripoint &t )
     return tripoint_min;
 }
 
+int map::cost_to_pass( const tripoint &cur, const tripoint &p, const pathfinding_settings &settings,
+                       const pf_special p_special ) const
+{
+    constexpr pf_special non_normal = PF_SLOW | PF_WALL | PF_VEHICLE | PF_TRAP;
+    // @todo De-uglify, de-huge-n
+    if( !( p_special & non_normal ) ) {
+        // Boring flat dirt - the most common case above the ground
+        return 2;
+    }
+
+    const int bash = settings.bash_strength;
+    const int climb_cost = settings.climb_cost;
+    const bool doors = settings.allow_open_doors;
+    const bool trapavoid = settings.avoid_traps;
+
+    int part = -1;
+    const maptile &tile = maptile_at_internal( p );
+    const auto &terrain = tile.get_ter_t();
+    const auto &furniture = tile.get_furn_t();
+    const vehicle *veh = veh_at_internal( p, part );
+
+    const int cost = move_cost_internal( furniture, terrain, veh, part );
+    // Don't calculate bash rating unless we intend to actually use it
+    const int rating = ( bash == 0 || cost != 0 ) ? -1 :
+                       bash_rating_internal( bash, furniture, terrain, false, veh, part );
+
+    if( cost == 0 && rating <= 0 && ( !doors || !terrain.open ) && veh == nullptr && climb_cost <= 0 ) {
+        return PF_IMPASSABLE;
+    }
+
+    int extra = cost;
+    if( cost == 0 ) {
+        if( climb_cost > 0 && p_special & PF_CLIMBABLE ) {
+            // Climbing fences
+            extra += climb_cost;
+        } else if( doors && terrain.open &&
+                   ( !terrain.has_flag( "OPENCLOSE_INSIDE" ) || !is_outside( cur ) ) ) {
+            // Only try to open INSIDE doors from the inside
+            // To open and then move onto the tile
+            extra += 4;
+        } else if( veh != nullptr ) {
+            part = veh->obstacle_at_part( part );
+            int dummy = -1;
+            if( doors && veh->part_flag( part, VPFLAG_OPENABLE ) &&
+                ( !veh->part_flag( part, "OPENCLOSE_INSIDE" ) ||
+                  veh_at_internal( cur, dummy ) == veh ) ) {
+                // Handle car doors, but don't try to path through curtains
+                extra += 10; // One turn to open, 4 to move there
+            } else if( part >= 0 && bash > 0 ) {
+                // Car obstacle that isn't a door
+                // @todo Account for armor
+                int hp = veh->parts[part].hp();
+                if( hp / 20 > bash ) {
+                    // Threshold damage thing means we just can't bash this down
+                    return PF_IMPASSABLE;
+                } else if( hp / 10 > bash ) {
+                    // Threshold damage thing means we will fail to deal damage pretty often
+                    hp *= 2;
+                }
+
+                extra += 2 * hp / bash + 8 + 4;
+            } else if( part >= 0 ) {
+                if( !doors || !veh->part_flag( part, VPFLAG_OPENABLE ) ) {
+                    // Won't be openable, don't try from other sides
+                    return PF_IMPASSABLE;
+                }
+
+                return PF_IMPASSABLE_FROM_HERE;
+            }
+        } else if( rating > 1 ) {
+            // Expected number of turns to bash it down, 1 turn to move there
+            // and 5 turns of penalty not to trash everything just because we can
+            extra += ( 20 / rating ) + 2 + 10;
+        } else if( rating == 1 ) {
+            // Desperate measures, avoid whenever possible
+            extra += 500;
+        } else {
+            // Unbashable and unopenable from here
+            if( !doors || !terrain.open ) {
+                // Or anywhere else for that matter
+                return PF_IMPASSABLE;
+            }
+
+            return PF_IMPASSABLE_FROM_HERE;
+        }
+    }
+
+    if( trapavoid && p_special & PF_TRAP ) {
+        const auto &ter_trp = terrain.trap.obj();
+        const auto &trp = ter_trp.is_benign() ? tile.get_trap_t() : ter_trp;
+        if( !trp.is_benign() ) {
+            // For now make them detect all traps
+            if( has_zlevels() && terrain.has_flag( TFLAG_NO_FLOOR ) ) {
+                // Warning: really expensive, needs a cache
+                if( valid_move( p, tripoint( p.x, p.y, p.z - 1 ), false, true ) ) {
+                    return PF_LEDGE;
+                }
+            } else {
+                // Otherwise it's walkable
+                extra += 500;
+            }
+        }
+    }
+
+    return extra;
+}
+
 template<class Set1, class Set2>
 bool is_disjoint( const Set1 &set1, const Set2 &set2 )
 {
@@ -172,6 +410,139 @@ bool is_disjoint( const Set1 &set1, const Set2 &set2 )
     return true;
 }
 
+// A simple straight line on flat ground, if there is one
+// Except when the line contains a pre-closed tile - we need to do regular pathing then
+static bool straight_route( const map &m, const tripoint &f, const tripoint &t,
+                            const std::set<tripoint> &pre_closed, std::vector<tripoint> &ret )
+{
+    static const auto non_normal = PF_SLOW | PF_WALL | PF_VEHICLE | PF_TRAP;
+    if( f.z != t.z ) {
+        return false;
+    }
+
+    auto line_path = line_to( f, t );
+    const auto &pf_cache = m.get_pathfinding_cache_ref( f.z );
+    // Check all points for any special case (including just hard terrain)
+    if( !std::all_of( line_path.begin(), line_path.end(), [&pf_cache]( const tripoint & p ) {
+    return !( pf_cache.special[p.x][p.y] & non_normal );
+    } ) ) {
+        return false;
+    }
+
+    const std::set<tripoint> sorted_line( line_path.begin(), line_path.end() );
+    if( !is_disjoint( sorted_line, pre_closed ) ) {
+        return false;
+    }
+
+    ret = std::move( line_path );
+    return true;
+}
+
+/**
+ * Jump point search over the open areas of @ref pathfinding_cache, where every step costs
+ * the same. Open tiles next to the target or to a pre-closed tile still need to be expanded
+ * one by one, so they end jumps just like the edges of open areas do.
+ */
+class jump_point_search
+{
+    public:
+        jump_point_search( const pathfinder &pf, const tripoint &t,
+                           const std::set<tripoint> &pre_closed ) : pf( pf ) {
+            blockers.push_back( t );
+            for( const tripoint &p : pre_closed ) {
+                if( p.x >= pf.minx && p.x < pf.maxx && p.y >= pf.miny && p.y < pf.maxy ) {
+                    blockers.push_back( p );
+                }
+            }
+        }
+
+        // Tile that can be jumped over instead of being expanded
+        bool is_jump_tile( const pathfinding_cache &pf_cache, const tripoint &p ) const {
+            if( !pf_cache.open_area[p.x][p.y] ) {
+                return false;
+            }
+            for( const tripoint &b : blockers ) {
+                if( std::abs( b.x - p.x ) <= 1 && std::abs( b.y - p.y ) <= 1 &&
+                    std::abs( b.z - p.z ) <= 1 ) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * Walks from `from` in a straight or diagonal line over jump tiles, up to the first tile
+         * that has to be expanded (the jump point). Returns tripoint_min if there is none.
+         * Diagonal walks also stop where a straight walk branching off of them would find one.
+         */
+        tripoint jump( const pathfinding_cache &pf_cache, const tripoint &from, const int dx,
+                       const int dy, int &steps ) const {
+            if( dx == 0 || dy == 0 ) {
+                const int length = straight_jump_length( pf_cache, from, dx, dy );
+                steps += length;
+                const tripoint p( from.x + dx * length, from.y + dy * length, from.z );
+                return inside( p ) ? p : tripoint_min;
+            }
+
+            tripoint p = from;
+            while( true ) {
+                p.x += dx;
+                p.y += dy;
+                steps++;
+                if( !inside( p ) ) {
+                    return tripoint_min;
+                }
+                if( !is_jump_tile( pf_cache, p ) ) {
+                    return p;
+                }
+                for( const point &branch : { point( dx, 0 ), point( 0, dy ) } ) {
+                    const int length = straight_jump_length( pf_cache, p, branch.x, branch.y );
+                    if( inside( tripoint( p.x + branch.x * length, p.y + branch.y * length, p.z ) ) ) {
+                        return p;
+                    }
+                }
+            }
+        }
+
+    private:
+        bool inside( const tripoint &p ) const {
+            return p.x >= pf.minx && p.x < pf.maxx && p.y >= pf.miny && p.y < pf.maxy;
+        }
+
+        // Steps from a jump tile to the first tile along (dx, dy) that isn't one
+        int straight_jump_length( const pathfinding_cache &pf_cache, const tripoint &from,
+                                  const int dx, const int dy ) const {
+            const int dir = dx < 0 ? 0 : dx > 0 ? 1 : dy < 0 ? 2 : 3;
+            int length = pf_cache.jump_length[dir][from.x][from.y];
+            for( const tripoint &b : blockers ) {
+                const int along = dx != 0 ? dx * ( b.x - from.x ) : dy * ( b.y - from.y );
+                const int across = dx != 0 ? b.y - from.y : b.x - from.x;
+                if( std::abs( across ) <= 1 && std::abs( b.z - from.z ) <= 1 && along > 1 ) {
+                    length = std::min( length, along - 1 );
+                }
+            }
+            return length;
+        }
+
+        const pathfinder &pf;
+        // Target and pre-closed tiles
+        std::vector<tripoint> blockers;
+};
+
+// Directions worth following from an open tile that was entered moving by (pdx, pdy)
+// Any other neighbor is reached at least as cheaply without passing through the tile
+static bool is_natural_direction( const int pdx, const int pdy, const int dx, const int dy )
+{
+    if( pdx == 0 && pdy == 0 ) {
+        // Start of the route
+        return true;
+    }
+    if( pdx != 0 && pdy != 0 ) {
+        return ( dx == 0 || dx == pdx ) && ( dy == 0 || dy == pdy );
+    }
+    return dx == pdx && dy == pdy;
+}
+
 std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
                                   const pathfinding_settings &settings,
                                   const std::set<tripoint> &pre_closed ) const
@@ -191,21 +562,8 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
         return route( f, clipped, settings, pre_closed );
     }
     // First, check for a simple straight line on flat ground
-    // Except when the line contains a pre-closed tile - we need to do regular pathing then
-    static const auto non_normal = PF_SLOW | PF_WALL | PF_VEHICLE | PF_TRAP;
-    if( f.z == t.z ) {
-        const auto line_path = line_to( f, t );
-        const auto &pf_cache = get_pathfinding_cache_ref( f.z );
-        // Check all points for any special case (including just hard terrain)
-        if( std::all_of( line_path.begin(), line_path.end(), [&pf_cache]( const tripoint & p ) {
-        return !( pf_cache.special[p.x][p.y] & non_normal );
-        } ) ) {
-            const std::set<tripoint> sorted_line( line_path.begin(), line_path.end() );
-
-            if( is_disjoint( sorted_line, pre_closed ) ) {
-                return line_path;
-            }
-        }
+    if( straight_route( *this, f, t, pre_closed, ret ) ) {
+        return ret;
     }
 
     // If expected path length is greater than max distance, allow only line path, like above
@@ -213,11 +571,15 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
         return ret;
     }
 
+    // Long routes go over the portal graph first, segments are short enough not to recurse here
+    if( settings.allow_hierarchical && f.z == t.z && rl_dist( f, t ) > SEEX * 2 ) {
+        ret = route_hierarchical( f, t, settings, pre_closed );
+        if( !ret.empty() ) {
+            return ret;
+        }
+    }
+
     int max_length = settings.max_length;
-    int bash = settings.bash_strength;
-    int climb_cost = settings.climb_cost;
-    bool doors = settings.allow_open_doors;
-    bool trapavoid = settings.avoid_traps;
 
     const int pad = 16;  // Should be much bigger - low value makes pathfinders dumb!
     int minx = std::min( f.x, t.x ) - pad;
@@ -229,7 +591,7 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
     clip_to_bounds( minx, miny, minz );
     clip_to_bounds( maxx, maxy, maxz );
 
-    pathfinder pf( minx, miny, maxx, maxy );
+    pathfinder &pf = get_pathfinder( minx, miny, maxx, maxy );
     // Make NPCs not want to path through player
     // But don't make player pathing stop working
     for( const auto &p : pre_closed ) {
@@ -242,6 +604,7 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
     pf.unclose_point( f );
     pf.unclose_point( t );
     pf.add_point( 0, 0, f, f );
+    const jump_point_search jps( pf, t, pre_closed );
 
     bool done = false;
 
@@ -250,12 +613,12 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
 
         const int parent_index = flat_index( cur.x, cur.y );
         auto &layer = pf.get_layer( cur.z );
-        auto &cur_state = layer.state[parent_index];
-        if( cur_state == ASL_CLOSED ) {
+        if( layer.state( parent_index ) == ASL_CLOSED ) {
             continue;
         }
 
-        if( layer.gscore[parent_index] > max_length ) {
+        const int cur_gscore = layer.gscore[parent_index];
+        if( cur_gscore > max_length ) {
             // Shortest path would be too long, return empty vector
             return std::vector<tripoint>();
         }
@@ -265,16 +628,39 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
             break;
         }
 
-        cur_state = ASL_CLOSED;
+        layer.set_state( parent_index, ASL_CLOSED );
+        get_pathfinding_stats().expanded_tiles++;
 
         const auto &pf_cache = get_pathfinding_cache_ref( cur.z );
         const auto cur_special = pf_cache.special[cur.x][cur.y];
 
-        // 7 3 5
-        // 1 . 2
-        // 6 4 8
-        constexpr std::array<int, 8> x_offset{{ -1,  1,  0,  0,  1, -1, -1, 1 }};
-        constexpr std::array<int, 8> y_offset{{  0,  0, -1,  1, -1,  1, -1, 1 }};
+        if( settings.allow_jump_points && jps.is_jump_tile( pf_cache, cur ) ) {
+            // Every step around costs the same, jump to where that stops being true
+            const tripoint par = layer.get_parent( parent_index, cur );
+            const int pdx = par.z == cur.z ? sgn( cur.x - par.x ) : 0;
+            const int pdy = par.z == cur.z ? sgn( cur.y - par.y ) : 0;
+            for( size_t i = 0; i < 8; i++ ) {
+                const int dx = x_offset[i];
+                const int dy = y_offset[i];
+                if( !is_natural_direction( pdx, pdy, dx, dy ) ) {
+                    continue;
+                }
+
+                int steps = 0;
+                const tripoint p = jps.jump( pf_cache, cur, dx, dy, steps );
+                if( p == tripoint_min ) {
+                    continue;
+                }
+
+                const int index = flat_index( p.x, p.y );
+                const int newg = cur_gscore + steps * ( ( dx != 0 && dy != 0 ) ? 3 : 2 );
+                if( layer.state( index ) == ASL_NONE || newg < layer.gscore[index] ) {
+                    pf.add_point( newg, newg + 2 * rl_dist( p, t ), cur, p );
+                }
+            }
+            continue;
+        }
+
         for( size_t i = 0; i < 8; i++ ) {
             const tripoint p( cur.x + x_offset[i], cur.y + y_offset[i], cur.z );
             const int index = flat_index( p.x, p.y );
@@ -284,127 +670,40 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
                 continue;
             }
 
-            if( layer.state[index] == ASL_CLOSED ) {
+            if( layer.state( index ) == ASL_CLOSED ) {
                 continue;
             }
 
             // Penalize for diagonals or the path will look "unnatural"
-            int newg = layer.gscore[parent_index] + ( ( cur.x != p.x && cur.y != p.y ) ? 1 : 0 );
+            int newg = cur_gscore + ( ( cur.x != p.x && cur.y != p.y ) ? 1 : 0 );
 
             const auto p_special = pf_cache.special[p.x][p.y];
-            // @todo De-uglify, de-huge-n
-            if( !( p_special & non_normal ) ) {
-                // Boring flat dirt - the most common case above the ground
-                newg += 2;
-            } else {
-                int part = -1;
-                const maptile &tile = maptile_at_internal( p );
-                const auto &terrain = tile.get_ter_t();
-                const auto &furniture = tile.get_furn_t();
-                const vehicle *veh = veh_at_internal( p, part );
-
-                const int cost = move_cost_internal( furniture, terrain, veh, part );
-                // Don't calculate bash rating unless we intend to actually use it
-                const int rating = ( bash == 0 || cost != 0 ) ? -1 :
-                                   bash_rating_internal( bash, furniture, terrain, false, veh, part );
-
-                if( cost == 0 && rating <= 0 && ( !doors || !terrain.open ) && veh == nullptr && climb_cost <= 0 ) {
-                    layer.state[index] = ASL_CLOSED; // Close it so that next time we won't try to calc costs
-                    continue;
-                }
-
-                newg += cost;
-                if( cost == 0 ) {
-                    if( climb_cost > 0 && p_special & PF_CLIMBABLE ) {
-                        // Climbing fences
-                        newg += climb_cost;
-                    } else if( doors && terrain.open &&
-                               ( !terrain.has_flag( "OPENCLOSE_INSIDE" ) || !is_outside( cur ) ) ) {
-                        // Only try to open INSIDE doors from the inside
-                        // To open and then move onto the tile
-                        newg += 4;
-                    } else if( veh != nullptr ) {
-                        part = veh->obstacle_at_part( part );
-                        int dummy = -1;
-                        if( doors && veh->part_flag( part, VPFLAG_OPENABLE ) &&
-                            ( !veh->part_flag( part, "OPENCLOSE_INSIDE" ) ||
-                              veh_at_internal( cur, dummy ) == veh ) ) {
-                            // Handle car doors, but don't try to path through curtains
-                            newg += 10; // One turn to open, 4 to move there
-                        } else if( part >= 0 && bash > 0 ) {
-                            // Car obstacle that isn't a door
-                            // @todo Account for armor
-                            int hp = veh->parts[part].hp();
-                            if( hp / 20 > bash ) {
-                                // Threshold damage thing means we just can't bash this down
-                                layer.state[index] = ASL_CLOSED;
-                                continue;
-                            } else if( hp / 10 > bash ) {
-                                // Threshold damage thing means we will fail to deal damage pretty often
-                                hp *= 2;
-                            }
-
-                            newg += 2 * hp / bash + 8 + 4;
-                        } else if( part >= 0 ) {
-                            if( !doors || !veh->part_flag( part, VPFLAG_OPENABLE ) ) {
-                                // Won't be openable, don't try from other sides
-                                layer.state[index] = ASL_CLOSED;
-                            }
-
-                            continue;
-                        }
-                    } else if( rating > 1 ) {
-                        // Expected number of turns to bash it down, 1 turn to move there
-                        // and 5 turns of penalty not to trash everything just because we can
-                        newg += ( 20 / rating ) + 2 + 10;
-                    } else if( rating == 1 ) {
-                        // Desperate measures, avoid whenever possible
-                        newg += 500;
-                    } else {
-                        // Unbashable and unopenable from here
-                        if( !doors || !terrain.open ) {
-                            // Or anywhere else for that matter
-                            layer.state[index] = ASL_CLOSED;
-                        }
-
-                        continue;
-                    }
+            const int cost = cost_to_pass( cur, p, settings, p_special );
+            if( cost == PF_IMPASSABLE ) {
+                layer.set_state( index, ASL_CLOSED ); // Close it so that next time we won't try to calc costs
+                continue;
+            } else if( cost == PF_IMPASSABLE_FROM_HERE ) {
+                continue;
+            } else if( cost == PF_LEDGE ) {
+                // Special case - ledge in z-levels, step down instead of walking on air
+                tripoint below( p.x, p.y, p.z - 1 );
+                if( !has_flag( TFLAG_NO_FLOOR, below ) ) {
+                    // Otherwise this would have been a huge fall
+                    // From cur, not p, because we won't be walking on air
+                    pf.add_point( cur_gscore + 10, cur_gscore + 10 + 2 * rl_dist( below, t ),
+                                  cur, below );
                 }
 
-                if( trapavoid && p_special & PF_TRAP ) {
-                    const auto &ter_trp = terrain.trap.obj();
-                    const auto &trp = ter_trp.is_benign() ? tile.get_trap_t() : ter_trp;
-                    if( !trp.is_benign() ) {
-                        // For now make them detect all traps
-                        if( has_zlevels() && terrain.has_flag( TFLAG_NO_FLOOR ) ) {
-                            // Special case - ledge in z-levels
-                            // Warning: really expensive, needs a cache
-                            if( valid_move( p, tripoint( p.x, p.y, p.z - 1 ), false, true ) ) {
-                                tripoint below( p.x, p.y, p.z - 1 );
-                                if( !has_flag( TFLAG_NO_FLOOR, below ) ) {
-                                    // Otherwise this would have been a huge fall
-                                    auto &layer = pf.get_layer( p.z - 1 );
-                                    // From cur, not p, because we won't be walking on air
-                                    pf.add_point( layer.gscore[parent_index] + 10,
-                                                  layer.score[parent_index] + 10 + 2 * rl_dist( below, t ),
-                                                  cur, below );
-                                }
-
-                                // Close p, because we won't be walking on it
-                                layer.state[index] = ASL_CLOSED;
-                                continue;
-                            }
-                        } else if( trapavoid ) {
-                            // Otherwise it's walkable
-                            newg += 500;
-                        }
-                    }
-                }
+                // Close p, because we won't be walking on it
+                layer.set_state( index, ASL_CLOSED );
+                continue;
             }
 
+            newg += cost;
+
             // If not visited, add as open
             // If visited, add it only if we can do so with better score
-            if( layer.state[index] == ASL_NONE || newg < layer.gscore[index] ) {
+            if( layer.state( index ) == ASL_NONE || newg < layer.gscore[index] ) {
                 pf.add_point( newg, newg + 2 * rl_dist( p, t ), cur, p );
             }
         }
@@ -420,30 +719,21 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
             tripoint dest( cur.x, cur.y, cur.z - 1 );
             dest = vertical_move_destination<TFLAG_GOES_UP>( *this, dest );
             if( inbounds( dest ) ) {
-                auto &layer = pf.get_layer( dest.z );
-                pf.add_point( layer.gscore[parent_index] + 2,
-                              layer.score[parent_index] + 2 * rl_dist( dest, t ),
-                              cur, dest );
+                pf.add_point( cur_gscore + 2, cur_gscore + 2 + 2 * rl_dist( dest, t ), cur, dest );
             }
         }
         if( settings.allow_climb_stairs && cur.z < maxz && parent_terrain.has_flag( TFLAG_GOES_UP ) ) {
             tripoint dest( cur.x, cur.y, cur.z + 1 );
             dest = vertical_move_destination<TFLAG_GOES_DOWN>( *this, dest );
             if( inbounds( dest ) ) {
-                auto &layer = pf.get_layer( dest.z );
-                pf.add_point( layer.gscore[parent_index] + 2,
-                              layer.score[parent_index] + 2 * rl_dist( dest, t ),
-                              cur, dest );
+                pf.add_point( cur_gscore + 2, cur_gscore + 2 + 2 * rl_dist( dest, t ), cur, dest );
             }
         }
         if( cur.z < maxz && parent_terrain.has_flag( TFLAG_RAMP ) &&
             valid_move( cur, tripoint( cur.x, cur.y, cur.z + 1 ), false, true ) ) {
-            auto &layer = pf.get_layer( cur.z + 1 );
             for( size_t it = 0; it < 8; it++ ) {
                 const tripoint above( cur.x + x_offset[it], cur.y + y_offset[it], cur.z + 1 );
-                pf.add_point( layer.gscore[parent_index] + 4,
-                              layer.score[parent_index] + 4 + 2 * rl_dist( above, t ),
-                              cur, above );
+                pf.add_point( cur_gscore + 4, cur_gscore + 4 + 2 * rl_dist( above, t ), cur, above );
             }
         }
     } while( !done && !pf.empty() );
@@ -455,15 +745,22 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
         for( int fdist = max_length; fdist != 0; fdist-- ) {
             const int cur_index = flat_index( cur.x, cur.y );
             const auto &layer = pf.get_layer( cur.z );
-            const tripoint &par = layer.parent[cur_index];
+            const tripoint par = layer.get_parent( cur_index, cur );
             if( cur == f ) {
                 break;
             }
 
             ret.push_back( cur );
-            // Jumps are acceptable on 1 z-level changes
-            // This is because stairs teleport the player too
-            if( rl_dist( cur, par ) > 1 && abs( cur.z - par.z ) != 1 ) {
+            if( cur.z == par.z && rl_dist( cur, par ) > 1 ) {
+                // Jump point, fill in the line it jumped over
+                const int dx = sgn( par.x - cur.x );
+                const int dy = sgn( par.y - cur.y );
+                for( tripoint p( cur.x + dx, cur.y + dy, cur.z ); p != par; p += point( dx, dy ) ) {
+                    ret.push_back( p );
+                }
+            } else if( rl_dist( cur, par ) > 1 && abs( cur.z - par.z ) != 1 ) {
+                // Jumps are acceptable on 1 z-level changes
+                // This is because stairs teleport the player too
                 debugmsg( "Jump in our route! %d:%d:%d->%d:%d:%d",
                           cur.x, cur.y, cur.z, par.x, par.y, par.z );
                 return ret;
@@ -477,3 +774,616 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
 
     return ret;
 }
+
+// Plain walking cost of a tile as seen by the portal graph, -1 if it can't be walked on
+static int portal_tile_cost( const map &m, const pathfinding_cache &pf_cache, const tripoint &p )
+{
+    const auto special = pf_cache.special[p.x][p.y];
+    if( special & PF_WALL ) {
+        return -1;
+    }
+    if( !( special & ( PF_SLOW | PF_VEHICLE ) ) ) {
+        return 2;
+    }
+    const int cost = m.move_cost( p );
+    return cost > 0 ? cost : -1;
+}
+
+// Walking costs from `from` to every tile of the submap with top-left corner at `origin`
+static void submap_distances( const std::array<int, SEEX *SEEY> &tile_costs, const point &origin,
+                              const point &from, std::array<int, SEEX *SEEY> &dist )
+{
+    dist.fill( -1 );
+    std::priority_queue< std::pair<int, int>, std::vector< std::pair<int, int> >,
+        std::greater< std::pair<int, int> > > open;
+    const int start = ( from.x - origin.x ) + ( from.y - origin.y ) * SEEX;
+    dist[start] = 0;
+    open.emplace( 0, start );
+    while( !open.empty() ) {
+        const auto cur = open.top();
+        open.pop();
+        if( cur.first > dist[cur.second] ) {
+            continue;
+        }
+        const int cx = cur.second % SEEX;
+        const int cy = cur.second / SEEX;
+        for( int dx = -1; dx <= 1; dx++ ) {
+            for( int dy = -1; dy <= 1; dy++ ) {
+                const int nx = cx + dx;
+                const int ny = cy + dy;
+                if( ( dx == 0 && dy == 0 ) || nx < 0 || nx >= SEEX || ny < 0 || ny >= SEEY ) {
+                    continue;
+                }
+                const int index = nx + ny * SEEX;
+                if( tile_costs[index] < 0 ) {
+                    continue;
+                }
+                // Same diagonal penalty as the tile-level A*
+                const int newg = cur.first + tile_costs[index] + ( ( dx != 0 && dy != 0 ) ? 1 : 0 );
+                if( dist[index] < 0 || newg < dist[index] ) {
+                    dist[index] = newg;
+                    open.emplace( newg, index );
+                }
+            }
+        }
+    }
+}
+
+static void submap_tile_costs( const map &m, const pathfinding_cache &pf_cache, const point &origin,
+                               const int zlev, std::array<int, SEEX *SEEY> &tile_costs )
+{
+    for( int sx = 0; sx < SEEX; sx++ ) {
+        for( int sy = 0; sy < SEEY; sy++ ) {
+            const tripoint p( origin.x + sx, origin.y + sy, zlev );
+            tile_costs[sx + sy * SEEX] = portal_tile_cost( m, pf_cache, p );
+        }
+    }
+}
+
+void map::update_portal_graph( const int zlev ) const
+{
+    const auto &pf_cache = get_pathfinding_cache_ref( zlev );
+    auto &graph = get_pathfinding_cache( zlev ).portals;
+    const int submap_count = my_MAPSIZE * my_MAPSIZE;
+
+    std::array<int, SEEX *SEEY> tile_costs;
+    std::array<int, SEEX *SEEY> dist;
+    for( int sm = 0; sm < submap_count; sm++ ) {
+        if( !graph.dirty[sm] ) {
+            continue;
+        }
+        graph.nodes_dirty = true;
+
+        const point origin( ( sm % my_MAPSIZE ) * SEEX, ( sm / my_MAPSIZE ) * SEEY );
+        auto &portals = graph.submaps[sm];
+        portals.tiles.clear();
+
+        const auto passable = [&pf_cache]( const int x, const int y ) {
+            return !( pf_cache.special[x][y] & PF_WALL );
+        };
+        const auto add_tile = [&portals]( const point &p ) {
+            if( std::find( portals.tiles.begin(), portals.tiles.end(), p ) == portals.tiles.end() ) {
+                portals.tiles.push_back( p );
+            }
+        };
+        // Every run of tiles walkable on both sides of a border gets a portal in its middle.
+        // Neighbors compute the same runs, so their portals always face each other.
+        const auto scan_border = [&]( const point &start, const point &step, const point &out ) {
+            int run_start = -1;
+            for( int i = 0; i <= SEEX; i++ ) {
+                const point in( start.x + step.x * i, start.y + step.y * i );
+                const bool open = i < SEEX && passable( in.x, in.y ) &&
+                                  passable( in.x + out.x, in.y + out.y );
+                if( open && run_start < 0 ) {
+                    run_start = i;
+                } else if( !open && run_start >= 0 ) {
+                    const int mid = ( run_start + i - 1 ) / 2;
+                    add_tile( point( start.x + step.x * mid, start.y + step.y * mid ) );
+                    run_start = -1;
+                }
+            }
+        };
+        if( origin.x > 0 ) {
+            scan_border( origin, point( 0, 1 ), point( -1, 0 ) );
+        }
+        if( origin.x + SEEX < my_MAPSIZE * SEEX ) {
+            scan_border( point( origin.x + SEEX - 1, origin.y ), point( 0, 1 ), point( 1, 0 ) );
+        }
+        if( origin.y > 0 ) {
+            scan_border( origin, point( 1, 0 ), point( 0, -1 ) );
+        }
+        if( origin.y + SEEY < my_MAPSIZE * SEEY ) {
+            scan_border( point( origin.x, origin.y + SEEY - 1 ), point( 1, 0 ), point( 0, 1 ) );
+        }
+
+        const size_t count = portals.tiles.size();
+        portals.costs.assign( count * count, -1 );
+        submap_tile_costs( *this, pf_cache, origin, zlev, tile_costs );
+        for( size_t i = 0; i < count; i++ ) {
+            submap_distances( tile_costs, origin, portals.tiles[i], dist );
+            for( size_t j = 0; j < count; j++ ) {
+                const point &to = portals.tiles[j];
+                portals.costs[i * count + j] = dist[( to.x - origin.x ) + ( to.y - origin.y ) * SEEX];
+            }
+        }
+    }
+    graph.dirty.reset();
+
+    if( !graph.nodes_dirty ) {
+        return;
+    }
+
+    graph.nodes.clear();
+    for( int sm = 0; sm < submap_count; sm++ ) {
+        graph.first_node[sm] = graph.nodes.size();
+        const auto &tiles = graph.submaps[sm].tiles;
+        for( size_t i = 0; i < tiles.size(); i++ ) {
+            graph.nodes.push_back( { tiles[i], sm, static_cast<int>( i ), {} } );
+        }
+    }
+    graph.first_node[submap_count] = graph.nodes.size();
+
+    for( auto &nd : graph.nodes ) {
+        // The first four offsets are the orthogonal ones
+        for( size_t i = 0; i < 4; i++ ) {
+            const point other( nd.pos.x + x_offset[i], nd.pos.y + y_offset[i] );
+            if( !inbounds( other.x, other.y ) ) {
+                continue;
+            }
+            const int other_sm = other.x / SEEX + ( other.y / SEEY ) * my_MAPSIZE;
+            if( other_sm == nd.submap ) {
+                continue;
+            }
+            const auto &tiles = graph.submaps[other_sm].tiles;
+            const auto iter = std::find( tiles.begin(), tiles.end(), other );
+            if( iter != tiles.end() ) {
+                nd.crossings.push_back( graph.first_node[other_sm] + ( iter - tiles.begin() ) );
+            }
+        }
+    }
+    graph.nodes_dirty = false;
+}
+
+std::vector<tripoint> map::route_hierarchical( const tripoint &f, const tripoint &t,
+        const pathfinding_settings &settings,
+        const std::set<tripoint> &pre_closed ) const
+{
+    std::vector<tripoint> ret;
+    const int f_sm = f.x / SEEX + ( f.y / SEEY ) * my_MAPSIZE;
+    const int t_sm = t.x / SEEX + ( t.y / SEEY ) * my_MAPSIZE;
+    if( f_sm == t_sm ) {
+        return ret;
+    }
+
+    update_portal_graph( f.z );
+    const auto &pf_cache = get_pathfinding_cache_ref( f.z );
+    const auto &graph = pf_cache.portals;
+
+    // Connect the endpoints to the portals of their own submaps
+    const auto endpoint_costs = [&]( const tripoint & p, const int sm, std::vector<int> &costs ) {
+        const point origin( ( sm % my_MAPSIZE ) * SEEX, ( sm / my_MAPSIZE ) * SEEY );
+        std::array<int, SEEX *SEEY> tile_costs;
+        std::array<int, SEEX *SEEY> dist;
+        submap_tile_costs( *this, pf_cache, origin, p.z, tile_costs );
+        submap_distances( tile_costs, origin, point( p.x, p.y ), dist );
+        for( const point &tile : graph.submaps[sm].tiles ) {
+            costs.push_back( dist[( tile.x - origin.x ) + ( tile.y - origin.y ) * SEEX] );
+        }
+    };
+    std::vector<int> start_costs;
+    std::vector<int> goal_costs;
+    endpoint_costs( f, f_sm, start_costs );
+    endpoint_costs( t, t_sm, goal_costs );
+
+    const int start = graph.nodes.size();
+    const int goal = start + 1;
+    std::vector<int> gscore( goal + 1, INT_MAX );
+    std::vector<int> parent( goal + 1, -1 );
+    std::vector<bool> closed( goal + 1, false );
+    std::priority_queue< std::pair<int, int>, std::vector< std::pair<int, int> >,
+        std::greater< std::pair<int, int> > > open;
+
+    const auto relax = [&]( const int from, const int to, const int cost ) {
+        const int newg = gscore[from] + cost;
+        if( closed[to] || newg >= gscore[to] ) {
+            return;
+        }
+        const tripoint pos = to == goal ? t : tripoint( graph.nodes[to].pos, f.z );
+        if( to != goal && pre_closed.count( pos ) > 0 ) {
+            return;
+        }
+        gscore[to] = newg;
+        parent[to] = from;
+        open.emplace( newg + 2 * rl_dist( pos, t ), to );
+    };
+
+    gscore[start] = 0;
+    open.emplace( 0, start );
+    while( !open.empty() ) {
+        const int cur = open.top().second;
+        open.pop();
+        if( closed[cur] ) {
+            continue;
+        }
+        if( cur == goal ) {
+            break;
+        }
+        closed[cur] = true;
+        get_pathfinding_stats().expanded_portals++;
+
+        if( cur == start ) {
+            for( size_t i = 0; i < start_costs.size(); i++ ) {
+                if( start_costs[i] >= 0 ) {
+                    relax( cur, graph.first_node[f_sm] + i, start_costs[i] );
+                }
+            }
+            continue;
+        }
+
+        const auto &nd = graph.nodes[cur];
+        const auto &portals = graph.submaps[nd.submap];
+        const size_t count = portals.tiles.size();
+        for( size_t j = 0; j < count; j++ ) {
+            const int cost = portals.costs[nd.index * count + j];
+            if( cost > 0 ) {
+                relax( cur, graph.first_node[nd.submap] + j, cost );
+            }
+        }
+        for( const int other : nd.crossings ) {
+            const int cost = portal_tile_cost( *this, pf_cache, tripoint( graph.nodes[other].pos, f.z ) );
+            if( cost > 0 ) {
+                relax( cur, other, cost );
+            }
+        }
+        if( nd.submap == t_sm && goal_costs[nd.index] >= 0 ) {
+            relax( cur, goal, goal_costs[nd.index] );
+        }
+    }
+
+    // Unreachable over walkable tiles or too long, let the full search decide
+    if( parent[goal] < 0 || gscore[goal] > settings.max_length ) {
+        return ret;
+    }
+
+    std::vector<tripoint> waypoints;
+    for( int cur = parent[goal]; cur != start; cur = parent[cur] ) {
+        waypoints.emplace_back( graph.nodes[cur].pos, f.z );
+    }
+    std::reverse( waypoints.begin(), waypoints.end() );
+    waypoints.push_back( t );
+
+    tripoint cur = f;
+    for( const tripoint &next : waypoints ) {
+        if( next == cur ) {
+            continue;
+        }
+        const auto segment = route( cur, next, settings, pre_closed );
+        if( segment.empty() ) {
+            return std::vector<tripoint>();
+        }
+        ret.insert( ret.end(), segment.begin(), segment.end() );
+        cur = next;
+    }
+
+    return ret;
+}
+
+void map::reverse_search( const tripoint &t, const pathfinding_settings &settings,
+                          const std::set<tripoint> &pre_closed, const std::vector<tripoint> &origins,
+                          const point &min, const point &max, const int max_length,
+                          std::vector<int> &dist, std::vector<char> &next ) const
+{
+    const auto &pf_cache = get_pathfinding_cache_ref( t.z );
+    dist.assign( MAPSIZE * SEEX * MAPSIZE * SEEY, -1 );
+    next.assign( MAPSIZE * SEEX * MAPSIZE * SEEY, -1 );
+
+    const std::set<tripoint> origin_set( origins.begin(), origins.end() );
+    size_t remaining = origin_set.size();
+
+    // Dijkstra backwards from the target, every edge is costed as if walked toward it
+    std::priority_queue< std::pair<int, tripoint>, std::vector< std::pair<int, tripoint> >, pair_greater_cmp >
+    open;
+    dist[flat_index( t.x, t.y )] = 0;
+    open.emplace( 0, t );
+    while( !open.empty() ) {
+        const auto top = open.top();
+        open.pop();
+        const tripoint &cur = top.second;
+        if( top.first > dist[flat_index( cur.x, cur.y )] ) {
+            continue;
+        }
+        if( top.first > max_length ) {
+            break;
+        }
+        if( remaining > 0 && origin_set.count( cur ) > 0 && --remaining == 0 ) {
+            break;
+        }
+
+        const auto cur_special = pf_cache.special[cur.x][cur.y];
+        for( size_t i = 0; i < 8; i++ ) {
+            const tripoint p( cur.x + x_offset[i], cur.y + y_offset[i], cur.z );
+            if( p.x < min.x || p.x >= max.x || p.y < min.y || p.y >= max.y ) {
+                continue;
+            }
+            // Origins may be pre-closed, paths just can't lead through them
+            if( !pre_closed.empty() && pre_closed.count( p ) > 0 && origin_set.count( p ) == 0 ) {
+                continue;
+            }
+
+            const int cost = cost_to_pass( p, cur, settings, cur_special );
+            if( cost < 0 ) {
+                // Ledges and such are left to the regular route()
+                if( cost == PF_IMPASSABLE ) {
+                    break;
+                }
+                continue;
+            }
+
+            const int newg = top.first + cost + ( ( cur.x != p.x && cur.y != p.y ) ? 1 : 0 );
+            const int index = flat_index( p.x, p.y );
+            if( dist[index] < 0 || newg < dist[index] ) {
+                dist[index] = newg;
+                // Step from p back toward cur is the opposite offset
+                next[index] = opposite_offset[i];
+                open.emplace( newg, p );
+            }
+        }
+    }
+}
+
+// Walks the steps recorded by map::reverse_search from `f` to `t`.
+// Fails on dead ends, pre-closed tiles and paths longer than `max_length` steps.
+static bool follow_search( const std::vector<char> &next, const tripoint &f, const tripoint &t,
+                           const int max_length, const std::set<tripoint> &pre_closed,
+                           std::vector<tripoint> &ret )
+{
+    ret.clear();
+    ret.reserve( rl_dist( f, t ) * 2 );
+    tripoint cur = f;
+    while( cur != t ) {
+        const int dir = next[flat_index( cur.x, cur.y )];
+        if( dir < 0 || ret.size() > static_cast<size_t>( max_length ) ) {
+            return false;
+        }
+        cur = tripoint( cur.x + x_offset[dir], cur.y + y_offset[dir], cur.z );
+        if( cur != t && pre_closed.count( cur ) > 0 ) {
+            return false;
+        }
+        ret.push_back( cur );
+    }
+
+    return true;
+}
+
+const pathfinding_flow_field *map::get_flow_field( const tripoint &t,
+        const pathfinding_settings &settings ) const
+{
+    // Only a handful of targets are chased at once, usually just the player
+    constexpr size_t max_fields = 4;
+
+    auto &cache = get_pathfinding_cache( t.z );
+    cache.flow_field_clock++;
+
+    pathfinding_flow_field *field = nullptr;
+    for( auto &cur : cache.flow_fields ) {
+        if( cur.target == t && cur.bash_strength == settings.bash_strength && cur.climb_cost == settings.climb_cost &&
+            cur.allow_open_doors == settings.allow_open_doors && cur.avoid_traps == settings.avoid_traps ) {
+            field = &cur;
+            break;
+        }
+    }
+    if( field != nullptr && field->revision == cache.revision ) {
+        field->last_used = cache.flow_field_clock;
+        return field;
+    }
+    const int turn = calendar::turn;
+    if( field != nullptr && field->built_turn == turn ) {
+        // Rebuilding the whole field for every change costs more than searching per creature
+        return nullptr;
+    }
+
+    if( field == nullptr ) {
+        if( cache.flow_fields.size() < max_fields ) {
+            cache.flow_fields.emplace_back();
+            field = &cache.flow_fields.back();
+        } else {
+            field = &*std::min_element( cache.flow_fields.begin(), cache.flow_fields.end(),
+            []( const pathfinding_flow_field & a, const pathfinding_flow_field & b ) {
+                return a.last_used < b.last_used;
+            } );
+        }
+    }
+
+    field->target = t;
+    field->bash_strength = settings.bash_strength;
+    field->climb_cost = settings.climb_cost;
+    field->allow_open_doors = settings.allow_open_doors;
+    field->avoid_traps = settings.avoid_traps;
+    field->revision = cache.revision;
+    field->built_turn = turn;
+    field->last_used = cache.flow_field_clock;
+    get_pathfinding_stats().flow_fields_built++;
+
+    reverse_search( t, settings, std::set<tripoint>(), std::vector<tripoint>(),
+                    point( 0, 0 ), point( my_MAPSIZE * SEEX, my_MAPSIZE * SEEY ), INT_MAX,
+                    field->dist, field->next );
+
+    return field;
+}
+
+std::vector<tripoint> map::route_shared( const tripoint &f, const tripoint &t,
+        const pathfinding_settings &settings,
+        const std::set<tripoint> &pre_closed ) const
+{
+    if( f == t || f.z != t.z || !inbounds( f ) || !inbounds( t ) ||
+        rl_dist( f, t ) > settings.max_dist ) {
+        return route( f, t, settings, pre_closed );
+    }
+
+    std::vector<tripoint> ret;
+    if( straight_route( *this, f, t, pre_closed, ret ) ) {
+        return ret;
+    }
+
+    const pathfinding_flow_field *field = get_flow_field( t, settings );
+    if( field == nullptr ) {
+        return route( f, t, settings, pre_closed );
+    }
+    const int start_dist = field->dist[flat_index( f.x, f.y )];
+    if( start_dist < 0 ) {
+        // Could still be reachable over stairs
+        return route( f, t, settings, pre_closed );
+    }
+    if( start_dist > settings.max_length ) {
+        return ret;
+    }
+
+    if( !follow_search( field->next, f, t, settings.max_length, pre_closed, ret ) ) {
+        return route( f, t, settings, pre_closed );
+    }
+
+    return ret;
+}
+
+std::vector<std::vector<tripoint>> map::route_many( const std::vector<tripoint> &origins,
+                                 const tripoint &t, const pathfinding_settings &settings,
+                                 const std::set<tripoint> &pre_closed ) const
+{
+    if( !inbounds( t ) ) {
+        tripoint clipped = t;
+        clip_to_bounds( clipped );
+        return route_many( origins, clipped, settings, pre_closed );
+    }
+
+    std::vector<std::vector<tripoint>> ret( origins.size() );
+    // Origins that can't be handled like in route() without searching
+    std::vector<size_t> searched;
+    std::vector<tripoint> searched_origins;
+    int minx = t.x;
+    int miny = t.y;
+    int maxx = t.x;
+    int maxy = t.y;
+    for( size_t i = 0; i < origins.size(); i++ ) {
+        const tripoint &f = origins[i];
+        if( f == t || !inbounds( f ) || straight_route( *this, f, t, pre_closed, ret[i] ) ||
+            rl_dist( f, t ) > settings.max_dist ) {
+            continue;
+        }
+        if( f.z != t.z ) {
+            ret[i] = route( f, t, settings, pre_closed );
+            continue;
+        }
+        searched.push_back( i );
+        searched_origins.push_back( f );
+        minx = std::min( minx, f.x );
+        miny = std::min( miny, f.y );
+        maxx = std::max( maxx, f.x );
+        maxy = std::max( maxy, f.y );
+    }
+    if( searched.empty() ) {
+        return ret;
+    }
+
+    // Same padding as route() uses
+    const int pad = 16;
+    minx -= pad;
+    miny -= pad;
+    maxx += pad;
+    maxy += pad;
+    clip_to_bounds( minx, miny );
+    clip_to_bounds( maxx, maxy );
+
+    std::vector<int> dist;
+    std::vector<char> next;
+    reverse_search( t, settings, pre_closed, searched_origins, point( minx, miny ),
+                    point( maxx, maxy ), settings.max_length, dist, next );
+
+    for( const size_t i : searched ) {
+        const tripoint &f = origins[i];
+        const int start_dist = dist[flat_index( f.x, f.y )];
+        if( start_dist > settings.max_length ) {
+            continue;
+        }
+        // Stairs and paths through other origins need the regular search
+        if( ( start_dist < 0 && has_zlevels() ) ||
+            ( start_dist >= 0 && !follow_search( next, f, t, settings.max_length, pre_closed, ret[i] ) ) ) {
+            ret[i] = route( f, t, settings, pre_closed );
+        }
+    }
+
+    return ret;
+}
+
+bool map::repair_route( std::vector<tripoint> &path, const tripoint &f, const tripoint &t,
+                        const pathfinding_settings &settings,
+                        const std::set<tripoint> &pre_closed ) const
+{
+    // Goals moving further than that are better served by a new plan
+    constexpr int max_goal_drift = 4;
+    // Detours are local, anything longer means the old plan is obsolete
+    constexpr int max_detour = SEEX;
+
+    if( path.empty() || path.front().z != f.z || rl_dist( f, path.front() ) > 1 ||
+        rl_dist( path.back(), t ) > max_goal_drift || !inbounds( t ) ) {
+        return false;
+    }
+    for( const tripoint &p : path ) {
+        // Stairs and ledges are rare enough to just plan again
+        if( p.z != f.z || !inbounds( p ) ) {
+            return false;
+        }
+    }
+
+    // Goal moved onto or next to the path: cut the path there
+    for( size_t i = 0; i < path.size(); i++ ) {
+        if( rl_dist( path[i], t ) <= 1 ) {
+            path.resize( i + 1 );
+            if( path.back() != t ) {
+                path.push_back( t );
+            }
+            break;
+        }
+    }
+    // Otherwise walk from the old goal to the new one
+    if( path.back() != t ) {
+        const auto extension = route( path.back(), t, settings, pre_closed );
+        if( extension.empty() ) {
+            return false;
+        }
+        path.insert( path.end(), extension.begin(), extension.end() );
+    }
+
+    const auto &pf_cache = get_pathfinding_cache_ref( f.z );
+    const auto blocked = [&]( const tripoint & from, const tripoint & p ) {
+        return ( p != t && pre_closed.count( p ) > 0 ) ||
+               cost_to_pass( from, p, settings, pf_cache.special[p.x][p.y] ) < 0;
+    };
+
+    // Walk around tiles that got blocked since the path was planned
+    tripoint prev = f;
+    for( size_t i = 0; i < path.size(); i++ ) {
+        if( !blocked( prev, path[i] ) ) {
+            prev = path[i];
+            continue;
+        }
+        size_t j = i + 1;
+        while( j < path.size() && blocked( path[j - 1], path[j] ) ) {
+            j++;
+        }
+        if( j >= path.size() ) {
+            return false;
+        }
+        const auto detour = route( prev, path[j], settings, pre_closed );
+        if( detour.empty() || detour.size() > j - i + max_detour ) {
+            return false;
+        }
+        path.erase( path.begin() + i, path.begin() + j + 1 );
+        path.insert( path.begin() + i, detour.begin(), detour.end() );
+        i += detour.size() - 1;
+        prev = path[i];
+    }
+
+    // Repeated extensions can grow a winding path, don't let it drift too far from optimal
+    return static_cast<int>( path.size() ) <= 2 * rl_dist( f, t ) + max_detour &&
+           static_cast<int>( path.size() ) <= settings.max_length;
+}
@@ -2,8 +2,14 @@
 #ifndef PATHFINDING_H
 #define PATHFINDING_H
 
+#include "enums.h"
 #include "game_constants.h"
 
+#include <array>
+#include <bitset>
+#include <climits>
+#include <vector>
+
 class JsonObject;
 
 enum pf_special : char {
@@ -39,13 +45,87 @@ inline pf_special &operator &= ( pf_special &lhs, pf_special rhs )
     return lhs;
 }
 
+/**
+ * Coarse navigation graph of a single z-level, made of entrances ("portals") between
+ * orthogonally adjacent submaps. Long routes are planned over the portals first and
+ * only then refined tile by tile, see @ref map::route.
+ */
+struct pathfinding_portal_graph {
+    struct submap_portals {
+        /** Border tiles (in map coordinates) that lead into a neighboring submap */
+        std::vector<point> tiles;
+        /** Square matrix of walking costs between the tiles above, -1 if unreachable */
+        std::vector<int> costs;
+    };
+
+    struct node {
+        point pos;
+        /** Grid index of the submap the node belongs to */
+        int submap;
+        /** Index of the node within @ref submap_portals::tiles of its submap */
+        int index;
+        /** Nodes on the other side of the submap border */
+        std::vector<int> crossings;
+    };
+
+    std::array<submap_portals, MAPSIZE * MAPSIZE> submaps;
+    /** Submaps whose portals have to be rebuilt before the graph is used */
+    std::bitset<MAPSIZE * MAPSIZE> dirty;
+    /** All portals of all submaps, rebuilt from @ref submaps when any of them changes */
+    std::vector<node> nodes;
+    /** Id of the first node of each submap, nodes of a submap are consecutive */
+    std::array<int, MAPSIZE * MAPSIZE + 1> first_node;
+    bool nodes_dirty = true;
+};
+
+/**
+ * Walking distances from every tile of a z-level to a single target. Shared by everything
+ * that paths to the same target with the same settings, see @ref map::route_shared.
+ */
+struct pathfinding_flow_field {
+    tripoint target;
+    /** Settings the field was built with */
+    int bash_strength = 0;
+    int climb_cost = 0;
+    bool allow_open_doors = false;
+    bool avoid_traps = false;
+    /** @ref pathfinding_cache::revision the field was built for */
+    int revision = -1;
+    /** Turn the field was last built on, bashing can dirty the map many times a turn */
+    int built_turn = -1;
+    int last_used = 0;
+    /** Cost of reaching the target, -1 if unreachable */
+    std::vector<int> dist;
+    /** Neighbor to step onto next (index into the offset tables), -1 if none */
+    std::vector<char> next;
+};
+
 struct pathfinding_cache {
     pathfinding_cache();
     ~pathfinding_cache();
 
     bool dirty;
+    /** Incremented whenever the cache gets dirty, invalidates @ref flow_fields */
+    int revision = 0;
 
     pf_special special[MAPSIZE * SEEX][MAPSIZE * SEEY];
+    /**
+     * Plain tiles surrounded only by plain tiles, where every step costs the same.
+     * @ref map::route jumps over these instead of expanding them one by one.
+     */
+    bool open_area[MAPSIZE * SEEX][MAPSIZE * SEEY];
+    /**
+     * Steps from a tile to the first tile that isn't in @ref open_area (or is off the map)
+     * when walking west, east, north and south respectively.
+     */
+    unsigned char jump_length[4][MAPSIZE * SEEX][MAPSIZE * SEEY];
+    static_assert( MAPSIZE * SEEX <= UCHAR_MAX && MAPSIZE * SEEY <= UCHAR_MAX,
+                   "jump_length can't hold a jump across the whole map" );
+
+    pathfinding_portal_graph portals;
+
+    std::vector<pathfinding_flow_field> flow_fields;
+    int flow_field_clock = 0;
 };
 
 struct pathfinding_settings {
@@ -63,11 +143,48 @@ struct pathfinding_settings {
 
     bool allow_climb_stairs = true;
 
+    // Plan long routes over submap portals first. Much cheaper on big maps,
+    // but the resulting path isn't guaranteed to be the shortest one.
+    // The portal graph only knows walking costs, see @ref plain_walking.
+    bool allow_hierarchical = false;
+
+    // Skip over open areas with jump point search. Doesn't change the cost of found paths.
+    bool allow_jump_points = true;
+
     pathfinding_settings() = default;
     pathfinding_settings( const pathfinding_settings & ) = default;
     pathfinding_settings( int bs, int md, int ml, int cc, bool aod, bool at, bool acs )
         : bash_strength( bs ), max_dist( md ), max_length( ml ), climb_cost( cc ),
           allow_open_doors( aod ), avoid_traps( at ), allow_climb_stairs( acs ) {}
+
+    // No bashing, doors, climbing or trap avoidance, the portal graph costs are exact then
+    bool plain_walking() const {
+        return bash_strength == 0 && !allow_open_doors && climb_cost == 0 && !avoid_traps;
+    }
+
+    bool operator==( const pathfinding_settings &rhs ) const {
+        return bash_strength == rhs.bash_strength && max_dist == rhs.max_dist &&
+               max_length == rhs.max_length && climb_cost == rhs.climb_cost &&
+               allow_open_doors == rhs.allow_open_doors && avoid_traps == rhs.avoid_traps &&
+               allow_climb_stairs == rhs.allow_climb_stairs &&
+               allow_hierarchical == rhs.allow_hierarchical &&
+               allow_jump_points == rhs.allow_jump_points;
+    }
 };
 
+/** Running totals of the search work done by @ref map::route, for profiling. */
+struct pathfinding_stats {
+    /** Tiles closed by the tile-level A* */
+    long expanded_tiles = 0;
+    /** Portals closed by the coarse search over @ref pathfinding_portal_graph */
+    long expanded_portals = 0;
+    /** Times the reusable search state of the tile-level A* had to grow */
+    long arena_allocations = 0;
+    /** Flow fields built for @ref map::route_shared */
+    long flow_fields_built = 0;
+};
+
+/** Statistics of the calling thread, reset them by assigning a default constructed object. */
+pathfinding_stats &get_pathfinding_stats();
+
 #endif
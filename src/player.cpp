@@ -1097,7 +1097,7 @@ void player::update_bodytemp()
     if( veh != nullptr ) {
         vehwindspeed = abs( veh->velocity / 100 ); // vehicle velocity in mph
     }
-    const oter_id &cur_om_ter = overmap_buffer.ter( global_omt_location() );
+    const oter_id &cur_om_ter = overmap_buffer.get_ter( global_omt_location() );
     bool sheltered = g->is_sheltered( pos() );
     int total_windpower = get_local_windpower( weather.windpower + vehwindspeed, cur_om_ter, sheltered );
 
@@ -2505,7 +2505,7 @@ void player::add_memorial_log( const std::string &male_msg, const std::string &f
                                 calendar::turn.days() + 1, calendar::turn.print_time().c_str()
                               );
 
-    const oter_id &cur_ter = overmap_buffer.ter( global_omt_location() );
+    const oter_id &cur_ter = overmap_buffer.get_ter( global_omt_location() );
     const std::string &location = cur_ter->get_name();
 
     std::stringstream log_message;
@@ -3246,7 +3246,7 @@ bool player::overmap_los( const tripoint &omt, int sight_points )
     const std::vector<tripoint> line = line_to( ompos, omt, 0, 0 );
     for( size_t i = 0; i < line.size() && sight_points >= 0; i++ ) {
         const tripoint &pt = line[i];
-        const oter_id &ter = overmap_buffer.ter( pt );
+        const oter_id &ter = overmap_buffer.get_ter( pt );
         sight_points -= int( ter->get_see_cost() );
         if( sight_points < 0 ) {
             return false;
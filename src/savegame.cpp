@@ -267,6 +267,8 @@ void scent_map::deserialize( const std::string &data )
             val = stmp;
         }
     }
+    clear_active_region();
+    grow_active_region( 0, 0, SEEX * MAPSIZE - 1, SEEY * MAPSIZE - 1 );
 }
 
 ///// weather
@@ -1403,8 +1405,7 @@ void game::serialize_master(std::ostream &fout) {
 
 void Creature_tracker::deserialize( JsonIn &jsin )
 {
-    monsters_list.clear();
-    monsters_by_location.clear();
+    clear();
     jsin.start_array();
     while( !jsin.end_array() ) {
         monster montmp;
@@ -5,10 +5,22 @@
 #include "output.h"
 #include "game.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SCENT_SSE2
+#endif
 
 static constexpr int SCENT_RADIUS = 40;
+// decrease this to reduce gas spread. Keep it under 125 for
+// stability. This is essentially a decimal number * 1000.
+static constexpr int SCENT_DIFFUSIVITY = 100;
 
 nc_color sev( const size_t level )
 {
@@ -47,13 +59,46 @@ void scent_map::reset()
             val = 0;
         }
     }
+    clear_active_region();
 }
 
 void scent_map::decay()
 {
-    for( auto &elem : grscent ) {
-        for( auto &val : elem ) {
-            val = std::max( 0, val - 1 );
+    const point decay_min = active_min;
+    const point decay_max = active_max;
+    for( int x = decay_min.x; x <= decay_max.x; ++x ) {
+        for( int y = decay_min.y; y <= decay_max.y; ++y ) {
+            grscent[x][y] = std::max( 0, grscent[x][y] - 1 );
+        }
+    }
+    clear_active_region();
+    grow_active_region( decay_min.x, decay_min.y, decay_max.x, decay_max.y );
+}
+
+void scent_map::clear_active_region()
+{
+    active_min = point( 0, 0 );
+    active_max = point( -1, -1 );
+}
+
+void scent_map::grow_active_region( const int minx, const int miny, const int maxx, const int maxy )
+{
+    bool empty = active_min.x > active_max.x;
+    for( int x = minx; x <= maxx; ++x ) {
+        for( int y = miny; y <= maxy; ++y ) {
+            if( grscent[x][y] == 0 ) {
+                continue;
+            }
+            if( empty ) {
+                active_min = point( x, y );
+                active_max = point( x, y );
+                empty = false;
+            } else {
+                active_min.x = std::min( active_min.x, x );
+                active_min.y = std::min( active_min.y, y );
+                active_max.x = std::max( active_max.x, x );
+                active_max.y = std::max( active_max.y, y );
+            }
         }
     }
 }
@@ -87,6 +132,13 @@ void scent_map::shift( const int sm_shift_x, const int sm_shift_y )
         }
     }
     grscent = new_scent;
+
+    active_min = point( std::max( 0, active_min.x - sm_shift_x ), std::max( 0, active_min.y - sm_shift_y ) );
+    active_max = point( std::min( SEEX * MAPSIZE - 1, active_max.x - sm_shift_x ),
+                        std::min( SEEY * MAPSIZE - 1, active_max.y - sm_shift_y ) );
+    if( active_min.x > active_max.x || active_min.y > active_max.y ) {
+        clear_active_region();
+    }
 }
 
 int scent_map::get( const tripoint &p ) const
@@ -101,6 +153,9 @@ void scent_map::set( const tripoint &p, int value )
 {
     if( inbounds( p ) ) {
         grscent[p.x][p.y] = value;
+        if( value != 0 ) {
+            grow_active_region( p.x, p.y, p.x, p.y );
+        }
     }
 }
 
@@ -114,7 +169,7 @@ bool scent_map::inbounds( const tripoint &p ) const
                                        gm.m.valid_move( p, tripoint( p.x, p.y, gm.get_levz() ), false, true ) ) );
 }
 
-void scent_map::update( const tripoint &center, map &m )
+void scent_map::update( const tripoint &center, map &m, const scent_kernel kernel )
 {
     // Stop updating scent after X turns of the player not moving.
     // Once wind is added, need to reset this on wind shifts as well.
@@ -125,31 +180,55 @@ void scent_map::update( const tripoint &center, map &m )
         return;
     }
 
-    // note: the next four intermediate matrices need to be at least
-    // [2*SCENT_RADIUS+3][2*SCENT_RADIUS+1] in size to hold enough data
-    // The code I'm modifying used [SEEX * MAPSIZE]. I'm staying with that to avoid new bugs.
-
-    // These two matrices are transposed so that x addresses are contiguous in memory
-    scent_array<int> sum_3_scent_y;
-    scent_array<int> squares_used_y;
-
     // these are for caching flag lookups
     scent_array<bool> blocks_scent; // currently only TFLAG_WALL blocks scent
     scent_array<bool> reduces_scent;
 
     // for loop constants
-    const int scentmap_minx = center.x - SCENT_RADIUS;
-    const int scentmap_maxx = center.x + SCENT_RADIUS;
-    const int scentmap_miny = center.y - SCENT_RADIUS;
-    const int scentmap_maxy = center.y + SCENT_RADIUS;
-
-    // decrease this to reduce gas spread. Keep it under 125 for
-    // stability. This is essentially a decimal number * 1000.
-    const int diffusivity = 100;
+    // Scent can only spread to the tiles next to the ones that already have some, everything
+    // else would stay at zero. Also keep one tile from the edges for the neighbour lookups.
+    const int scentmap_minx = std::max( { center.x - SCENT_RADIUS, active_min.x - 1, 1 } );
+    const int scentmap_maxx = std::min( { center.x + SCENT_RADIUS, active_max.x + 1, SEEX * MAPSIZE - 2 } );
+    const int scentmap_miny = std::max( { center.y - SCENT_RADIUS, active_min.y - 1, 1 } );
+    const int scentmap_maxy = std::min( { center.y + SCENT_RADIUS, active_max.y + 1, SEEY * MAPSIZE - 2 } );
+    if( scentmap_minx > scentmap_maxx || scentmap_miny > scentmap_maxy ) {
+        return;
+    }
 
     // The new scent flag searching function. Should be wayyy faster than the old one.
     m.scent_blockers( blocks_scent, reduces_scent, scentmap_minx - 1, scentmap_miny - 1,
                       scentmap_maxx + 1, scentmap_maxy + 1 );
+
+    if( kernel == scent_kernel::scalar ) {
+        diffuse_scalar( blocks_scent, reduces_scent, scentmap_minx, scentmap_miny, scentmap_maxx,
+                        scentmap_maxy );
+    } else {
+        diffuse_vectorized( blocks_scent, reduces_scent, scentmap_minx, scentmap_miny, scentmap_maxx,
+                            scentmap_maxy );
+    }
+
+    // Scent outside of the diffused rectangle did not change, if there is none the active
+    // rectangle can shrink to what is left inside.
+    if( active_min.x >= scentmap_minx && active_max.x <= scentmap_maxx &&
+        active_min.y >= scentmap_miny && active_max.y <= scentmap_maxy ) {
+        clear_active_region();
+    }
+    grow_active_region( scentmap_minx, scentmap_miny, scentmap_maxx, scentmap_maxy );
+}
+
+void scent_map::diffuse_scalar( const scent_array<bool> &blocks_scent,
+                                const scent_array<bool> &reduces_scent,
+                                const int scentmap_minx, const int scentmap_miny,
+                                const int scentmap_maxx, const int scentmap_maxy )
+{
+    // note: the next four intermediate matrices need to be at least
+    // [2*SCENT_RADIUS+3][2*SCENT_RADIUS+1] in size to hold enough data
+    // The code I'm modifying used [SEEX * MAPSIZE]. I'm staying with that to avoid new bugs.
+
+    // These two matrices are transposed so that x addresses are contiguous in memory
+    scent_array<int> sum_3_scent_y;
+    scent_array<int> squares_used_y;
+
     // Sum neighbors in the y direction.  This way, each square gets called 3 times instead of 9
     // times. This cost us an extra loop here, but it also eliminated a loop at the end, so there
     // is a net performance improvement over the old code. Could probably still be better.
@@ -189,9 +268,9 @@ void scent_map::update( const tripoint &center, map &m )
 
                 int this_diffusivity;
                 if( !reduces_scent[x][y] ) {
-                    this_diffusivity = diffusivity;
+                    this_diffusivity = SCENT_DIFFUSIVITY;
                 } else {
-                    this_diffusivity = diffusivity / 5; //less air movement for REDUCE_SCENT square
+                    this_diffusivity = SCENT_DIFFUSIVITY / 5; //less air movement for REDUCE_SCENT square
                 }
                 int temp_scent;
                 // take the old scent and subtract what diffuses out
@@ -214,3 +293,241 @@ void scent_map::update( const tripoint &center, map &m )
         }
     }
 }
+
+// Lanes of ints processed together by diffuse_vectorized. Each set of helpers below matches the
+// int arithmetic of diffuse_scalar exactly, including the truncation of the divisions.
+#if defined(__AVX2__)
+using scent_lanes = __m256i;
+static constexpr int scent_lane_count = 8;
+
+static inline scent_lanes lanes_load( const int *p )
+{
+    return _mm256_loadu_si256( reinterpret_cast<const __m256i *>( p ) );
+}
+static inline void lanes_store( int *p, const scent_lanes v )
+{
+    _mm256_storeu_si256( reinterpret_cast<__m256i *>( p ), v );
+}
+static inline scent_lanes lanes_set( const int v )
+{
+    return _mm256_set1_epi32( v );
+}
+static inline scent_lanes lanes_add( const scent_lanes a, const scent_lanes b )
+{
+    return _mm256_add_epi32( a, b );
+}
+static inline scent_lanes lanes_sub( const scent_lanes a, const scent_lanes b )
+{
+    return _mm256_sub_epi32( a, b );
+}
+static inline scent_lanes lanes_mul( const scent_lanes a, const scent_lanes b )
+{
+    return _mm256_mullo_epi32( a, b );
+}
+// The quotient in double precision, moved half a step of 1 / divisor away from zero so that
+// the rounding of the multiplication can not cross an integer, truncates to the int division.
+static inline __m128i lanes_div_half( const __m128i v, const __m256d scale, const __m256d nudge )
+{
+    const __m256d q = _mm256_mul_pd( _mm256_cvtepi32_pd( v ), scale );
+    const __m256d sign = _mm256_castsi256_pd( _mm256_set1_epi64x( INT64_MIN ) );
+    return _mm256_cvttpd_epi32( _mm256_add_pd( q, _mm256_or_pd( _mm256_and_pd( q, sign ), nudge ) ) );
+}
+static inline scent_lanes lanes_div( const scent_lanes v, const int divisor )
+{
+    const __m256d scale = _mm256_set1_pd( 1.0 / divisor );
+    const __m256d nudge = _mm256_set1_pd( 0.5 / divisor );
+    const __m128i lo = lanes_div_half( _mm256_castsi256_si128( v ), scale, nudge );
+    const __m128i hi = lanes_div_half( _mm256_extracti128_si256( v, 1 ), scale, nudge );
+    return _mm256_inserti128_si256( _mm256_castsi128_si256( lo ), hi, 1 );
+}
+// Zero in the lanes where `mask` is zero, `v` elsewhere.
+static inline scent_lanes lanes_zero_where_zero( const scent_lanes mask, const scent_lanes v )
+{
+    return _mm256_andnot_si256( _mm256_cmpeq_epi32( mask, _mm256_setzero_si256() ), v );
+}
+#elif defined(SCENT_SSE2)
+using scent_lanes = __m128i;
+static constexpr int scent_lane_count = 4;
+
+static inline scent_lanes lanes_load( const int *p )
+{
+    return _mm_loadu_si128( reinterpret_cast<const __m128i *>( p ) );
+}
+static inline void lanes_store( int *p, const scent_lanes v )
+{
+    _mm_storeu_si128( reinterpret_cast<__m128i *>( p ), v );
+}
+static inline scent_lanes lanes_set( const int v )
+{
+    return _mm_set1_epi32( v );
+}
+static inline scent_lanes lanes_add( const scent_lanes a, const scent_lanes b )
+{
+    return _mm_add_epi32( a, b );
+}
+static inline scent_lanes lanes_sub( const scent_lanes a, const scent_lanes b )
+{
+    return _mm_sub_epi32( a, b );
+}
+// SSE2 has no 32 bit multiply keeping the low halves, build it from two 32x32->64 multiplies.
+static inline scent_lanes lanes_mul( const scent_lanes a, const scent_lanes b )
+{
+    const __m128i even = _mm_mul_epu32( a, b );
+    const __m128i odd = _mm_mul_epu32( _mm_srli_si128( a, 4 ), _mm_srli_si128( b, 4 ) );
+    return _mm_unpacklo_epi32( _mm_shuffle_epi32( even, _MM_SHUFFLE( 0, 0, 2, 0 ) ),
+                               _mm_shuffle_epi32( odd, _MM_SHUFFLE( 0, 0, 2, 0 ) ) );
+}
+// The quotient in double precision, moved half a step of 1 / divisor away from zero so that
+// the rounding of the multiplication can not cross an integer, truncates to the int division.
+static inline __m128i lanes_div_half( const __m128i v, const __m128d scale, const __m128d nudge )
+{
+    const __m128d q = _mm_mul_pd( _mm_cvtepi32_pd( v ), scale );
+    const __m128d sign = _mm_castsi128_pd( _mm_set1_epi64x( INT64_MIN ) );
+    return _mm_cvttpd_epi32( _mm_add_pd( q, _mm_or_pd( _mm_and_pd( q, sign ), nudge ) ) );
+}
+static inline scent_lanes lanes_div( const scent_lanes v, const int divisor )
+{
+    const __m128d scale = _mm_set1_pd( 1.0 / divisor );
+    const __m128d nudge = _mm_set1_pd( 0.5 / divisor );
+    const __m128i lo = lanes_div_half( v, scale, nudge );
+    const __m128i hi = lanes_div_half( _mm_unpackhi_epi64( v, v ), scale, nudge );
+    return _mm_unpacklo_epi64( lo, hi );
+}
+// Zero in the lanes where `mask` is zero, `v` elsewhere.
+static inline scent_lanes lanes_zero_where_zero( const scent_lanes mask, const scent_lanes v )
+{
+    return _mm_andnot_si128( _mm_cmpeq_epi32( mask, _mm_setzero_si128() ), v );
+}
+#else
+using scent_lanes = int;
+static constexpr int scent_lane_count = 1;
+
+static inline scent_lanes lanes_load( const int *p )
+{
+    return *p;
+}
+static inline void lanes_store( int *p, const scent_lanes v )
+{
+    *p = v;
+}
+static inline scent_lanes lanes_set( const int v )
+{
+    return v;
+}
+static inline scent_lanes lanes_add( const scent_lanes a, const scent_lanes b )
+{
+    return a + b;
+}
+static inline scent_lanes lanes_sub( const scent_lanes a, const scent_lanes b )
+{
+    return a - b;
+}
+static inline scent_lanes lanes_mul( const scent_lanes a, const scent_lanes b )
+{
+    return a * b;
+}
+static inline scent_lanes lanes_div( const scent_lanes v, const int divisor )
+{
+    return v / divisor;
+}
+static inline scent_lanes lanes_zero_where_zero( const scent_lanes mask, const scent_lanes v )
+{
+    return mask == 0 ? 0 : v;
+}
+#endif
+
+// Same as the body of the second loop in diffuse_scalar, `diffusivity` is 0 for tiles blocking scent.
+static scent_lanes diffuse_lanes( const scent_lanes scent_here, const scent_lanes squares_used,
+                                  const scent_lanes diffusivity, const scent_lanes sum_3_scent )
+{
+    scent_lanes temp_scent = lanes_mul( scent_here, lanes_sub( lanes_set( 10 * 1000 ),
+                                        lanes_mul( squares_used, diffusivity ) ) );
+    temp_scent = lanes_sub( temp_scent, lanes_div( lanes_mul( lanes_mul( scent_here, diffusivity ),
+                            lanes_sub( lanes_set( 90 ), squares_used ) ), 5 ) );
+    const scent_lanes result = lanes_div( lanes_add( temp_scent, lanes_mul( diffusivity, sum_3_scent ) ),
+                                          1000 * 10 );
+    return lanes_zero_where_zero( diffusivity, result );
+}
+
+static int diffuse_tile( const int scent_here, const int squares_used, const int diffusivity,
+                         const int sum_3_scent )
+{
+    if( diffusivity == 0 ) {
+        return 0;
+    }
+    int temp_scent = scent_here * ( 10 * 1000 - squares_used * diffusivity );
+    temp_scent -= scent_here * diffusivity * ( 90 - squares_used ) / 5;
+    return ( temp_scent + diffusivity * sum_3_scent ) / ( 1000 * 10 );
+}
+
+void scent_map::diffuse_vectorized( const scent_array<bool> &blocks_scent,
+                                    const scent_array<bool> &reduces_scent,
+                                    const int scentmap_minx, const int scentmap_miny,
+                                    const int scentmap_maxx, const int scentmap_maxy )
+{
+    // The flags turned into the numbers diffuse_scalar branches on: how much of a tile takes part
+    // in the neighbour sums (0, 2 or 10) and how fast it diffuses (0 for tiles blocking scent).
+    scent_array<int> weight;
+    scent_array<int> diffusivity;
+    for( int x = scentmap_minx - 1; x <= scentmap_maxx + 1; ++x ) {
+        for( int y = scentmap_miny - 1; y <= scentmap_maxy + 1; ++y ) {
+            if( blocks_scent[x][y] ) {
+                weight[x][y] = 0;
+                diffusivity[x][y] = 0;
+            } else if( reduces_scent[x][y] ) {
+                weight[x][y] = 2;
+                diffusivity[x][y] = SCENT_DIFFUSIVITY / 5;
+            } else {
+                weight[x][y] = 10;
+                diffusivity[x][y] = SCENT_DIFFUSIVITY;
+            }
+        }
+    }
+
+    // Unlike in diffuse_scalar these are not transposed, y is contiguous in both passes
+    scent_array<int> sum_3_scent_y;
+    scent_array<int> squares_used_y;
+    for( int x = scentmap_minx - 1; x <= scentmap_maxx + 1; ++x ) {
+        const int *w = weight[x].data();
+        const int *s = grscent[x].data();
+        int y = scentmap_miny;
+        for( ; y + scent_lane_count - 1 <= scentmap_maxy; y += scent_lane_count ) {
+            const scent_lanes w_above = lanes_load( w + y - 1 );
+            const scent_lanes w_here = lanes_load( w + y );
+            const scent_lanes w_below = lanes_load( w + y + 1 );
+            lanes_store( &squares_used_y[x][y], lanes_add( lanes_add( w_above, w_here ), w_below ) );
+            lanes_store( &sum_3_scent_y[x][y],
+                         lanes_add( lanes_add( lanes_mul( w_above, lanes_load( s + y - 1 ) ),
+                                               lanes_mul( w_here, lanes_load( s + y ) ) ),
+                                    lanes_mul( w_below, lanes_load( s + y + 1 ) ) ) );
+        }
+        for( ; y <= scentmap_maxy; ++y ) {
+            squares_used_y[x][y] = w[y - 1] + w[y] + w[y + 1];
+            sum_3_scent_y[x][y] = w[y - 1] * s[y - 1] + w[y] * s[y] + w[y + 1] * s[y + 1];
+        }
+    }
+
+    for( int x = scentmap_minx; x <= scentmap_maxx; ++x ) {
+        const int *used_left = squares_used_y[x - 1].data();
+        const int *used_here = squares_used_y[x].data();
+        const int *used_right = squares_used_y[x + 1].data();
+        const int *sum_left = sum_3_scent_y[x - 1].data();
+        const int *sum_here = sum_3_scent_y[x].data();
+        const int *sum_right = sum_3_scent_y[x + 1].data();
+        const int *d = diffusivity[x].data();
+        int *s = grscent[x].data();
+        int y = scentmap_miny;
+        for( ; y + scent_lane_count - 1 <= scentmap_maxy; y += scent_lane_count ) {
+            const scent_lanes squares_used = lanes_add( lanes_add( lanes_load( used_left + y ),
+                                             lanes_load( used_here + y ) ), lanes_load( used_right + y ) );
+            const scent_lanes sum_3_scent = lanes_add( lanes_add( lanes_load( sum_left + y ),
+                                            lanes_load( sum_here + y ) ), lanes_load( sum_right + y ) );
+            lanes_store( s + y, diffuse_lanes( lanes_load( s + y ), squares_used, lanes_load( d + y ),
+                                               sum_3_scent ) );
+        }
+        for( ; y <= scentmap_maxy; ++y ) {
+            s[y] = diffuse_tile( s[y], used_left[y] + used_here[y] + used_right[y], d[y],
+                                 sum_left[y] + sum_here[y] + sum_right[y] );
+        }
+    }
+}
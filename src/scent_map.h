@@ -11,6 +11,14 @@
 class map;
 class game;
 
+/** Implementation of the diffusion step in @ref scent_map::update. */
+enum class scent_kernel : int {
+    /** One tile at a time, branching on the scent blocking flags. */
+    scalar,
+    /** Several tiles at a time with precomputed weights, using SSE2/AVX2 where available. */
+    vectorized
+};
+
 class scent_map
 {
     protected:
@@ -20,9 +28,32 @@ class scent_map
         scent_array<int> grscent;
         tripoint player_last_position = tripoint_min;
         int player_last_moved = -1;
+        /**
+         * Corners of a rectangle holding all tiles with non-zero scent, empty (the minimum
+         * beyond the maximum) if there are none. Diffusion and decay skip everything else.
+         */
+        point active_min = point( 0, 0 );
+        point active_max = point( -1, -1 );
 
         const game &gm;
 
+        /**
+         * Diffuse scent inside the square [minx, maxx] x [miny, maxy].
+         * The flag arrays must be filled one tile beyond that square.
+         * Both kernels produce the same result.
+         */
+        /**@{*/
+        void diffuse_scalar( const scent_array<bool> &blocks_scent, const scent_array<bool> &reduces_scent,
+                             int minx, int miny, int maxx, int maxy );
+        void diffuse_vectorized( const scent_array<bool> &blocks_scent,
+                                 const scent_array<bool> &reduces_scent,
+                                 int minx, int miny, int maxx, int maxy );
+        /**@}*/
+
+        /** Extends the active rectangle to the non-zero tiles inside the given one. */
+        void grow_active_region( int minx, int miny, int maxx, int maxy );
+        void clear_active_region();
+
     public:
         scent_map( const game &g ) : gm( g ) { };
 
@@ -31,7 +62,8 @@ class scent_map
 
         void draw( WINDOW *w, int div, const tripoint &center ) const;
 
-        void update( const tripoint &center, map &m );
+        void update( const tripoint &center, map &m,
+                     scent_kernel kernel = scent_kernel::vectorized );
         void reset();
         void decay();
         void shift( int sm_shift_x, int sm_shift_y );
@@ -47,6 +79,14 @@ class scent_map
         /**@}*/
 
         bool inbounds( const tripoint &p ) const;
+
+        /**
+         * Corners of the rectangle outside of which all scent is zero. The first lies beyond
+         * the second if there is no scent at all.
+         */
+        std::pair<point, point> active_region() const {
+            return std::make_pair( active_min, active_max );
+        }
 };
 
 #endif
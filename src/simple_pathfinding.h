@@ -5,8 +5,9 @@
 #include "debug.h"
 #include "enums.h"
 
+#include <algorithm>
+#include <deque>
 #include <limits>
-#include <queue>
 #include <vector>
 
 namespace pf
@@ -40,6 +41,50 @@ struct path {
     std::vector<node> nodes;
 };
 
+/**
+ * Priority queue for the small non-negative integer priorities of the overmap searches.
+ * Values aren't removed when they get a better priority, searches skip the outdated
+ * entries instead.
+ */
+template<typename T>
+class bucket_queue
+{
+    public:
+        bool empty() const {
+            return count == 0;
+        }
+
+        size_t size() const {
+            return count;
+        }
+
+        void push( const T &value, const int priority ) {
+            const size_t bucket = priority;
+            if( bucket >= buckets.size() ) {
+                buckets.resize( bucket + 1 );
+            }
+            buckets[bucket].push_back( value );
+            lowest = std::min( lowest, bucket );
+            count++;
+        }
+
+        // Removes one of the values with the lowest priority, the first pushed one
+        T pop() {
+            while( buckets[lowest].empty() ) {
+                lowest++;
+            }
+            const T value = buckets[lowest].front();
+            buckets[lowest].pop_front();
+            count--;
+            return value;
+        }
+
+    private:
+        std::vector<std::deque<T>> buckets;
+        size_t lowest = 0;
+        size_t count = 0;
+};
+
 /**
  * @param source Starting point of path
  * @param dest End point of path
@@ -93,17 +138,19 @@ path find_path( const point &source,
     std::vector<bool> closed( map_size, false );
     std::vector<int> open( map_size, 0 );
     std::vector<short> dirs( map_size, 0 );
-    std::priority_queue<node, std::deque<node>> nodes[2];
+    bucket_queue<node> nodes;
 
-    int i = 0;
-    nodes[i].push( first_node );
+    nodes.push( first_node, first_node.priority );
     open[map_index( x1, y1 )] = std::numeric_limits<int>::max();
 
     // use A* to find the shortest path from (x1,y1) to (x2,y2)
-    while( !nodes[i].empty() ) {
-        const node mn( nodes[i].top() ); // get the best-looking node
+    while( !nodes.empty() ) {
+        const node mn( nodes.pop() ); // get the best-looking node
 
-        nodes[i].pop();
+        // skip outdated entries of nodes that were reached in a better way since
+        if( closed[map_index( mn.x, mn.y )] ) {
+            continue;
+        }
         // mark it visited
         closed[map_index( mn.x, mn.y )] = true;
 
@@ -112,7 +159,7 @@ path find_path( const point &source,
             int x = mn.x;
             int y = mn.y;
 
-            res.nodes.reserve( nodes[i].size() );
+            res.nodes.reserve( nodes.size() );
 
             while( x != x1 || y != y1 ) {
                 const int n = map_index( x, y );
@@ -141,31 +188,14 @@ path find_path( const point &source,
             node cn( x, y, d );
             cn.priority = estimator( cn, &mn );
 
-            if( cn.priority == rejected ) {
-                continue;
+            if( cn.priority < 0 ) {
+                continue; // rejected
             }
             // record direction to shortest path
             if( open[n] == 0 || open[n] > cn.priority ) {
                 dirs[n] = ( d + 2 ) % 4;
-
-                if( open[n] != 0 ) {
-                    while( nodes[i].top().x != x || nodes[i].top().y != y ) {
-                        nodes[1 - i].push( nodes[i].top() );
-                        nodes[i].pop();
-                    }
-                    nodes[i].pop();
-
-                    if( nodes[i].size() > nodes[1 - i].size() ) {
-                        i = 1 - i;
-                    }
-                    while( !nodes[i].empty() ) {
-                        nodes[1 - i].push( nodes[i].top() );
-                        nodes[i].pop();
-                    }
-                    i = 1 - i;
-                }
                 open[n] = cn.priority;
-                nodes[i].push( cn );
+                nodes.push( cn, cn.priority );
             }
         }
     }
@@ -79,6 +79,29 @@ static std::vector<std::pair<tripoint, sound_event>> sounds_since_last_turn;
 // The sound events currently displayed to the player.
 static std::unordered_map<tripoint, sound_event> sound_markers;
 
+/**
+ * The sound clusters applied to monster AI in the last turn and, for each submap of the
+ * reality bubble, which of them can be heard there. Rebuilt by process_sounds, so finding
+ * the sounds heard at a place doesn't need to scan all of them.
+ */
+struct loudness_field {
+    std::vector<sounds::heard_sound> sources;
+    // Indexes into sources, by submap and z-level
+    std::vector<std::vector<size_t>> audible;
+
+    static size_t index( const tripoint &sm ) {
+        return ( sm.z + OVERMAP_DEPTH ) * MAPSIZE * MAPSIZE + sm.x + sm.y * MAPSIZE;
+    }
+
+    void clear() {
+        sources.clear();
+        for( auto &in_submap : audible ) {
+            in_submap.clear();
+        }
+    }
+};
+static loudness_field sound_field;
+
 void sounds::ambient_sound( const tripoint &p, int vol, std::string description )
 {
     sound( p, vol, description, true );
@@ -102,55 +125,30 @@ void sounds::add_footstep( const tripoint &p, int volume, int, monster * )
         std::make_pair( p, sound_event {volume, "", false, true, "", ""} ) );
 }
 
-template <typename C>
-static void vector_quick_remove( std::vector<C> &source, int index )
-{
-    if( source.size() != 1 ) {
-        // Swap the target and the last element of the vector.
-        // This scrambles the vector, but makes removal O(1).
-        std::iter_swap( source.begin() + index, source.end() - 1 );
-    }
-    source.pop_back();
-}
-
-static std::vector<centroid> cluster_sounds( std::vector<std::pair<tripoint, int>> recent_sounds )
+static std::vector<centroid> cluster_sounds( const std::vector<std::pair<tripoint, int>> &recent_sounds )
 {
     // If there are too many monsters and too many noise sources (which can be monsters, go figure),
     // applying sound events to monsters can dominate processing time for the whole game,
     // so we cluster sounds and apply the centroids of the sounds to the monster AI
     // to fight the combanatorial explosion.
+    // Sounds are bucketed by submap, the sounds of each submap become one cluster.
+    // This needs only one pass over the sounds, however many there are.
     std::vector<centroid> sound_clusters;
-    const int num_seed_clusters = std::max( std::min( recent_sounds.size(), ( size_t ) 10 ),
-                                            ( size_t ) log( recent_sounds.size() ) );
-    const size_t stopping_point = recent_sounds.size() - num_seed_clusters;
-    const size_t max_map_distance = rl_dist( 0, 0, MAPSIZE * SEEX, MAPSIZE * SEEY );
-    // Randomly choose cluster seeds.
-    for( size_t i = recent_sounds.size(); i > stopping_point; i-- ) {
-        size_t index = rng( 0, i - 1 );
-        // The volume and cluster weight are the same for the first element.
-        sound_clusters.push_back(
-            // Assure the compiler that these int->float conversions are safe.
-        {
-            ( float ) recent_sounds[index].first.x, ( float ) recent_sounds[index].first.y,
-            ( float ) recent_sounds[index].first.z,
-            ( float ) recent_sounds[index].second, ( float ) recent_sounds[index].second
-        } );
-        vector_quick_remove( recent_sounds, index );
-    }
+    std::unordered_map<tripoint, size_t> cluster_of_submap;
     for( const auto &sound_event_pair : recent_sounds ) {
-        auto found_centroid = sound_clusters.begin();
-        float dist_factor = max_map_distance;
-        const auto cluster_end = sound_clusters.end();
-        for( auto centroid_iter = sound_clusters.begin(); centroid_iter != cluster_end;
-                ++centroid_iter ) {
-            // Scale the distance between the two by the max possible distance.
-            tripoint centroid_pos { ( int ) centroid_iter->x, ( int ) centroid_iter->y, ( int ) centroid_iter->z };
-            const int dist = rl_dist( sound_event_pair.first, centroid_pos );
-            if( dist * dist < dist_factor ) {
-                found_centroid = centroid_iter;
-                dist_factor = dist * dist;
-            }
+        const tripoint &p = sound_event_pair.first;
+        const auto inserted = cluster_of_submap.emplace( ms_to_sm_copy( p ), sound_clusters.size() );
+        if( inserted.second ) {
+            // The volume and cluster weight are the same for the first element.
+            sound_clusters.push_back(
+                // Assure the compiler that these int->float conversions are safe.
+            {
+                ( float ) p.x, ( float ) p.y, ( float ) p.z,
+                ( float ) sound_event_pair.second, ( float ) sound_event_pair.second
+            } );
+            continue;
         }
+        const auto found_centroid = sound_clusters.begin() + inserted.first->second;
         const float volume_sum = ( float ) sound_event_pair.second + found_centroid->weight;
         // Set the centroid location to the average of the two locations, weighted by volume.
         found_centroid->x = ( float )( ( sound_event_pair.first.x * sound_event_pair.second ) +
@@ -191,15 +189,59 @@ int get_signal_for_hordes( const centroid &centr )
     return 0;
 }
 
+/** Makes the sound of a cluster, already reduced by the weather to vol, heard where it reaches. */
+static void add_to_loudness_field( const tripoint &source, const int vol )
+{
+    if( vol <= 0 ) {
+        return;
+    }
+    // Monsters hear sounds up to twice the volume away. rl_dist is never shorter than
+    // the distance along any single axis, so only the submaps overlapping this cube can be reached.
+    const int reach = vol * 2 - 1;
+    const tripoint sm_min = ms_to_sm_copy( source - tripoint( reach, reach, 0 ) );
+    const tripoint sm_max = ms_to_sm_copy( source + tripoint( reach, reach, 0 ) );
+    const int zmin = std::max( source.z - reach, -OVERMAP_DEPTH );
+    const int zmax = std::min( source.z + reach, OVERMAP_HEIGHT );
+    tripoint sm;
+    for( sm.z = zmin; sm.z <= zmax; sm.z++ ) {
+        for( sm.x = std::max( sm_min.x, 0 ); sm.x <= std::min( sm_max.x, MAPSIZE - 1 ); sm.x++ ) {
+            for( sm.y = std::max( sm_min.y, 0 ); sm.y <= std::min( sm_max.y, MAPSIZE - 1 ); sm.y++ ) {
+                sound_field.audible[loudness_field::index( sm )].push_back( sound_field.sources.size() );
+            }
+        }
+    }
+    sound_field.sources.push_back( { source, vol, 0 } );
+}
+
+sounds::heard_sound sounds::loudest_sound_at( const tripoint &p )
+{
+    heard_sound loudest{ p, 0, 0 };
+    const tripoint sm = ms_to_sm_copy( p );
+    if( sm.x < 0 || sm.x >= MAPSIZE || sm.y < 0 || sm.y >= MAPSIZE ||
+        sm.z < -OVERMAP_DEPTH || sm.z > OVERMAP_HEIGHT || sound_field.audible.empty() ) {
+        return loudest;
+    }
+    for( const size_t i : sound_field.audible[loudness_field::index( sm )] ) {
+        const heard_sound &candidate = sound_field.sources[i];
+        const int dist = rl_dist( candidate.source, p );
+        if( candidate.volume * 2 <= dist ) {
+            continue;
+        }
+        if( loudest.volume == 0 || candidate.volume - dist > loudest.volume - loudest.distance ) {
+            loudest = { candidate.source, candidate.volume, dist };
+        }
+    }
+    return loudest;
+}
+
 void sounds::process_sounds()
 {
     std::vector<centroid> sound_clusters = cluster_sounds( recent_sounds );
     const int weather_vol = weather_data( g->weather ).sound_attn;
+    sound_field.clear();
+    sound_field.audible.resize( MAPSIZE * MAPSIZE * OVERMAP_LAYERS );
+    // One pass over the clusters alerts the hordes and fills the loudness field
     for( const auto &this_centroid : sound_clusters ) {
-        // Since monsters don't go deaf ATM we can just use the weather modified volume
-        // If they later get physical effects from loud noises we'll have to change this
-        // to use the unmodified volume for those effects.
-        const int vol = this_centroid.volume - weather_vol;
         const tripoint source = tripoint( this_centroid.x, this_centroid.y, this_centroid.z );
         // --- Monster sound handling here ---
         // Alert all hordes
@@ -211,14 +253,17 @@ void sounds::process_sounds()
             const tripoint target( abs_sm.x, abs_sm.y, source.z );
             overmap_buffer.signal_hordes( target, sig_power );
         }
-        // Alert all monsters (that can hear) to the sound.
-        for( monster &critter : g->all_monsters() ) {
-            // @todo Generalize this to Creature::hear_sound
-            const int dist = rl_dist( source, critter.pos() );
-            if( vol * 2 > dist ) {
-                // Exclude monsters that certainly won't hear the sound
-                critter.hear_sound( source, vol, dist );
-            }
+        add_to_loudness_field( source, this_centroid.volume - weather_vol );
+    }
+    // Alert all monsters (that can hear) to the loudest sound they can hear.
+    // Since monsters don't go deaf ATM we can just use the weather modified volume
+    // If they later get physical effects from loud noises we'll have to change this
+    // to use the unmodified volume for those effects.
+    for( monster &critter : g->all_monsters() ) {
+        // @todo Generalize this to Creature::hear_sound
+        const heard_sound heard = loudest_sound_at( critter.pos() );
+        if( heard.volume > 0 ) {
+            critter.hear_sound( heard.source, heard.volume, heard.distance );
         }
     }
     recent_sounds.clear();
@@ -389,6 +434,7 @@ void sounds::reset_sounds()
     recent_sounds.clear();
     sounds_since_last_turn.clear();
     sound_markers.clear();
+    sound_field.clear();
 }
 
 void sounds::reset_markers()
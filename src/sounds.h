@@ -45,6 +45,20 @@ void reset_markers();
 // Methods for processing sound events, these
 // process_sounds() applies the sounds since the last turn to monster AI,
 void process_sounds();
+
+/** A sound of the last turn as heard at some place. */
+struct heard_sound {
+    tripoint source;
+    /** Volume at the source, after the weather, 0 if nothing is heard. */
+    int volume;
+    /** Distance from the place the sound is heard at to the source. */
+    int distance;
+};
+/**
+ * The loudest of the sounds last applied to monster AI by @ref process_sounds that
+ * a monster can hear at `p`. Only checks the sounds that can reach the submap of `p`.
+ */
+heard_sound loudest_sound_at( const tripoint &p );
 // process_sound_markers applies sound events to the player and records them for display.
 void process_sound_markers( player *p );
 
@@ -24,6 +24,18 @@ submap::~submap()
     delete_vehicles();
 }
 
+void submap::update_field_tiles()
+{
+    for( int x = 0; x < SEEX; x++ ) {
+        field_tiles[x] = 0;
+        for( int y = 0; y < SEEY; y++ ) {
+            if( fld[x][y].fieldCount() > 0 ) {
+                set_field_tile( x, y );
+            }
+        }
+    }
+}
+
 void submap::delete_vehicles()
 {
     for( vehicle *veh : vehicles ) {
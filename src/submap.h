@@ -12,6 +12,8 @@
 #include "active_item_cache.h"
 #include "copyable_unique_ptr.h"
 
+#include <array>
+#include <cstdint>
 #include <vector>
 #include <list>
 #include <map>
@@ -114,6 +116,29 @@ struct submap {
         }
     }
 
+    // Tiles holding fields, see field_tiles
+    void set_field_tile( const int x, const int y ) {
+        field_tiles[x] |= 1 << y;
+    }
+
+    void clear_field_tile( const int x, const int y ) {
+        field_tiles[x] &= ~( 1 << y );
+    }
+
+    /** First y at or after the given one where column x holds fields, SEEY if there is none. */
+    int next_field_tile( const int x, int y ) const {
+        if( ( field_tiles[x] >> y ) == 0 ) {
+            return SEEY;
+        }
+        while( !( field_tiles[x] & ( 1 << y ) ) ) {
+            y++;
+        }
+        return y;
+    }
+
+    /** Recalculates field_tiles from the fields, for code that moves fields around directly. */
+    void update_field_tiles();
+
     bool has_graffiti( int x, int y ) const;
     const std::string &get_graffiti( int x, int y ) const;
     void set_graffiti( int x, int y, const std::string &new_graffiti );
@@ -169,6 +194,11 @@ struct submap {
     active_item_cache active_items;
 
     int field_count = 0;
+    /**
+     * A bit for each tile (bit y of column x) that holds fields, so field processing can skip
+     * the empty ones. Set whenever a field is added, cleared once a tile is found to be empty.
+     */
+    std::array<std::uint16_t, SEEX> field_tiles = {{}};
     int turn_last_touched = 0;
     int temperature = 0;
     std::vector<spawn_point> spawns;
@@ -248,6 +278,7 @@ public:
         const bool ret = sm->fld[x][y].addField( field_to_add, new_density, new_age );
         if( ret ) {
             sm->field_count++;
+            sm->set_field_tile( x, y );
         }
 
         return ret;
@@ -218,6 +218,9 @@ class vpart_info
         bool has_flag( const vpart_bitflags flag ) const {
             return bitflags.test( flag );
         }
+        const std::set<std::string> &get_flags() const {
+            return flags;
+        }
         void set_flag( const std::string &flag );
 
         static void load( JsonObject &jo, const std::string &src );
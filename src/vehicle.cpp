@@ -124,6 +124,7 @@ vehicle::vehicle() : vehicle( vproto_id() )
 
 vehicle::~vehicle()
 {
+    invalidate_power_grid();
 }
 
 void vehicle::set_hp( vehicle_part &pt, int qty )
@@ -1290,8 +1291,8 @@ void vehicle::honk_horn()
     const bool no_power = ! fuel_left( fuel_type_battery, true );
     bool honked = false;
 
-    for( size_t p = 0; p < parts.size(); ++p ) {
-        if( ! part_flag( p, "HORN" ) ) {
+    for( const int p : parts_with_flag( "HORN" ) ) {
+        if( parts[ p ].removed ) {
             continue;
         }
         //Only bicycle horn doesn't need electricity to work
@@ -1331,8 +1332,8 @@ void vehicle::beeper_sound()
     }
 
     const bool odd_turn = (calendar::turn % 2 == 0);
-    for( size_t p = 0; p < parts.size(); ++p ) {
-        if( !part_flag( p, "BEEPER" ) ) {
+    for( const int p : parts_with_flag( "BEEPER" ) ) {
+        if( parts[ p ].removed ) {
             continue;
         }
         if( ( odd_turn && part_flag( p, VPFLAG_EVENTURN ) ) ||
@@ -1899,6 +1900,16 @@ int vehicle::install_part( int dx, int dy, const vehicle_part &new_part )
         }
     }
 
+    if( funnels.empty() && solar_panels.empty() ) {
+        // update_time() was not needed so far and dormant vehicles skip it,
+        // don't let a new panel or funnel catch up on weather from before it was there
+        last_update_turn = calendar::turn;
+    }
+
+    if( new_part.info().has_flag( "POWER_TRANSFER" ) ) {
+        invalidate_power_grid();
+    }
+
     parts.push_back( new_part );
     auto &pt = parts.back();
 
@@ -1928,6 +1939,9 @@ bool vehicle::remove_part( int p )
          */
         return false;
     }
+    if( part_flag( p, "POWER_TRANSFER" ) ) {
+        invalidate_power_grid();
+    }
 
     int x = parts[p].precalc[0].x;
     int y = parts[p].precalc[0].y;
@@ -2105,9 +2119,8 @@ std::vector<int> vehicle::parts_at_relative (const int dx, const int dy, bool co
         }
         return res;
     } else {
-        const auto &iter = relative_parts.find( point( dx, dy ) );
-        if ( iter != relative_parts.end() ) {
-            return iter->second;
+        if( const std::vector<int> *parts_here = relative_parts.find( point( dx, dy ) ) ) {
+            return *parts_here;
         } else {
             std::vector<int> res;
             return res;
@@ -2120,10 +2133,8 @@ int vehicle::part_with_feature (int part, vpart_bitflags const flag, bool unbrok
     if (part_flag(part, flag)) {
         return part;
     }
-    const auto it = relative_parts.find( parts[part].mount );
-    if ( it != relative_parts.end() ) {
-        const std::vector<int> & parts_here = it->second;
-        for (auto &i : parts_here) {
+    if( const std::vector<int> *parts_here = relative_parts.find( parts[part].mount ) ) {
+        for( auto &i : *parts_here ) {
             if( part_flag( i, flag ) && ( !unbroken || !parts[i].is_broken() ) ) {
                 return i;
             }
@@ -2150,20 +2161,22 @@ int vehicle::part_with_feature_at_relative (const point &pt, const std::string &
 
 bool vehicle::has_part( const std::string &flag, bool enabled ) const
 {
-    return std::any_of( parts.begin(), parts.end(), [&flag,&enabled]( const vehicle_part &e ) {
-        return !e.removed && ( !enabled || e.enabled ) && !e.is_broken() && e.info().has_flag( flag );
+    const std::vector<int> &found = parts_with_flag( flag );
+    return std::any_of( found.begin(), found.end(), [this, enabled]( const int p ) {
+        const vehicle_part &e = parts[ p ];
+        return !e.removed && ( !enabled || e.enabled ) && !e.is_broken();
     } );
 }
 
 bool vehicle::has_part( const tripoint &pos, const std::string &flag, bool enabled ) const
 {
-    auto px = pos.x - global_x();
-    auto py = pos.y - global_y();
-
-    for( const auto &e : parts ) {
-        if( e.precalc[0].x != px || e.precalc[0].y != py ) {
-            continue;
-        }
+    const std::vector<int> *parts_here = positioned_parts.find( point( pos.x - global_x(),
+                                         pos.y - global_y() ) );
+    if( parts_here == nullptr ) {
+        return false;
+    }
+    for( const int p : *parts_here ) {
+        const vehicle_part &e = parts[p];
         if( !e.removed && ( !enabled || e.enabled ) && !e.is_broken() && e.info().has_flag( flag ) ) {
             return true;
         }
@@ -2175,8 +2188,9 @@ bool vehicle::has_part( const tripoint &pos, const std::string &flag, bool enabl
 template<typename Vehicle, typename Flag, typename Vector>
 void get_parts_helper( Vehicle &veh, const Flag &flag, Vector &ret, bool enabled )
 {
-    for( auto &e : veh.parts ) {
-        if( !e.removed && ( !enabled || e.enabled ) && !e.is_broken() && e.info().has_flag( flag ) ) {
+    for( const int p : veh.parts_with_flag( flag ) ) {
+        auto &e = veh.parts[ p ];
+        if( !e.removed && ( !enabled || e.enabled ) && !e.is_broken() ) {
             ret.emplace_back( &e );
         }
     }
@@ -2210,33 +2224,34 @@ std::vector<const vehicle_part *> vehicle::get_parts( vpart_bitflags flag, bool
     return res;
 }
 
-std::vector<vehicle_part *> vehicle::get_parts( const tripoint &pos, const std::string &flag, bool enabled )
+template<typename Vehicle, typename Vector>
+void get_parts_at_helper( Vehicle &veh, const tripoint &pos, const std::string &flag, Vector &ret,
+                          bool enabled )
 {
-    std::vector<vehicle_part *> res;
-    for( auto &e : parts ) {
-        if( e.precalc[ 0 ].x != pos.x - global_x() ||
-            e.precalc[ 0 ].y != pos.y - global_y() ) {
-            continue;
-        }
+    const std::vector<int> *parts_here = veh.positioned_parts.find( point( pos.x - veh.global_x(),
+                                         pos.y - veh.global_y() ) );
+    if( parts_here == nullptr ) {
+        return;
+    }
+    for( const int p : *parts_here ) {
+        auto &e = veh.parts[p];
         if( !e.removed && ( !enabled || e.enabled ) && !e.is_broken() && ( flag.empty() || e.info().has_flag( flag ) ) ) {
-            res.push_back( &e );
+            ret.push_back( &e );
         }
     }
+}
+
+std::vector<vehicle_part *> vehicle::get_parts( const tripoint &pos, const std::string &flag, bool enabled )
+{
+    std::vector<vehicle_part *> res;
+    get_parts_at_helper( *this, pos, flag, res, enabled );
     return res;
 }
 
 std::vector<const vehicle_part *> vehicle::get_parts( const tripoint &pos, const std::string &flag, bool enabled ) const
 {
     std::vector<const vehicle_part *> res;
-    for( const auto &e : parts ) {
-        if( e.precalc[ 0 ].x != pos.x - global_x() ||
-            e.precalc[ 0 ].y != pos.y - global_y() ) {
-            continue;
-        }
-        if( !e.removed && ( !enabled || e.enabled ) && !e.is_broken() && ( flag.empty() || e.info().has_flag( flag ) ) ) {
-            res.push_back( &e );
-        }
-    }
+    get_parts_at_helper( *this, pos, flag, res, enabled );
     return res;
 }
 
@@ -2346,10 +2361,9 @@ int vehicle::next_part_to_open(int p, bool outside) const
 std::vector<int> vehicle::all_parts_with_feature(const std::string& feature, bool const unbroken) const
 {
     std::vector<int> parts_found;
-    for( size_t part_index = 0; part_index < parts.size(); ++part_index ) {
-        if(part_info(part_index).has_flag(feature) &&
-                ( !unbroken || !parts[ part_index ].is_broken() ) ) {
-            parts_found.push_back(part_index);
+    for( const int part_index : parts_with_flag( feature ) ) {
+        if( !parts[ part_index ].removed && ( !unbroken || !parts[ part_index ].is_broken() ) ) {
+            parts_found.push_back( part_index );
         }
     }
     return parts_found;
@@ -2358,15 +2372,32 @@ std::vector<int> vehicle::all_parts_with_feature(const std::string& feature, boo
 std::vector<int> vehicle::all_parts_with_feature(vpart_bitflags feature, bool const unbroken) const
 {
     std::vector<int> parts_found;
-    for( size_t part_index = 0; part_index < parts.size(); ++part_index ) {
-        if(part_info(part_index).has_flag(feature) &&
-                ( !unbroken || !parts[ part_index ].is_broken() ) ) {
-            parts_found.push_back(part_index);
+    for( const int part_index : parts_with_flag( feature ) ) {
+        if( !parts[ part_index ].removed && ( !unbroken || !parts[ part_index ].is_broken() ) ) {
+            parts_found.push_back( part_index );
         }
     }
     return parts_found;
 }
 
+/**
+ * Returns the parts with the given flag as of the last refresh(). The lists are
+ * rebuilt whenever parts are added or removed; a part breaking does not change
+ * them, so callers filter by part state themselves.
+ */
+const std::vector<int> &vehicle::parts_with_flag( const std::string &flag ) const
+{
+    static const std::vector<int> none;
+    const auto iter = parts_by_flag.find( flag );
+    return iter != parts_by_flag.end() ? iter->second : none;
+}
+
+const std::vector<int> &vehicle::parts_with_flag( vpart_bitflags flag ) const
+{
+    static const std::vector<int> none;
+    return static_cast<size_t>( flag ) < parts_by_bitflag.size() ? parts_by_bitflag[ flag ] : none;
+}
+
 /**
  * Returns all parts in the vehicle that exist in the given location slot. If
  * the empty string is passed in, returns all parts with no slot.
@@ -2404,12 +2435,9 @@ bool vehicle::part_flag( int part, const vpart_bitflags flag) const
 
 int vehicle::part_at(int const dx, int const dy) const
 {
-    for (size_t p = 0; p < parts.size(); p++) {
-        if (parts[p].precalc[0].x == dx && parts[p].precalc[0].y == dy && !parts[p].removed) {
-            return (int)p;
-        }
-    }
-    return -1;
+    // Parts are listed in order of their indices, the first one is what a scan would find
+    const std::vector<int> *parts_here = positioned_parts.find( point( dx, dy ) );
+    return parts_here != nullptr ? parts_here->front() : -1;
 }
 
 int vehicle::global_part_at(int const x, int const y) const
@@ -2797,6 +2825,80 @@ void vehicle::precalc_mounts (int idir, int dir, const point &pivot)
     }
     pivot_anchor[idir] = pivot;
     pivot_rotation[idir] = dir;
+    if( idir == 0 ) {
+        refresh_part_positions();
+    }
+}
+
+/**
+ * Returns the bounding box of the given points of the parts that aren't removed,
+ * or an empty box if there are none.
+ */
+template<typename PointOf>
+static std::pair<point, point> part_bounds( const std::vector<vehicle_part> &parts, PointOf point_of )
+{
+    point min( INT_MAX, INT_MAX );
+    point max( INT_MIN, INT_MIN );
+    for( const vehicle_part &p : parts ) {
+        if( p.removed ) {
+            continue;
+        }
+        const point &here = point_of( p );
+        min.x = std::min( min.x, here.x );
+        min.y = std::min( min.y, here.y );
+        max.x = std::max( max.x, here.x );
+        max.y = std::max( max.y, here.y );
+    }
+    if( min.x > max.x ) {
+        return { point( 0, 0 ), point( -1, -1 ) };
+    }
+    return { min, max };
+}
+
+void vehicle::refresh_part_positions()
+{
+    const auto bounds = part_bounds( parts, []( const vehicle_part &p ) {
+        return p.precalc[0];
+    } );
+    positioned_parts.reset( bounds.first, bounds.second );
+    for( size_t p = 0; p < parts.size(); p++ ) {
+        if( !parts[p].removed ) {
+            positioned_parts.at( parts[p].precalc[0] ).push_back( p );
+        }
+    }
+}
+
+void vehicle_part_grid::reset( const point &min, const point &max )
+{
+    origin = min;
+    width = std::max( max.x - min.x + 1, 0 );
+    height = std::max( max.y - min.y + 1, 0 );
+    // Keep the capacity of the lists, vehicles get refreshed often
+    for( auto &cell : cells ) {
+        cell.clear();
+    }
+    cells.resize( width * height );
+}
+
+void vehicle_part_grid::clear()
+{
+    reset( point( 0, 0 ), point( -1, -1 ) );
+}
+
+std::vector<int> &vehicle_part_grid::at( const point &p )
+{
+    return cells[( p.x - origin.x ) * height + p.y - origin.y];
+}
+
+const std::vector<int> *vehicle_part_grid::find( const point &p ) const
+{
+    const int x = p.x - origin.x;
+    const int y = p.y - origin.y;
+    if( x < 0 || x >= width || y < 0 || y >= height ) {
+        return nullptr;
+    }
+    const std::vector<int> &cell = cells[x * height + y];
+    return cell.empty() ? nullptr : &cell;
 }
 
 std::vector<int> vehicle::boarded_parts() const
@@ -2932,14 +3034,7 @@ int vehicle::fuel_left (const itype_id & ftype, bool recurse) const
     } );
 
     if(recurse && ftype == fuel_type_battery) {
-        auto fuel_counting_visitor = [&] (vehicle const* veh, int amount, int) {
-            return amount + veh->fuel_left(ftype, false);
-        };
-
-        // HAX: add 1 to the initial amount so traversal doesn't immediately stop just
-        // 'cause we have 0 fuel left in the current vehicle. Subtract the 1 immediately
-        // after traversal.
-        fl = traverse_vehicle_graph(this, fl + 1, fuel_counting_visitor) - 1;
+        fl = power_grid().charge();
     }
 
     //muscle engines have infinite fuel
@@ -3137,7 +3232,7 @@ void vehicle::spew_smoke( double joules, int part, int density )
     point p = parts[part].mount;
     density = std::max( joules / 10000, double( density ) );
     // Move back from engine/muffler til we find an open space
-    while( relative_parts.find(p) != relative_parts.end() ) {
+    while( relative_parts.find( p ) != nullptr ) {
         p.x += ( velocity < 0 ? 1 : -1 );
     }
     point q = coord_translate(p);
@@ -3161,13 +3256,14 @@ void vehicle::noise_and_smoke( double load, double time )
     double mufflesmoke = 0.0;
     double muffle = 1.0, m;
     int exhaust_part = -1;
-    for( size_t p = 0; p < parts.size(); p++ ) {
-        if( part_flag(p, "MUFFLER") ) {
-            m = 1.0 - (1.0 - part_info(p).bonus / 100.0) * double( parts[p].hp() ) / part_info(p).durability;
-            if( m < muffle ) {
-                muffle = m;
-                exhaust_part = int(p);
-            }
+    for( const int p : parts_with_flag( "MUFFLER" ) ) {
+        if( parts[ p ].removed ) {
+            continue;
+        }
+        m = 1.0 - (1.0 - part_info(p).bonus / 100.0) * double( parts[p].hp() ) / part_info(p).durability;
+        if( m < muffle ) {
+            muffle = m;
+            exhaust_part = p;
         }
     }
 
@@ -3465,12 +3561,12 @@ std::map<itype_id, int> vehicle::fuel_usage() const
 float vehicle::drain_energy( const itype_id &ftype, float energy )
 {
     float drained = 0.0f;
-    for( auto &p : parts ) {
+    for( const int e : fuel_stores ) {
         if( energy <= 0.0f ) {
             break;
         }
 
-        float consumed = p.consume_energy( ftype, energy );
+        float consumed = parts[ e ].consume_energy( ftype, energy );
         drained += consumed;
         energy -= consumed;
     }
@@ -3689,54 +3785,105 @@ vehicle* vehicle::find_vehicle( const tripoint &where )
     return veh;
 }
 
-template <typename Func, typename Vehicle>
-int vehicle::traverse_vehicle_graph(Vehicle *start_veh, int amount, Func action)
+int vehicle_power_grid::charge() const
 {
-    // Breadth-first search! Initialize the queue with a pointer to ourselves and go!
-    std::queue< std::pair<Vehicle*, int> > connected_vehs;
-    std::set<Vehicle*> visited_vehs;
-    connected_vehs.push(std::make_pair(start_veh, 0));
-
-    while(amount > 0 && connected_vehs.size() > 0) {
-        auto current_node = connected_vehs.front();
-        Vehicle *current_veh = current_node.first;
-        int current_loss = current_node.second;
-
-        visited_vehs.insert(current_veh);
-        connected_vehs.pop();
+    int total = 0;
+    for( const vehicle *veh : members ) {
+        total += veh->fuel_left( fuel_type_battery, false );
+    }
+    return total;
+}
 
-        g->u.add_msg_if_player(m_debug, "Traversing graph with %d power", amount);
+const vehicle_power_grid &vehicle::power_grid() const
+{
+    if( power_grid_cache && power_grid_cache->valid && power_grid_cache->routes.count( this ) > 0 ) {
+        return *power_grid_cache;
+    }
 
-        for(auto &p : current_veh->loose_parts) {
-            if(!current_veh->part_info(p).has_flag("POWER_TRANSFER")) {
+    auto grid = std::make_shared<vehicle_power_grid>();
+    // Find every connected vehicle and the cables between them. This is the only
+    // place that looks up (and possibly loads) the vehicles at the other cable ends.
+    std::map<const vehicle *, size_t> member_index;
+    std::vector<std::vector<std::pair<size_t, int>>> cables;
+    grid->members.push_back( const_cast<vehicle *>( this ) );
+    member_index[ this ] = 0;
+    cables.emplace_back();
+    for( size_t i = 0; i < grid->members.size(); i++ ) {
+        const vehicle *current_veh = grid->members[ i ];
+        for( const int p : current_veh->loose_parts ) {
+            if( !current_veh->part_info( p ).has_flag( "POWER_TRANSFER" ) ) {
                 continue; // ignore loose parts that aren't power transfer cables
             }
-
-            auto target_veh = vehicle::find_vehicle(current_veh->parts[p].target.second);
-            if(target_veh == nullptr || visited_vehs.count(target_veh) > 0) {
-                // Either no destination here (that vehicle's rolled away or off-map) or
-                // we've already looked at that vehicle.
+            vehicle *target_veh = vehicle::find_vehicle( current_veh->parts[ p ].target.second );
+            if( target_veh == nullptr ) {
+                // That vehicle's rolled away or off-map
                 continue;
             }
+            auto iter = member_index.find( target_veh );
+            if( iter == member_index.end() ) {
+                iter = member_index.emplace( target_veh, grid->members.size() ).first;
+                grid->members.push_back( target_veh );
+                cables.emplace_back();
+            }
+            cables[ i ].emplace_back( iter->second, current_veh->part_info( p ).epower );
+        }
+    }
+
+    // Breadth-first from every member, losses add up along the way
+    for( size_t start = 0; start < grid->members.size(); start++ ) {
+        std::vector<vehicle_power_grid::link> &route = grid->routes[ grid->members[ start ] ];
+        std::vector<bool> visited( grid->members.size(), false );
+        std::queue<std::pair<size_t, int>> connected_vehs;
+        visited[ start ] = true;
+        connected_vehs.emplace( start, 0 );
+        while( !connected_vehs.empty() ) {
+            const std::pair<size_t, int> current = connected_vehs.front();
+            connected_vehs.pop();
+            for( const auto &cable : cables[ current.first ] ) {
+                if( visited[ cable.first ] ) {
+                    continue;
+                }
+                visited[ cable.first ] = true;
+                const int target_loss = current.second + cable.second;
+                route.push_back( { grid->members[ cable.first ], target_loss } );
+                connected_vehs.emplace( cable.first, target_loss );
+            }
+        }
+    }
 
-            // Add this connected vehicle to the queue of vehicles to search next,
-            // but only if we haven't seen this one before.
-            if(visited_vehs.count(target_veh) < 1) {
-                int target_loss = current_loss + current_veh->part_info(p).epower;
-                connected_vehs.push(std::make_pair(target_veh, target_loss));
-
-                float loss_amount = ((float)amount * (float)target_loss) / 100;
-                g->u.add_msg_if_player(m_debug, "Visiting remote %p with %d power (loss %f, which is %d percent)",
-                                        (void*)target_veh, amount, loss_amount, target_loss);
+    for( vehicle *veh : grid->members ) {
+        if( veh->power_grid_cache ) {
+            veh->power_grid_cache->valid = false;
+        }
+        veh->power_grid_cache = grid;
+    }
+    return *grid;
+}
 
-                amount = action(target_veh, amount, (int)loss_amount);
-                g->u.add_msg_if_player(m_debug, "After remote %p, %d power", (void*)target_veh, amount);
+void vehicle::invalidate_power_grid()
+{
+    if( power_grid_cache ) {
+        power_grid_cache->valid = false;
+        power_grid_cache.reset();
+    }
+}
 
-                if(amount < 1) {
-                    break; // No more charge to donate away.
-                }
-            }
+template <typename Func, typename Vehicle>
+int vehicle::traverse_vehicle_graph(Vehicle *start_veh, int amount, Func action)
+{
+    // A copy, the visitor may end up invalidating the grid
+    const std::vector<vehicle_power_grid::link> route = start_veh->power_grid().routes.at( start_veh );
+    for( const vehicle_power_grid::link &target : route ) {
+        if( amount < 1 ) {
+            break; // No more charge to donate away.
         }
+
+        float loss_amount = ((float)amount * (float)target.loss) / 100;
+        g->u.add_msg_if_player(m_debug, "Visiting remote %p with %d power (loss %f, which is %d percent)",
+                                (void*)target.veh, amount, loss_amount, target.loss);
+
+        amount = action(target.veh, amount, (int)loss_amount);
+        g->u.add_msg_if_player(m_debug, "After remote %p, %d power", (void*)target.veh, amount);
     }
     return amount;
 }
@@ -3855,6 +4002,22 @@ void vehicle::idle(bool on_map) {
     }
 }
 
+bool vehicle::is_dormant() const
+{
+    if( engine_on || is_alarm_on || camera_on || !solar_panels.empty() || !funnels.empty() ) {
+        return false;
+    }
+    const auto running = [this]( const std::vector<int> &found ) {
+        return std::any_of( found.begin(), found.end(), [this]( const int p ) {
+            const vehicle_part &e = parts[ p ];
+            return !e.removed && e.enabled && !e.is_broken();
+        } );
+    };
+    return !running( parts_with_flag( VPFLAG_ENABLED_DRAINS_EPOWER ) ) &&
+           !running( parts_with_flag( "REACTOR" ) ) && !running( parts_with_flag( "PLANTER" ) ) &&
+           !running( parts_with_flag( "STEREO" ) ) && !running( parts_with_flag( "CHIMES" ) );
+}
+
 void vehicle::on_move(){
     if( has_part( "SCOOP", true ) ) {
         operate_scoop();
@@ -4037,7 +4200,8 @@ void vehicle::alarm() {
 void vehicle::slow_leak()
 {
     // for each badly damaged tanks (lower than 50% health), leak a small amount
-    for( auto &p : parts ) {
+    for( const int e : fuel_stores ) {
+        vehicle_part &p = parts[ e ];
         auto dmg = double( p.hp() ) / p.info().durability;
         if( dmg > 0.5 || p.ammo_remaining() <= 0 ) {
             continue;
@@ -5083,12 +5247,17 @@ void vehicle::refresh()
     reactors.clear();
     solar_panels.clear();
     funnels.clear();
-    relative_parts.clear();
     loose_parts.clear();
     wheelcache.clear();
     steering.clear();
     speciality.clear();
     floating.clear();
+    fuel_stores.clear();
+    parts_by_bitflag.resize( NUM_VPFLAGS );
+    for( auto &e : parts_by_bitflag ) {
+        e.clear();
+    }
+    parts_by_flag.clear();
     tracking_epower = 0;
     alternator_load = 0;
     camera_epower = 0;
@@ -5102,6 +5271,11 @@ void vehicle::refresh()
     } svpv = { this };
     std::vector<int>::iterator vii;
 
+    const auto bounds = part_bounds( parts, []( const vehicle_part &p ) {
+        return p.mount;
+    } );
+    relative_parts.reset( bounds.first, bounds.second );
+
     // Main loop over all vehicle parts.
     for( size_t p = 0; p < parts.size(); p++ ) {
         const vpart_info& vpi = part_info( p );
@@ -5144,6 +5318,17 @@ void vehicle::refresh()
         if( vpi.has_flag( VPFLAG_FLOATS ) ) {
             floating.push_back( p );
         }
+        if( parts[ p ].is_tank() || parts[ p ].is_battery() || parts[ p ].is_reactor() ) {
+            fuel_stores.push_back( p );
+        }
+        for( size_t f = 0; f < parts_by_bitflag.size(); f++ ) {
+            if( vpi.has_flag( static_cast<vpart_bitflags>( f ) ) ) {
+                parts_by_bitflag[ f ].push_back( p );
+            }
+        }
+        for( const std::string &flag : vpi.get_flags() ) {
+            parts_by_flag[ flag ].push_back( p );
+        }
         if( parts[ p ].enabled ) {
             if( vpi.has_flag( "PLOW" ) ) {
                 extra_drag += vpi.power;
@@ -5156,10 +5341,10 @@ void vehicle::refresh()
             }
         }
         // Build map of point -> all parts in that point
-        const point pt = parts[p].mount;
-        // This will keep the parts at point pt sorted
-        vii = std::lower_bound( relative_parts[pt].begin(), relative_parts[pt].end(), static_cast<int>( p ), svpv );
-        relative_parts[pt].insert( vii, p );
+        std::vector<int> &parts_here = relative_parts.at( parts[p].mount );
+        // This will keep the parts at that point sorted
+        vii = std::lower_bound( parts_here.begin(), parts_here.end(), static_cast<int>( p ), svpv );
+        parts_here.insert( vii, p );
     }
 
     // NB: using the _old_ pivot point, don't recalc here, we only do that when moving!
@@ -16,7 +16,9 @@
 #include <vector>
 #include <array>
 #include <map>
+#include <unordered_map>
 #include <list>
+#include <memory>
 #include <string>
 #include <iosfwd>
 
@@ -400,6 +402,49 @@ struct label : public JsonSerializer, public JsonDeserializer {
     void deserialize(JsonIn &jsin) override;
 };
 
+/**
+ * Lists of part indices by point, stored densely over the bounding box of the points
+ * that have parts, so looking up a point is a bounds check and an array access.
+ */
+class vehicle_part_grid
+{
+    public:
+        /** Makes the grid cover the box from `min` to `max` with no parts anywhere. */
+        void reset( const point &min, const point &max );
+        void clear();
+        /** The parts at `p`, which must be inside the box. */
+        std::vector<int> &at( const point &p );
+        /** The parts at `p`, nullptr if there are none. */
+        const std::vector<int> *find( const point &p ) const;
+
+    private:
+        point origin;
+        int width = 0;
+        int height = 0;
+        std::vector<std::vector<int>> cells;
+};
+
+/**
+ * Vehicles joined by POWER_TRANSFER cables. Built by vehicle::power_grid() and shared
+ * by all members until a cable is attached or removed or a member is unloaded.
+ */
+struct vehicle_power_grid {
+    struct link {
+        vehicle *veh;
+        int loss; // Percentage of power lost on the way there
+    };
+
+    /** All connected vehicles, including the one that built the grid. */
+    std::vector<vehicle *> members;
+    /** For each member, the other members in the order a breadth-first walk reaches them. */
+    std::map<const vehicle *, std::vector<link>> routes;
+    /** Cleared when the grid is outdated, members holding on to it must build a new one. */
+    bool valid = true;
+
+    /** Battery charge of all members together. */
+    int charge() const;
+};
+
 /**
  * A vehicle as a whole with all its components.
  *
@@ -531,7 +576,8 @@ private:
 
     /**
      * Traverses the graph of connected vehicles, starting from start_veh, and continuing
-     * along all vehicles connected by some kind of POWER_TRANSFER part.
+     * along all vehicles connected by some kind of POWER_TRANSFER part. The graph is
+     * taken from power_grid(), so it is only walked again after the cables change.
      * @param start_veh The vehicle to start traversing from. NB: the start_vehicle is
      * assumed to have been already visited!
      * @param amount An amount of power to traverse with. This is passed back to the visitor,
@@ -543,6 +589,8 @@ private:
      */
     template <typename Func, typename Vehicle>
     static int traverse_vehicle_graph(Vehicle *start_veh, int amount, Func visitor);
+    // Marks the power grid outdated for all its members, after cables change or this vehicle goes away
+    void invalidate_power_grid();
 public:
     vehicle(const vproto_id &type_id, int veh_init_fuel = -1, int veh_init_status = -1);
     vehicle();
@@ -727,6 +775,10 @@ public:
     std::vector<int> all_parts_with_feature(const std::string &feature, bool unbroken = true) const;
     std::vector<int> all_parts_with_feature(vpart_bitflags f, bool unbroken = true) const;
 
+    // returns indices of all non-removed parts with the given flag, broken or not, in index order
+    const std::vector<int> &parts_with_flag( const std::string &flag ) const;
+    const std::vector<int> &parts_with_flag( vpart_bitflags flag ) const;
+
     // returns indices of all parts in the given location slot
     std::vector<int> all_parts_at_location(const std::string &location) const;
 
@@ -774,6 +826,8 @@ public:
 
     // Precalculate mount points for (idir=0) - current direction or (idir=1) - next turn direction
     void precalc_mounts (int idir, int dir, const point &pivot);
+    // Rebuild positioned_parts, needed whenever precalc[0] changes
+    void refresh_part_positions();
 
     // get a list of part indeces where is a passenger inside
     std::vector<int> boarded_parts() const;
@@ -812,6 +866,8 @@ public:
 
     // Checks how much certain fuel left in tanks.
     int fuel_left (const itype_id &ftype, bool recurse = false) const;
+    // The vehicles this one is connected to by cables, see vehicle_power_grid
+    const vehicle_power_grid &power_grid() const;
     int fuel_capacity (const itype_id &ftype) const;
 
     // drains a fuel type (e.g. for the kitchen unit)
@@ -974,6 +1030,12 @@ public:
 
     // idle fuel consumption
     void idle(bool on_map = true);
+    /**
+     * True if nothing on the vehicle is running: engines, alarm and camera are off,
+     * there are no solar panels or funnels and no reactor, power drain, planter or
+     * sound system is enabled. power_parts() and idle() have nothing to do then.
+     */
+    bool is_dormant() const;
     // continuous processing for running vehicle alarms
     void alarm();
     // leak from broken tanks
@@ -1223,7 +1285,8 @@ public:
     vproto_id type;
     std::vector<vehicle_part> parts;   // Parts which occupy different tiles
     int removed_part_count;            // Subtract from parts.size() to get the real part count.
-    std::map<point, std::vector<int> > relative_parts;    // parts_at_relative(x,y) is used alot (to put it mildly)
+    vehicle_part_grid relative_parts;  // parts_at_relative(x,y) is used alot (to put it mildly)
+    vehicle_part_grid positioned_parts; // Parts by their precalc[0] coords, for part_at(x,y)
     std::set<label> labels;            // stores labels
     std::vector<int> alternators;      // List of alternator indices
     std::vector<int> engines;          // List of engine indices
@@ -1235,6 +1298,9 @@ public:
     std::vector<int> steering;         // List of STEERABLE parts
     std::vector<int> speciality;       // List of parts that will not be on a vehicle very often, or which only one will be present
     std::vector<int> floating;         // List of parts that provide buoyancy to boats
+    std::vector<int> fuel_stores;      // List of tanks, batteries and reactors
+    std::vector<std::vector<int>> parts_by_bitflag; // Part indices indexed by vpart_bitflags, see parts_with_flag()
+    std::unordered_map<std::string, std::vector<int>> parts_by_flag; // Part indices by string flag
     std::set<std::string> tags;        // Properties of the vehicle
     std::map<itype_id,float> fuel_remainder; // After fuel consumption, this tracks the remainder of fuel < 1, and applies it the next time.
     active_item_cache active_items;
@@ -1330,6 +1396,8 @@ private:
     mutable units::mass mass_cache;
     mutable point mass_center_precalc;
     mutable point mass_center_no_precalc;
+
+    mutable std::shared_ptr<vehicle_power_grid> power_grid_cache;
 };
 
 #endif
@@ -75,7 +75,7 @@ int get_rot_since( const int startturn, const int endturn, const tripoint &locat
     // Ensure food doesn't rot in ice labs, where the
     // temperature is much less than the weather specifies.
     tripoint const omt_pos = ms_to_omt_copy( location );
-    oter_id const & oter = overmap_buffer.ter( omt_pos );
+    oter_id const & oter = overmap_buffer.get_ter( omt_pos );
     // TODO: extract this into a property of the overmap terrain
     if (is_ot_type("ice_lab", oter)) {
         return 0;
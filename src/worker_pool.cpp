@@ -0,0 +1,119 @@
+#include "worker_pool.h"
+
+#include "game.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Set while a thread runs the tasks of a batch, a nested run() can't wait for the other workers.
+static thread_local bool in_task = false;
+
+struct worker_pool::impl {
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable start;
+    std::condition_variable done;
+
+    // The batch currently being run, set under the mutex before batch is advanced.
+    const std::function<void( int, int )> *task = nullptr;
+    int count = 0;
+    std::atomic<int> next_index{ 0 };
+    unsigned batch = 0;
+    // Helper threads that didn't finish the current batch yet.
+    int busy = 0;
+    bool stopping = false;
+
+    void work( const int worker ) {
+        in_task = true;
+        for( int index = next_index++; index < count; index = next_index++ ) {
+            ( *task )( index, worker );
+        }
+        in_task = false;
+    }
+
+    void loop( const int worker ) {
+        unsigned seen_batch = 0;
+        std::unique_lock<std::mutex> lock( mutex );
+        while( true ) {
+            start.wait( lock, [&]() {
+                return stopping || batch != seen_batch;
+            } );
+            if( stopping ) {
+                return;
+            }
+            seen_batch = batch;
+            lock.unlock();
+            work( worker );
+            lock.lock();
+            if( --busy == 0 ) {
+                done.notify_one();
+            }
+        }
+    }
+};
+
+worker_pool::worker_pool( const int workers ) : pimpl( new impl() )
+{
+    for( int worker = 1; worker < workers; worker++ ) {
+        pimpl->threads.emplace_back( &impl::loop, pimpl.get(), worker );
+    }
+}
+
+worker_pool::~worker_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock( pimpl->mutex );
+        pimpl->stopping = true;
+    }
+    pimpl->start.notify_all();
+    for( auto &thread : pimpl->threads ) {
+        thread.join();
+    }
+}
+
+int worker_pool::size() const
+{
+    return pimpl->threads.size() + 1;
+}
+
+void worker_pool::run( const int count, const std::function<void( int, int )> &task )
+{
+    if( pimpl->threads.empty() || count <= 1 || in_task ) {
+        for( int index = 0; index < count; index++ ) {
+            task( index, 0 );
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock( pimpl->mutex );
+        pimpl->task = &task;
+        pimpl->count = count;
+        pimpl->next_index = 0;
+        pimpl->busy = pimpl->threads.size();
+        pimpl->batch++;
+    }
+    pimpl->start.notify_all();
+    pimpl->work( 0 );
+
+    std::unique_lock<std::mutex> lock( pimpl->mutex );
+    pimpl->done.wait( lock, [this]() {
+        return pimpl->busy == 0;
+    } );
+    pimpl->task = nullptr;
+}
+
+worker_pool *shared_workers()
+{
+    static std::unique_ptr<worker_pool> workers;
+    if( worker_threads <= 1 ) {
+        workers.reset();
+    } else if( !workers || workers->size() != worker_threads ) {
+        workers.reset( new worker_pool( worker_threads ) );
+    }
+    return workers.get();
+}
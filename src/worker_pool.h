@@ -0,0 +1,39 @@
+#pragma once
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <functional>
+#include <memory>
+
+/**
+ * A fixed set of threads that run the iterations of a loop in parallel.
+ * The thread calling @ref run takes part as worker 0, so a pool of one worker
+ * simply runs everything on the calling thread.
+ */
+class worker_pool
+{
+    public:
+        explicit worker_pool( int workers );
+        ~worker_pool();
+
+        /** Number of workers, including the calling thread. */
+        int size() const;
+        /**
+         * Calls task( index, worker ) for every index in [0, count) and returns once all of
+         * them finished. Which worker runs which index is up to the scheduling, but a worker
+         * only runs one task at a time, so the worker id can pick per worker scratch space.
+         */
+        void run( int count, const std::function<void( int index, int worker )> &task );
+
+    private:
+        struct impl;
+        std::unique_ptr<impl> pimpl;
+};
+
+/**
+ * The pool shared by all threaded game code, sized by the WORKER_THREADS option.
+ * Returns nullptr while the option is 1, callers then run their loop on the calling thread.
+ */
+worker_pool *shared_workers();
+
+#endif
@@ -0,0 +1,132 @@
+#include "catch/catch.hpp"
+
+#include "field.h"
+#include "game.h"
+#include "calendar.h"
+#include "map.h"
+
+#include "map_helpers.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <tuple>
+#include <vector>
+
+static std::vector<field_id> field_types( const field &f )
+{
+    std::vector<field_id> types;
+    for( const auto &fld : f ) {
+        types.push_back( fld.first );
+        CHECK( fld.second.getFieldType() == fld.first );
+    }
+    return types;
+}
+
+TEST_CASE( "field_entries_are_ordered_and_stable" )
+{
+    field f;
+    CHECK( f.fieldCount() == 0 );
+    CHECK( f.begin() == f.end() );
+
+    CHECK( f.addField( fd_smoke, 1, 0 ) );
+    CHECK( f.addField( fd_blood, 1, 0 ) );
+    field_entry *const smoke = f.findField( fd_smoke );
+    REQUIRE( smoke != nullptr );
+    // These no longer fit in the field itself
+    CHECK( f.addField( fd_fire, 2, 0 ) );
+    CHECK( f.addField( fd_acid, 1, 0 ) );
+    CHECK_FALSE( f.addField( fd_smoke, 1, 0 ) );
+    CHECK( f.findField( fd_smoke ) == smoke );
+    CHECK( smoke->getFieldDensity() == 2 );
+    CHECK( f.fieldCount() == 4 );
+    CHECK( field_types( f ) == std::vector<field_id>( { fd_blood, fd_acid, fd_fire, fd_smoke } ) );
+
+    const field copy( f );
+    CHECK( field_types( copy ) == field_types( f ) );
+    CHECK( copy.findField( fd_fire )->getFieldDensity() == 2 );
+
+    // Removing while iterating, the way field processing does it
+    for( auto it = f.begin(); it != f.end(); ) {
+        if( it->first != fd_smoke ) {
+            f.removeField( it++ );
+        } else {
+            ++it;
+        }
+    }
+    CHECK( field_types( f ) == std::vector<field_id>( { fd_smoke } ) );
+    CHECK( f.findField( fd_smoke ) == smoke );
+    CHECK( f.fieldSymbol() == fd_smoke );
+    CHECK( f.removeField( fd_smoke ) );
+    CHECK_FALSE( f.removeField( fd_smoke ) );
+    CHECK( f.fieldCount() == 0 );
+    CHECK( f.fieldSymbol() == fd_null );
+    CHECK( field_types( copy ).size() == 4 );
+}
+
+typedef std::tuple<int, int, field_id, int, int> field_state;
+
+static std::vector<field_state> fields_on_map()
+{
+    std::vector<field_state> fields;
+    const int mapsize = g->m.getmapsize() * SEEX;
+    for( int x = 0; x < mapsize; x++ ) {
+        for( int y = 0; y < mapsize; y++ ) {
+            for( const auto &fld : g->m.field_at( tripoint( x, y, 0 ) ) ) {
+                fields.emplace_back( x, y, fld.first, fld.second.getFieldDensity(), fld.second.getFieldAge() );
+            }
+        }
+    }
+    return fields;
+}
+
+static void remove_all_fields()
+{
+    for( const field_state &fs : fields_on_map() ) {
+        g->m.remove_field( tripoint( std::get<0>( fs ), std::get<1>( fs ), 0 ), std::get<2>( fs ) );
+    }
+}
+
+static std::vector<field_state> spread_fields( const int threads )
+{
+    remove_all_fields();
+    // Clouds in several submaps, some of them on submap edges
+    for( int cloud = 0; cloud < 6; cloud++ ) {
+        const tripoint center( 18 + cloud * 17, 30 + cloud * 11, 0 );
+        for( int dx = -2; dx <= 2; dx++ ) {
+            for( int dy = -2; dy <= 2; dy++ ) {
+                const tripoint p( center.x + dx, center.y + dy, 0 );
+                g->m.add_field( p, cloud % 2 == 0 ? fd_smoke : fd_toxic_gas, 3, 1 );
+            }
+        }
+    }
+    // Raging fires with plenty of fuel left, they spread over the grass
+    for( int fire = 0; fire < 4; fire++ ) {
+        const tripoint center( 23 + fire * 23, 100 + fire % 2, 0 );
+        for( int dx = -1; dx <= 1; dx++ ) {
+            g->m.add_field( center + tripoint( dx, 0, 0 ), fd_fire, 3, -MINUTES( 200 ) );
+        }
+    }
+
+    worker_threads = threads;
+    srand( 1234 );
+    for( int turn = 0; turn < 20; turn++ ) {
+        g->m.process_fields();
+    }
+    worker_threads = 1;
+    return fields_on_map();
+}
+
+TEST_CASE( "gas_and_fire_spread_do_not_depend_on_worker_threads" )
+{
+    clear_map();
+    const std::vector<field_state> serial = spread_fields( 1 );
+    const std::vector<field_state> threaded = spread_fields( 4 );
+    // The clouds started out on 6 * 25 tiles
+    CHECK( serial.size() > 6 * 25 );
+    const auto fires = std::count_if( serial.begin(), serial.end(), []( const field_state & fs ) {
+        return std::get<2>( fs ) == fd_fire;
+    } );
+    CHECK( fires > 4 * 3 );
+    CHECK( threaded == serial );
+    remove_all_fields();
+}
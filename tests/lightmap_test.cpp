@@ -0,0 +1,127 @@
+#include "catch/catch.hpp"
+
+#include "field.h"
+#include "game.h"
+#include "map.h"
+#include "mapdata.h"
+#include "player.h"
+
+#include "map_helpers.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+// Fires would otherwise stay around for the tests that run next.
+static void remove_fires()
+{
+    const int mapsize = g->m.getmapsize() * SEEX;
+    for( int x = 0; x < mapsize; ++x ) {
+        for( int y = 0; y < mapsize; ++y ) {
+            g->m.remove_field( tripoint( x, y, 0 ), fd_fire );
+        }
+    }
+}
+
+static bool lightmaps_equal( const level_cache &a, const level_cache &b )
+{
+    const int tiles = MAPSIZE * SEEX * MAPSIZE * SEEY;
+    return std::equal( &a.lm[0][0], &a.lm[0][0] + tiles, &b.lm[0][0] ) &&
+           std::equal( &a.sm[0][0], &a.sm[0][0] + tiles, &b.sm[0][0] );
+}
+
+TEST_CASE( "lightmap_reuses_unchanged_lights" )
+{
+    clear_map();
+    for( int x = 50; x <= 70; x++ ) {
+        g->m.ter_set( tripoint( x, 55, 0 ), t_wall );
+        g->m.ter_set( tripoint( x, 65, 0 ), t_wall );
+    }
+    g->m.ter_set( tripoint( 60, 60, 0 ), t_utility_light );
+    g->m.ter_set( tripoint( 40, 40, 0 ), t_console );
+    g->m.add_field( tripoint( 80, 70, 0 ), fd_fire, 3 );
+
+    g->m.build_map_cache( 0 );
+    const level_cache &cache = g->m.get_cache_ref( 0 );
+    CHECK( cache.lights_cast > 0 );
+    const std::unique_ptr<level_cache> first( new level_cache( cache ) );
+
+    // Nothing changed, so nothing is cast again.
+    g->m.build_map_cache( 0 );
+    CHECK( cache.lights_cast == 0 );
+    CHECK( cache.lights_reused > 0 );
+    CHECK( lightmaps_equal( cache, *first ) );
+
+    // A wall next to one light only recasts the lights that reached it.
+    g->m.ter_set( tripoint( 61, 60, 0 ), t_wall );
+    g->m.build_map_cache( 0 );
+    CHECK( cache.lights_cast > 0 );
+    CHECK( cache.lights_reused > 0 );
+    const std::unique_ptr<level_cache> incremental( new level_cache( cache ) );
+
+    g->m.access_cache( 0 ).light_contributions.clear();
+    g->m.build_map_cache( 0 );
+    CHECK( cache.lights_reused == 0 );
+    CHECK( lightmaps_equal( cache, *incremental ) );
+    remove_fires();
+}
+
+static void build_lit_test_map()
+{
+    clear_map();
+    for( int x = 30; x <= 100; x++ ) {
+        for( int y = 30; y <= 100; y += 9 ) {
+            if( x % 7 != 0 ) {
+                g->m.ter_set( tripoint( x, y, 0 ), t_wall );
+            }
+        }
+    }
+    for( int x = 20; x < 110; x += 6 ) {
+        for( int y = 25; y < 110; y += 11 ) {
+            g->m.add_field( tripoint( x, y, 0 ), fd_fire, 1 + ( x + y ) % 3 );
+        }
+    }
+    g->m.ter_set( tripoint( 64, 64, 0 ), t_utility_light );
+    g->u.setpos( tripoint( 60, 60, 0 ) );
+}
+
+static std::unique_ptr<level_cache> build_lighting( const int threads )
+{
+    const int old_threads = worker_threads;
+    worker_threads = threads;
+    g->m.access_cache( 0 ).light_contributions.clear();
+    g->m.build_map_cache( 0 );
+    worker_threads = old_threads;
+    return std::unique_ptr<level_cache>( new level_cache( g->m.get_cache_ref( 0 ) ) );
+}
+
+TEST_CASE( "threaded_lighting_matches_serial" )
+{
+    build_lit_test_map();
+
+    const auto serial = build_lighting( 1 );
+    const auto threaded = build_lighting( 4 );
+    CHECK( threaded->lights_cast == serial->lights_cast );
+    CHECK( lightmaps_equal( *serial, *threaded ) );
+    const int tiles = MAPSIZE * SEEX * MAPSIZE * SEEY;
+    CHECK( std::equal( &serial->seen_cache[0][0], &serial->seen_cache[0][0] + tiles,
+                       &threaded->seen_cache[0][0] ) );
+    remove_fires();
+}
+
+TEST_CASE( "threaded_lighting_performance", "[.]" )
+{
+    build_lit_test_map();
+    const int iterations = 50;
+    for( int threads : { 1, 2, 4, 8 } ) {
+        const auto start = std::chrono::high_resolution_clock::now();
+        for( int i = 0; i < iterations; i++ ) {
+            build_lighting( threads );
+        }
+        const auto end = std::chrono::high_resolution_clock::now();
+        const long duration = std::chrono::duration_cast<std::chrono::microseconds>( end - start ).count();
+        printf( "%d build_map_cache calls with %d lighting threads took %ld us\n", iterations, threads,
+                duration );
+    }
+    remove_fires();
+}
@@ -1,11 +1,18 @@
 #include "catch/catch.hpp"
 
+#include "field.h"
 #include "game.h"
 #include "map.h"
+#include "mapdata.h"
+#include "monster.h"
 #include "player.h"
 
 #include "map_helpers.h"
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 TEST_CASE( "destroy_grabbed_furniture" )
 {
     clear_map();
@@ -25,3 +32,121 @@ TEST_CASE( "destroy_grabbed_furniture" )
         }
     }
 }
+
+static std::unique_ptr<level_cache> rebuild_map_cache()
+{
+    g->m.build_map_cache( 0, true );
+    return std::unique_ptr<level_cache>( new level_cache( g->m.get_cache_ref( 0 ) ) );
+}
+
+TEST_CASE( "map_caches_rebuild_changed_submaps_only" )
+{
+    clear_map();
+    rebuild_map_cache();
+
+    get_map_cache_stats() = map_cache_stats();
+    rebuild_map_cache();
+    CHECK( get_map_cache_stats().transparency_submaps == 0 );
+    CHECK( get_map_cache_stats().outside_submaps == 0 );
+    CHECK( get_map_cache_stats().floor_submaps == 0 );
+
+    // A wall in the middle of a submap
+    g->m.ter_set( tripoint( 30, 30, 0 ), t_wall );
+    // An indoor tile in the corner of a submap makes the tiles around it indoors,
+    // so the three submaps touching that corner need rebuilding as well
+    g->m.ter_set( tripoint( 5 * SEEX - 1, 5 * SEEY - 1, 0 ), t_floor );
+    g->m.ter_set( tripoint( 80, 100, 0 ), t_open_air );
+    get_map_cache_stats() = map_cache_stats();
+    const auto incremental = rebuild_map_cache();
+    CHECK( get_map_cache_stats().outside_submaps == 4 );
+    // The changed outside submaps are rebuilt for transparency too, the wall adds one more
+    CHECK( get_map_cache_stats().transparency_submaps == 5 );
+    CHECK( get_map_cache_stats().floor_submaps == 1 );
+    CHECK_FALSE( incremental->outside_cache[5 * SEEX][5 * SEEY] );
+
+    g->m.set_transparency_cache_dirty( 0 );
+    g->m.set_outside_cache_dirty( 0 );
+    g->m.set_floor_cache_dirty( 0 );
+    const auto full = rebuild_map_cache();
+    const int tiles = MAPSIZE * SEEX * MAPSIZE * SEEY;
+    CHECK( std::equal( &full->transparency_cache[0][0], &full->transparency_cache[0][0] + tiles,
+                       &incremental->transparency_cache[0][0] ) );
+    CHECK( std::equal( &full->outside_cache[0][0], &full->outside_cache[0][0] + tiles,
+                       &incremental->outside_cache[0][0] ) );
+    CHECK( std::equal( &full->floor_cache[0][0], &full->floor_cache[0][0] + tiles,
+                       &incremental->floor_cache[0][0] ) );
+}
+
+TEST_CASE( "fields_on_all_tiles_are_processed" )
+{
+    clear_map();
+    // Several tiles in one submap column, one at the last tile of a submap
+    const std::vector<tripoint> spots = { { 36, 36, 0 }, { 36, 40, 0 }, { 36, 47, 0 }, { 47, 47, 0 }, { 50, 38, 0 } };
+    for( const tripoint &p : spots ) {
+        g->m.add_field( p, fd_smoke, 1, 1 );
+    }
+    // Removed again before processing
+    g->m.add_field( tripoint( 40, 40, 0 ), fd_smoke, 1, 1 );
+    g->m.remove_field( tripoint( 40, 40, 0 ), fd_smoke );
+
+    int turns = 0;
+    const auto smoke_left = [&]() {
+        return std::count_if( spots.begin(), spots.end(), []( const tripoint & p ) {
+            return g->m.get_field( p, fd_smoke ) != nullptr;
+        } );
+    };
+    while( smoke_left() > 0 && turns < 1000 ) {
+        g->m.process_fields();
+        turns++;
+    }
+    CHECK( smoke_left() == 0 );
+    CHECK( turns < 1000 );
+    CHECK( g->m.get_field( tripoint( 40, 40, 0 ), fd_smoke ) == nullptr );
+}
+
+TEST_CASE( "remembered_lines_of_sight_follow_map_changes" )
+{
+    clear_map();
+    g->m.build_map_cache( 0, true );
+    const tripoint from( 60, 60, 0 );
+    const tripoint to( 66, 60, 0 );
+    const tripoint between( 63, 60, 0 );
+
+    REQUIRE( g->m.sees( from, to, 60 ) );
+    // Asking again is answered from the memo
+    CHECK( g->m.sees( from, to, 60 ) );
+    CHECK_FALSE( g->m.sees( from, to, 3 ) );
+
+    g->m.ter_set( between, t_wall );
+    g->m.build_map_cache( 0, true );
+    CHECK_FALSE( g->m.sees( from, to, 60 ) );
+
+    g->m.ter_set( between, t_floor );
+    g->m.build_map_cache( 0, true );
+    CHECK( g->m.sees( from, to, 60 ) );
+}
+
+TEST_CASE( "vision_field_matches_the_players_field_of_vision" )
+{
+    clear_map();
+    const tripoint spot( 58, 60, 0 );
+    for( int y = 55; y <= 65; y++ ) {
+        g->m.ter_set( tripoint( 63, y, 0 ), t_wall );
+    }
+    g->u.setpos( spot );
+    g->m.build_map_cache( 0, true );
+    const int range = 10;
+    // Read from the seen cache
+    const std::vector<tripoint> seen_by_player = g->u.vision_field( range );
+
+    g->u.setpos( spot + tripoint( 0, 20, 0 ) );
+    g->m.build_map_cache( 0, true );
+    monster &watcher = spawn_test_monster( "mon_zombie", spot );
+    // Cast for the monster alone
+    const std::vector<tripoint> field = watcher.vision_field( range );
+    CHECK( field == seen_by_player );
+    CHECK( field.size() > 100 );
+    CHECK( std::find( field.begin(), field.end(), spot + tripoint( 4, 0, 0 ) ) != field.end() );
+    // Nothing behind the wall
+    CHECK( std::find( field.begin(), field.end(), tripoint( 65, 60, 0 ) ) == field.end() );
+}
@@ -1,22 +1,30 @@
 #include "catch/catch.hpp"
 
+#include "calendar.h"
 #include "creature.h"
 #include "creature_tracker.h"
 #include "game.h"
+#include "line.h"
 #include "map.h"
 #include "mapdata.h"
+#include "monfaction.h"
 #include "monster.h"
 #include "mtype.h"
 #include "options.h"
 #include "player.h"
 #include "vehicle.h"
+#include "worker_pool.h"
 
 #include "map_helpers.h"
 #include "test_statistics.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <tuple>
 #include <vector>
 
 static int moves_to_destination( const std::string &monster_type,
@@ -330,3 +338,235 @@ TEST_CASE( "monster_speed_trig", "[speed]" )
     trigdist = true;
     monster_check();
 }
+
+TEST_CASE( "creature_tracker_finds_monsters_by_location" )
+{
+    Creature_tracker tracker;
+    const tripoint a( 10, 10, 0 );
+    const tripoint b( 11, 10, 0 );
+    const tripoint below( 20, 30, -3 );
+    // Outside of the reality bubble
+    const tripoint outside( -5, 200, 0 );
+    for( const tripoint &p : { a, below, outside } ) {
+        monster critter( mtype_id( "mon_zombie" ), p );
+        REQUIRE( tracker.add( critter ) );
+    }
+    CHECK( tracker.size() == 3 );
+    const std::shared_ptr<monster> first = tracker.find( a );
+    REQUIRE( first );
+    CHECK( first->pos() == a );
+    CHECK( tracker.find( below )->pos() == below );
+    CHECK( tracker.find( outside )->pos() == outside );
+    CHECK_FALSE( tracker.find( b ) );
+
+    REQUIRE( tracker.update_pos( *first, b ) );
+    first->spawn( b );
+    CHECK_FALSE( tracker.find( a ) );
+    CHECK( tracker.find( b ) == first );
+
+    const std::shared_ptr<monster> second = tracker.find( below );
+    tracker.swap_positions( *first, *second );
+    CHECK( tracker.find( below ) == first );
+    CHECK( tracker.find( b ) == second );
+
+    // Monsters moved by shifting the map are found again after rebuilding the cache
+    second->spawn( outside + tripoint( 1, 0, 0 ) );
+    tracker.rebuild_cache();
+    CHECK_FALSE( tracker.find( b ) );
+    CHECK( tracker.find( outside + tripoint( 1, 0, 0 ) ) == second );
+
+    tracker.remove( *first );
+    CHECK_FALSE( tracker.find( below ) );
+    CHECK( tracker.size() == 2 );
+    // Dead monsters are ignored
+    tracker.find( outside )->set_hp( 0 );
+    CHECK_FALSE( tracker.find( outside ) );
+    tracker.remove_dead();
+    CHECK( tracker.size() == 1 );
+    tracker.clear();
+    CHECK( tracker.size() == 0 );
+    CHECK_FALSE( tracker.find( outside + tripoint( 1, 0, 0 ) ) );
+}
+
+TEST_CASE( "creature_tracker_visits_nearby_monsters_nearest_first" )
+{
+    Creature_tracker tracker;
+    std::vector<tripoint> spots;
+    for( int x = 3; x < MAPSIZE * SEEX; x += 7 ) {
+        for( int y = 5; y < MAPSIZE * SEEY; y += 9 ) {
+            spots.emplace_back( x, y, ( x + y ) % 3 == 0 ? 1 : 0 );
+        }
+    }
+    for( const tripoint &p : spots ) {
+        monster critter( mtype_id( "mon_zombie" ), p );
+        REQUIRE( tracker.add( critter ) );
+    }
+
+    for( const tripoint &center : { tripoint( 60, 60, 0 ), tripoint( 0, 5, 0 ), tripoint( 131, 100, 1 ) } ) {
+        for( const int range : { 1, 10, 30, 200 } ) {
+            std::vector<tripoint> visited;
+            int last_min_dist = 0;
+            tracker.visit_nearby( center, range, [&]( monster & critter, const int min_dist ) {
+                CHECK( min_dist >= last_min_dist );
+                CHECK( square_dist( center.x, center.y, critter.posx(), critter.posy() ) >= min_dist );
+                last_min_dist = min_dist;
+                visited.push_back( critter.pos() );
+                return true;
+            } );
+            std::vector<tripoint> expected;
+            for( const tripoint &p : spots ) {
+                if( square_dist( center.x, center.y, p.x, p.y ) <= range ) {
+                    expected.push_back( p );
+                }
+            }
+            std::sort( visited.begin(), visited.end() );
+            std::sort( expected.begin(), expected.end() );
+            CHECK( visited == expected );
+        }
+    }
+
+    // Stops when asked to
+    int visits = 0;
+    tracker.visit_nearby( tripoint( 60, 60, 0 ), 200, [&]( monster &, int ) {
+        visits++;
+        return false;
+    } );
+    CHECK( visits == 1 );
+}
+
+// A mixed faction fight, every fourth monster is a pet.
+static std::vector<monster *> spawn_melee( const int count, const int spacing = 3 )
+{
+    clear_map();
+    static const std::vector<std::string> types = { "mon_zombie", "mon_triffid", "mon_fungaloid", "mon_dog" };
+    const int columns = 90 / spacing;
+    std::vector<monster *> horde;
+    for( int i = 0; i < count; i++ ) {
+        const tripoint p( 20 + ( i % columns ) * spacing, 20 + ( i / columns ) * spacing, 0 );
+        monster &critter = spawn_test_monster( types[i % types.size()], p );
+        critter.anger = 100;
+        if( i % 4 == 0 ) {
+            critter.friendly = -1;
+        }
+        horde.push_back( &critter );
+    }
+    return horde;
+}
+
+static mfactions factions_of( const std::vector<monster *> &horde )
+{
+    mfactions factions;
+    for( monster *critter : horde ) {
+        factions[critter->friendly == 0 ? critter->faction : mfaction_str_id( "player" )].insert( critter );
+    }
+    return factions;
+}
+
+static std::vector<monster_plan> plan_all( const std::vector<monster *> &horde, const mfactions &factions,
+        const int threads )
+{
+    std::vector<monster_plan> plans( horde.size() );
+    worker_pool workers( threads );
+    workers.run( horde.size(), [&]( const int index, int ) {
+        plans[index] = horde[index]->compute_plan( factions );
+    } );
+    return plans;
+}
+
+// Position, hp, anger and morale
+typedef std::tuple<tripoint, int, int, int> monster_state;
+
+// A few turns of the monsters closing in on each other, they plan ahead of their moves on
+// the given number of threads. They start too far apart to come to blows, melee hit rolls
+// don't come from the seeded rng.
+static std::vector<monster_state> close_in( const int threads )
+{
+    srand( 2718 );
+    const std::vector<monster *> horde = spawn_melee( 25, 18 );
+    std::vector<tripoint> start;
+    for( const monster *critter : horde ) {
+        start.push_back( critter->pos() );
+    }
+    // Noon of a day to come, no flow field of an earlier turn is reused and light is the same
+    const int first_turn = ( int( calendar::turn ) / DAYS( 1 ) + 1 ) * DAYS( 1 ) + HOURS( 12 );
+    worker_threads = threads;
+    for( int turn = 0; turn < 5; turn++ ) {
+        calendar::turn = first_turn + turn;
+        for( monster &critter : g->all_monsters() ) {
+            critter.moves = critter.get_speed();
+        }
+        g->monmove();
+    }
+    worker_threads = 1;
+
+    std::vector<monster_state> result;
+    int moved = 0;
+    for( const monster &critter : g->all_monsters() ) {
+        moved += std::find( start.begin(), start.end(), critter.pos() ) == start.end();
+        result.emplace_back( critter.pos(), critter.get_hp(), critter.anger, critter.morale );
+    }
+    CHECK( moved > 0 );
+    clear_creatures();
+    return result;
+}
+
+TEST_CASE( "monster_plans_do_not_depend_on_threads" )
+{
+    const std::vector<monster *> horde = spawn_melee( 240 );
+    const mfactions factions = factions_of( horde );
+    const std::vector<monster_plan> serial = plan_all( horde, factions, 1 );
+    int targets = 0;
+    for( const int threads : { 2, 3, 8 } ) {
+        const std::vector<monster_plan> threaded = plan_all( horde, factions, threads );
+        for( size_t i = 0; i < horde.size(); i++ ) {
+            CHECK( threaded[i].target == serial[i].target );
+            CHECK( threaded[i].approach_target == serial[i].approach_target );
+            CHECK( threaded[i].flee_target == serial[i].flee_target );
+            CHECK( threaded[i].follows_player == serial[i].follows_player );
+            CHECK( threaded[i].crowded == serial[i].crowded );
+            CHECK( threaded[i].crowded_by == serial[i].crowded_by );
+            CHECK( threaded[i].anger_change == serial[i].anger_change );
+            CHECK( threaded[i].morale_change == serial[i].morale_change );
+            // Planning alone doesn't change the monster
+            CHECK( horde[i]->anger == 100 );
+        }
+    }
+    for( const monster_plan &plan : serial ) {
+        targets += plan.target != nullptr;
+    }
+    CHECK( targets > 0 );
+
+    // Acting on the plan is the same as planning on the spot
+    monster &pet = *horde[0];
+    const monster_plan plan = pet.compute_plan( factions );
+    REQUIRE( plan.target != nullptr );
+    pet.apply_plan( plan );
+    const tripoint planned_dest = pet.move_target();
+    pet.unset_dest();
+    pet.plan( factions );
+    CHECK( pet.move_target() == planned_dest );
+    clear_creatures();
+
+    // Whole turns come out the same on any number of threads planning ahead
+    const std::vector<monster_state> two_threads = close_in( 2 );
+    CHECK( close_in( 3 ) == two_threads );
+    CHECK( close_in( 8 ) == two_threads );
+}
+
+TEST_CASE( "monster_planning_performance", "[.]" )
+{
+    const std::vector<monster *> horde = spawn_melee( 400 );
+    const mfactions factions = factions_of( horde );
+    for( const int threads : { 1, 2, 4 } ) {
+        const int turns = 20;
+        const auto start = std::chrono::high_resolution_clock::now();
+        for( int turn = 0; turn < turns; turn++ ) {
+            plan_all( horde, factions, threads );
+        }
+        const auto end = std::chrono::high_resolution_clock::now();
+        const long duration = std::chrono::duration_cast<std::chrono::microseconds>( end - start ).count();
+        printf( "%d turns of planning for %d monsters on %d threads took %ld us\n", turns,
+                static_cast<int>( horde.size() ), threads, duration );
+    }
+    clear_creatures();
+}
@@ -1,8 +1,19 @@
 #include "catch/catch.hpp"
 
+#include "game.h"
+#include "line.h"
 #include "map.h"
+#include "mongroup.h"
+#include "options.h"
 #include "overmap.h"
+#include "overmap_connection.h"
 #include "overmapbuffer.h"
+#include "simple_pathfinding.h"
+
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
 
 TEST_CASE( "set_and_get_overmap_scents" )
 {
@@ -45,3 +56,234 @@ TEST_CASE( "default_overmap_generation_always_succeeds" )
         }
     }
 }
+
+TEST_CASE( "overmap_connection_graph_skips_unbranched_roads" )
+{
+    std::unique_ptr<overmap> test_overmap = std::unique_ptr<overmap>( new overmap( 0, 0 ) );
+    const overmap_connection &connection = string_id<overmap_connection>( "local_road" ).obj();
+    const oter_id road( "road_ns" );
+
+    // A T-junction: a road from west to east with a branch going north
+    for( int x = 10; x <= 90; x++ ) {
+        test_overmap->ter( x, 50, 0 ) = road;
+    }
+    for( int y = 20; y < 50; y++ ) {
+        test_overmap->ter( 50, y, 0 ) = road;
+    }
+
+    const auto &graph = test_overmap->get_connection_graph( connection, 0 );
+    REQUIRE( graph.nodes.size() == 4 );
+    const auto &junction = graph.nodes[graph.node_at.at( point( 50, 50 ) )];
+    REQUIRE( junction.edges.size() == 3 );
+    int total_length = 0;
+    for( const auto &e : junction.edges ) {
+        total_length += e.length;
+    }
+    CHECK( total_length == 40 + 40 + 30 );
+
+    WHEN( "the road gets cut" ) {
+        test_overmap->ter( 70, 50, 0 ) = oter_id( "field" );
+        test_overmap->clear_connection_graphs();
+        THEN( "the graph is rebuilt" ) {
+            const auto &cut_graph = test_overmap->get_connection_graph( connection, 0 );
+            CHECK( cut_graph.nodes.size() == 6 );
+            CHECK( cut_graph.node_at.count( point( 69, 50 ) ) == 1 );
+        }
+    }
+}
+
+TEST_CASE( "connection_route_crosses_overmaps" )
+{
+    const overmap_connection &connection = string_id<overmap_connection>( "local_road" ).obj();
+    const oter_id road( "road_ew" );
+    // Along the border between two overmaps far from everything else
+    const int base_x = 51 * OMAPX;
+    const int base_y = 50 * OMAPY;
+    for( int x = base_x - 30; x < base_x + 30; x++ ) {
+        for( int y = base_y + 40; y <= base_y + 60; y++ ) {
+            overmap_buffer.ter( x, y, 0 ) = oter_id( "field" );
+        }
+    }
+    for( int x = base_x - 20; x <= base_x + 20; x++ ) {
+        overmap_buffer.ter( x, base_y + 50, 0 ) = road;
+    }
+    for( int y = base_y + 44; y < base_y + 50; y++ ) {
+        overmap_buffer.ter( base_x - 10, y, 0 ) = road;
+    }
+
+    const tripoint branch_end( base_x - 10, base_y + 44, 0 );
+    const tripoint dest( base_x + 15, base_y + 50, 0 );
+    for( const tripoint &source : {
+             tripoint( base_x - 15, base_y + 50, 0 ), branch_end
+         } ) {
+        const auto route = overmap_buffer.find_connection_route( connection, source, dest, OMAPX );
+        REQUIRE( !route.empty() );
+        CHECK( route.front() == source );
+        CHECK( route.back() == dest );
+        CHECK( route.size() == static_cast<size_t>( std::abs( dest.x - source.x ) +
+                                                   std::abs( dest.y - source.y ) + 1 ) );
+        for( size_t i = 1; i < route.size(); i++ ) {
+            CHECK( square_dist( route[i - 1], route[i] ) == 1 );
+            CHECK( connection.has( overmap_buffer.get_ter( route[i] ) ) );
+        }
+    }
+
+    CHECK( overmap_buffer.find_connection_route( connection, branch_end,
+            tripoint( base_x + 25, base_y + 50, 0 ), OMAPX ).empty() );
+}
+
+// Roads are laid out with find_path, the way it breaks ties between equally good paths
+// decides the road layout of a world seed. Changing it changes the roads of existing seeds.
+TEST_CASE( "find_path_breaks_ties_in_the_same_way" )
+{
+    const point source( 1, 1 );
+    const point dest( 4, 3 );
+    const pf::path path = pf::find_path( source, dest, 8, 8, [&]( const pf::node & cur,
+    const pf::node * ) {
+        return std::abs( dest.x - cur.x ) + std::abs( dest.y - cur.y );
+    } );
+    std::vector<point> steps;
+    for( const pf::node &n : path.nodes ) {
+        steps.emplace_back( n.x, n.y );
+    }
+    // From the destination back to the source, along the first direction that was tried
+    const std::vector<point> expected = {
+        point( 4, 3 ), point( 4, 2 ), point( 4, 1 ), point( 3, 1 ), point( 2, 1 ), point( 1, 1 )
+    };
+    CHECK( steps == expected );
+}
+
+TEST_CASE( "connection_route_gives_up_on_loops_without_nodes" )
+{
+    const overmap_connection &connection = string_id<overmap_connection>( "local_road" ).obj();
+    const oter_id road( "road_ew" );
+    const int base_x = 60 * OMAPX;
+    const int base_y = 50 * OMAPY;
+    for( int x = base_x; x < base_x + 30; x++ ) {
+        for( int y = base_y; y < base_y + 30; y++ ) {
+            overmap_buffer.ter( x, y, 0 ) = oter_id( "field" );
+        }
+    }
+    // A ring road and a 2x2 block of roads, neither of them has a branch
+    for( int i = 10; i <= 14; i++ ) {
+        overmap_buffer.ter( base_x + i, base_y + 10, 0 ) = road;
+        overmap_buffer.ter( base_x + i, base_y + 14, 0 ) = road;
+        overmap_buffer.ter( base_x + 10, base_y + i, 0 ) = road;
+        overmap_buffer.ter( base_x + 14, base_y + i, 0 ) = road;
+    }
+    for( int x = 20; x <= 21; x++ ) {
+        for( int y = 20; y <= 21; y++ ) {
+            overmap_buffer.ter( base_x + x, base_y + y, 0 ) = road;
+        }
+    }
+    // A separate road to head for
+    for( int x = 5; x <= 25; x++ ) {
+        overmap_buffer.ter( base_x + x, base_y + 25, 0 ) = road;
+    }
+
+    const tripoint elsewhere( base_x + 15, base_y + 25, 0 );
+    const tripoint on_ring( base_x + 12, base_y + 10, 0 );
+    const tripoint on_block( base_x + 20, base_y + 20, 0 );
+    CHECK( overmap_buffer.find_connection_route( connection, on_ring, elsewhere, OMAPX ).empty() );
+    CHECK( overmap_buffer.find_connection_route( connection, elsewhere, on_ring, OMAPX ).empty() );
+    CHECK( overmap_buffer.find_connection_route( connection, on_block, elsewhere, OMAPX ).empty() );
+
+    const auto around = overmap_buffer.find_connection_route( connection, on_ring,
+                        tripoint( base_x + 14, base_y + 12, 0 ), OMAPX );
+    CHECK( around.size() == 5 );
+}
+
+static std::string serialized( const overmap &om )
+{
+    std::ostringstream out;
+    om.serialize( out );
+    return out.str();
+}
+
+static std::vector<std::string> move_hordes_of( const std::vector<std::string> &saved,
+        const int threads )
+{
+    std::vector<std::unique_ptr<overmap>> overmaps;
+    std::vector<overmap *> moved;
+    for( size_t i = 0; i < saved.size(); i++ ) {
+        overmaps.emplace_back( new overmap( 40 + i, 40 ) );
+        std::istringstream in( saved[i] );
+        overmaps.back()->unserialize( in );
+        moved.push_back( overmaps.back().get() );
+    }
+
+    worker_threads = threads;
+    srand( 4321 );
+    for( int tick = 0; tick < 50; tick++ ) {
+        overmap::move_hordes( moved );
+    }
+    worker_threads = 1;
+
+    std::vector<std::string> result;
+    for( const overmap *om : moved ) {
+        result.push_back( serialized( *om ) );
+    }
+    return result;
+}
+
+TEST_CASE( "horde_moves_do_not_depend_on_worker_threads" )
+{
+    auto &wander_spawns = get_options().get_option( "WANDER_SPAWNS" );
+    const std::string old_wander_spawns = wander_spawns.getValue();
+    wander_spawns.setValue( "true" );
+    std::vector<std::string> saved;
+    for( int i = 0; i < 2; i++ ) {
+        overmap om( 40 + i, 40 );
+        overmap_special_batch specials = overmap_specials::get_default_batch( point( 40 + i, 40 ) );
+        om.populate( specials );
+        saved.push_back( serialized( om ) );
+    }
+    wander_spawns.setValue( old_wander_spawns );
+
+    const std::vector<std::string> serial = move_hordes_of( saved, 1 );
+    const std::vector<std::string> threaded = move_hordes_of( saved, 4 );
+    CHECK( serial != saved );
+    CHECK( threaded == serial );
+}
+
+TEST_CASE( "signal_hordes_reaches_hordes_in_range" )
+{
+    overmap_buffer.get( 0, 0 );
+    std::vector<mongroup *> groups;
+    for( int x = 0; x < 2 * OMAPX; x++ ) {
+        for( int y = 0; y < 2 * OMAPY; y++ ) {
+            for( mongroup *mg : overmap_buffer.groups_at( x, y, 0 ) ) {
+                if( !mg->horde ) {
+                    groups.push_back( mg );
+                }
+            }
+        }
+    }
+    REQUIRE( groups.size() > 1 );
+
+    // Turn the groups into hordes that will follow any signal
+    std::vector<std::pair<int, tripoint>> originals;
+    const tripoint far_away( -1000, -1000, 0 );
+    for( mongroup *mg : groups ) {
+        originals.emplace_back( mg->interest, mg->target );
+        mg->horde = true;
+        mg->interest = 15;
+        mg->target = far_away;
+    }
+    const tripoint center = groups.front()->pos;
+    const int sig_power = 20;
+    overmap_buffer.signal_hordes( center, sig_power );
+
+    for( size_t i = 0; i < groups.size(); i++ ) {
+        mongroup &mg = *groups[i];
+        INFO( "horde at " << mg.pos.x << "," << mg.pos.y );
+        if( rl_dist( center, mg.pos ) <= sig_power ) {
+            CHECK( mg.target == center );
+        } else {
+            CHECK( mg.target == far_away );
+        }
+        mg.horde = false;
+        mg.interest = originals[i].first;
+        mg.target = originals[i].second;
+    }
+}
@@ -0,0 +1,367 @@
+#include "catch/catch.hpp"
+
+#include "game.h"
+#include "line.h"
+#include "map.h"
+#include "mapdata.h"
+#include "monster.h"
+#include "mtype.h"
+#include "options.h"
+#include "pathfinding.h"
+
+#include "map_helpers.h"
+
+#include <chrono>
+#include <cstdio>
+
+// Vertical walls across the whole map with a single gap alternating between the top
+// and the bottom, so that crossing the map means walking a long zig-zag.
+static void build_zigzag_walls()
+{
+    clear_map();
+    const int mapsize = g->m.getmapsize() * SEEX;
+    bool gap_on_top = true;
+    for( int x = 10; x < mapsize - 10; x += 10 ) {
+        for( int y = 0; y < mapsize; y++ ) {
+            const bool gap = gap_on_top ? y < 3 : y >= mapsize - 3;
+            if( !gap ) {
+                g->m.ter_set( tripoint( x, y, 0 ), t_wall );
+            }
+        }
+        gap_on_top = !gap_on_top;
+    }
+    g->m.build_map_cache( 0, true );
+}
+
+static pathfinding_settings test_settings( bool hierarchical )
+{
+    pathfinding_settings settings( 0, 1000, 10000, 0, false, false, true );
+    settings.allow_hierarchical = hierarchical;
+    return settings;
+}
+
+static void check_route( const std::vector<tripoint> &route, const tripoint &from,
+                         const tripoint &to )
+{
+    REQUIRE( !route.empty() );
+    CHECK( route.back() == to );
+    tripoint prev = from;
+    for( const tripoint &p : route ) {
+        CHECK( rl_dist( prev, p ) == 1 );
+        CHECK( g->m.passable( p ) );
+        prev = p;
+    }
+}
+
+TEST_CASE( "hierarchical_route_crosses_zigzag_walls", "[pathfinding]" )
+{
+    build_zigzag_walls();
+    const int mapsize = g->m.getmapsize() * SEEX;
+    const tripoint from( 2, mapsize - 2, 0 );
+    const tripoint to( mapsize - 2, 2, 0 );
+
+    const auto exact = g->m.route( from, to, test_settings( false ) );
+    const auto coarse = g->m.route( from, to, test_settings( true ) );
+    check_route( exact, from, to );
+    check_route( coarse, from, to );
+    // Portals sit in the middle of the openings, detours are short
+    CHECK( coarse.size() <= exact.size() * 5 / 4 );
+
+    WHEN( "a wall is removed" ) {
+        const tripoint shortcut( 10, mapsize / 2, 0 );
+        g->m.ter_set( shortcut, t_floor );
+        const auto after = g->m.route( from, to, test_settings( true ) );
+        THEN( "the portal graph is updated" ) {
+            check_route( after, from, to );
+            CHECK( std::find( after.begin(), after.end(), shortcut ) != after.end() );
+        }
+    }
+}
+
+// Walking cost of a route without obstacles to bash or climb, as counted by the pathfinder
+static int route_cost( const std::vector<tripoint> &route, const tripoint &from )
+{
+    int cost = 0;
+    tripoint prev = from;
+    for( const tripoint &p : route ) {
+        cost += ( ( prev.x != p.x && prev.y != p.y ) ? 1 : 0 ) + g->m.move_cost( p );
+        prev = p;
+    }
+    return cost;
+}
+
+TEST_CASE( "shared_route_matches_exact_route", "[pathfinding]" )
+{
+    build_zigzag_walls();
+    const int mapsize = g->m.getmapsize() * SEEX;
+    const tripoint to( mapsize - 2, 2, 0 );
+    const auto settings = test_settings( false );
+
+    // Keep the origins far enough for the exact search box to include all the detours
+    for( const tripoint &from : {
+             tripoint( 2, mapsize - 2, 0 ), tripoint( 35, mapsize - 2, 0 ), tripoint( mapsize / 2, mapsize - 5, 0 )
+         } ) {
+        const auto exact = g->m.route( from, to, settings );
+        const auto shared = g->m.route_shared( from, to, settings );
+        check_route( exact, from, to );
+        check_route( shared, from, to );
+        CHECK( route_cost( shared, from ) == route_cost( exact, from ) );
+    }
+}
+
+TEST_CASE( "flow_fields_are_rebuilt_at_most_once_per_turn", "[pathfinding]" )
+{
+    build_zigzag_walls();
+    const int mapsize = g->m.getmapsize() * SEEX;
+    const tripoint from( 2, mapsize - 2, 0 );
+    const tripoint to( mapsize - 2, 2, 0 );
+    const auto settings = test_settings( false );
+    const int turn = calendar::turn;
+
+    // Other cases may have built a field toward the same target this turn
+    calendar::turn = turn + 1;
+    get_pathfinding_stats() = pathfinding_stats();
+    check_route( g->m.route_shared( from, to, settings ), from, to );
+    CHECK( get_pathfinding_stats().flow_fields_built == 1 );
+
+    // Like a bashed down door, the field goes out of date
+    g->m.ter_set( tripoint( 5, 5, 0 ), t_dirt );
+    check_route( g->m.route_shared( from, to, settings ), from, to );
+    CHECK( get_pathfinding_stats().flow_fields_built == 1 );
+
+    calendar::turn = turn + 2;
+    check_route( g->m.route_shared( from, to, settings ), from, to );
+    CHECK( get_pathfinding_stats().flow_fields_built == 2 );
+    calendar::turn = turn;
+}
+
+TEST_CASE( "plain_walking_monsters_plan_over_portals", "[pathfinding]" )
+{
+    CHECK( mtype_id( "mon_razorclaw" ).obj().path_settings.allow_hierarchical );
+    // Climbers need the full search to find fences to climb
+    CHECK_FALSE( mtype_id( "mon_tripod" ).obj().path_settings.allow_hierarchical );
+}
+
+TEST_CASE( "hierarchical_route_performance", "[.]" )
+{
+    // A building open toward the monster, the exact search floods it before walking around
+    clear_map();
+    const int mid = g->m.getmapsize() * SEEY / 2;
+    for( int y = mid - 15; y <= mid + 15; y++ ) {
+        g->m.ter_set( tripoint( 40, y, 0 ), t_wall );
+    }
+    for( int x = 20; x < 40; x++ ) {
+        g->m.ter_set( tripoint( x, mid - 15, 0 ), t_wall );
+        g->m.ter_set( tripoint( x, mid + 15, 0 ), t_wall );
+    }
+    g->m.build_map_cache( 0, true );
+    const tripoint from( 10, mid, 0 );
+    const tripoint to( 55, mid, 0 );
+    const int iterations = 1000;
+
+    // Same call as monster::move makes
+    const monster &razorclaw = spawn_test_monster( "mon_razorclaw", from );
+    for( const bool hierarchical : { false, true } ) {
+        auto settings = razorclaw.get_pathfinding_settings();
+        settings.allow_hierarchical = hierarchical;
+        get_pathfinding_stats() = pathfinding_stats();
+        size_t length = 0;
+        const auto start = std::chrono::high_resolution_clock::now();
+        for( int i = 0; i < iterations; i++ ) {
+            length = g->m.route( razorclaw.pos(), to, settings, razorclaw.get_path_avoid() ).size();
+        }
+        const auto end = std::chrono::high_resolution_clock::now();
+        const long diff = std::chrono::duration_cast<std::chrono::microseconds>( end - start ).count();
+        const auto &stats = get_pathfinding_stats();
+        printf( "%s route() executed %d times in %ld microseconds, path length %d.\n",
+                hierarchical ? "Hierarchical" : "Exact", iterations, diff, static_cast<int>( length ) );
+        printf( "Expanded %ld tiles and %ld portals per route.\n",
+                stats.expanded_tiles / iterations, stats.expanded_portals / iterations );
+    }
+}
+
+TEST_CASE( "route_reuses_pathfinder_state", "[pathfinding]" )
+{
+    build_zigzag_walls();
+    const int mapsize = g->m.getmapsize() * SEEX;
+    const tripoint from( 2, mapsize - 2, 0 );
+    const tripoint to( mapsize - 2, 2, 0 );
+    const auto settings = test_settings( false );
+
+    const auto first = g->m.route( from, to, settings );
+    get_pathfinding_stats() = pathfinding_stats();
+    const auto second = g->m.route( from, to, settings );
+    CHECK( get_pathfinding_stats().arena_allocations == 0 );
+    CHECK( route_cost( first, from ) == route_cost( second, from ) );
+}
+
+TEST_CASE( "pathfinder_arena_performance", "[.]" )
+{
+    build_zigzag_walls();
+    const tripoint from( 5, 5, 0 );
+    const tripoint to( 35, 25, 0 );
+    const auto settings = test_settings( false );
+    const int iterations = 10000;
+
+    // Warm up the per-thread search state first
+    g->m.route( from, to, settings );
+    get_pathfinding_stats() = pathfinding_stats();
+    const auto start = std::chrono::high_resolution_clock::now();
+    for( int i = 0; i < iterations; i++ ) {
+        g->m.route( from, to, settings );
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    const long diff = std::chrono::duration_cast<std::chrono::microseconds>( end - start ).count();
+    printf( "route() executed %d times in %ld microseconds, search state grew %ld times.\n",
+            iterations, diff, get_pathfinding_stats().arena_allocations );
+}
+
+TEST_CASE( "repair_route_follows_moving_goal", "[pathfinding]" )
+{
+    clear_map();
+    const tripoint from( 20, 20, 0 );
+    const tripoint to( 50, 30, 0 );
+    const auto settings = test_settings( false );
+    auto path = g->m.route( from, to, settings );
+    check_route( path, from, to );
+
+    GIVEN( "the goal moved by a few tiles" ) {
+        const tripoint moved( 52, 32, 0 );
+        REQUIRE( g->m.repair_route( path, from, moved, settings ) );
+        check_route( path, from, moved );
+    }
+    GIVEN( "the goal moved back toward the start" ) {
+        const tripoint moved( 47, 29, 0 );
+        REQUIRE( g->m.repair_route( path, from, moved, settings ) );
+        check_route( path, from, moved );
+        CHECK( path.size() <= static_cast<size_t>( rl_dist( from, moved ) + 1 ) );
+    }
+    GIVEN( "a wall was built across the path" ) {
+        const tripoint blocked = path[10];
+        for( int dy = -2; dy <= 2; dy++ ) {
+            g->m.ter_set( blocked + point( 0, dy ), t_wall );
+        }
+        REQUIRE( g->m.repair_route( path, from, to, settings ) );
+        check_route( path, from, to );
+        CHECK( std::find( path.begin(), path.end(), blocked ) == path.end() );
+    }
+    GIVEN( "the goal moved far away" ) {
+        CHECK_FALSE( g->m.repair_route( path, from, tripoint( 80, 80, 0 ), settings ) );
+    }
+}
+
+TEST_CASE( "route_many_matches_separate_routes", "[pathfinding]" )
+{
+    build_zigzag_walls();
+    const int mapsize = g->m.getmapsize() * SEEX;
+    const tripoint to( mapsize - 2, 2, 0 );
+    const auto settings = test_settings( false );
+    const std::vector<tripoint> origins = {
+        tripoint( 2, mapsize - 2, 0 ), tripoint( 35, mapsize - 2, 0 ),
+        tripoint( 36, mapsize - 2, 0 ), tripoint( mapsize / 2, mapsize - 5, 0 ), to
+    };
+    // Like NPCs, avoid walking through each other
+    const std::set<tripoint> avoid( origins.begin(), origins.end() );
+
+    const auto paths = g->m.route_many( origins, to, settings, avoid );
+    REQUIRE( paths.size() == origins.size() );
+    CHECK( paths.back().empty() );
+    for( size_t i = 0; i + 1 < origins.size(); i++ ) {
+        const auto exact = g->m.route( origins[i], to, settings, avoid );
+        check_route( paths[i], origins[i], to );
+        CHECK( route_cost( paths[i], origins[i] ) == route_cost( exact, origins[i] ) );
+        for( const tripoint &p : paths[i] ) {
+            CHECK( ( p == to || avoid.count( p ) == 0 ) );
+        }
+    }
+}
+
+// Open ground with walls and rough terrain scattered over it
+static void build_scattered_obstacles()
+{
+    clear_map();
+    const int mapsize = g->m.getmapsize() * SEEX;
+    for( int x = 0; x < mapsize; x++ ) {
+        for( int y = 0; y < mapsize; y++ ) {
+            if( ( x * 7 + y * 13 ) % 41 == 0 || ( x % 23 == 5 && y % 31 > 8 ) ) {
+                g->m.ter_set( tripoint( x, y, 0 ), t_wall );
+            } else if( ( x * 11 + y * 5 ) % 37 == 0 ) {
+                g->m.ter_set( tripoint( x, y, 0 ), t_underbrush );
+            } else if( ( x * 3 + y * 17 ) % 43 == 0 ) {
+                g->m.ter_set( tripoint( x, y, 0 ), t_dirtmound );
+            }
+        }
+    }
+    g->m.build_map_cache( 0, true );
+}
+
+TEST_CASE( "jump_point_route_matches_plain_route", "[pathfinding]" )
+{
+    // Circular distances make the A* estimate inexact, the costs would only match by luck then
+    get_options().get_option( "CIRCLEDIST" ).setValue( "false" );
+    trigdist = false;
+    build_scattered_obstacles();
+    const int mapsize = g->m.getmapsize() * SEEX;
+    auto plain_settings = test_settings( false );
+    plain_settings.allow_jump_points = false;
+    const auto jump_settings = test_settings( false );
+    const std::set<tripoint> avoid = { tripoint( 30, 31, 0 ), tripoint( 62, 60, 0 ), tripoint( 90, 20, 0 ) };
+
+    for( const std::set<tripoint> &pre_closed : {
+             std::set<tripoint>(), avoid
+         } ) {
+        for( int i = 0; i < 20; i++ ) {
+            const tripoint from( 3 + i * 5, 4 + ( i * 37 ) % ( mapsize - 8 ), 0 );
+            const tripoint to( mapsize - 4 - ( i * 23 ) % ( mapsize - 8 ), 3 + i * 6, 0 );
+            if( !g->m.passable( from ) || !g->m.passable( to ) || pre_closed.count( from ) > 0 ||
+                pre_closed.count( to ) > 0 ) {
+                continue;
+            }
+            const auto plain = g->m.route( from, to, plain_settings, pre_closed );
+            const auto jumped = g->m.route( from, to, jump_settings, pre_closed );
+            REQUIRE( plain.empty() == jumped.empty() );
+            if( plain.empty() ) {
+                continue;
+            }
+            check_route( jumped, from, to );
+            CHECK( route_cost( jumped, from ) == route_cost( plain, from ) );
+            for( const tripoint &p : jumped ) {
+                CHECK( pre_closed.count( p ) == 0 );
+            }
+        }
+    }
+}
+
+TEST_CASE( "jump_point_route_performance", "[.]" )
+{
+    // Open field with a single building in the way
+    clear_map();
+    const int mapsize = g->m.getmapsize() * SEEX;
+    for( int x = 40; x < 90; x++ ) {
+        for( int y = 50; y < 80; y++ ) {
+            if( x == 40 || x == 89 || y == 50 || y == 79 ) {
+                g->m.ter_set( tripoint( x, y, 0 ), t_wall );
+            }
+        }
+    }
+    g->m.build_map_cache( 0, true );
+    const tripoint from( 20, 60, 0 );
+    const tripoint to( mapsize - 20, 70, 0 );
+    const int iterations = 100;
+
+    for( const bool jump_points : { false, true } ) {
+        auto settings = test_settings( false );
+        settings.allow_jump_points = jump_points;
+        get_pathfinding_stats() = pathfinding_stats();
+        size_t length = 0;
+        const auto start = std::chrono::high_resolution_clock::now();
+        for( int i = 0; i < iterations; i++ ) {
+            length = g->m.route( from, to, settings ).size();
+        }
+        const auto end = std::chrono::high_resolution_clock::now();
+        const long diff = std::chrono::duration_cast<std::chrono::microseconds>( end - start ).count();
+        printf( "%s route() executed %d times in %ld microseconds, path length %d.\n",
+                jump_points ? "Jump point" : "Plain", iterations, diff, static_cast<int>( length ) );
+        printf( "Expanded %ld tiles per route.\n", get_pathfinding_stats().expanded_tiles / iterations );
+    }
+}
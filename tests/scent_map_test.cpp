@@ -0,0 +1,124 @@
+#include "catch/catch.hpp"
+
+#include "game.h"
+#include "map.h"
+#include "mapdata.h"
+#include "scent_map.h"
+
+#include "map_helpers.h"
+
+#include <chrono>
+#include <cstdio>
+
+static const tripoint scent_center( 60, 60, 0 );
+
+// Blocks of small rooms with doors, rubble-like half walls in the streets
+// between them and scent everywhere around the center.
+static void build_urban_scent_map( scent_map &scent )
+{
+    clear_map();
+    const ter_id half_wall = ter_str_id( "t_brick_wall_halfway" ).id();
+    for( int x = scent_center.x - 45; x <= scent_center.x + 45; ++x ) {
+        for( int y = scent_center.y - 45; y <= scent_center.y + 45; ++y ) {
+            const tripoint p( x, y, 0 );
+            const int bx = ( x + 100 ) % 7;
+            const int by = ( y + 100 ) % 7;
+            if( bx == 6 || by == 6 ) {
+                if( ( x * 7 + y * 13 ) % 11 == 0 ) {
+                    g->m.ter_set( p, half_wall );
+                }
+            } else if( bx == 0 || by == 0 || bx == 5 || by == 5 ) {
+                g->m.ter_set( p, bx == 2 || by == 2 ? t_door_o : t_wall );
+            } else {
+                g->m.ter_set( p, t_floor );
+            }
+            // A few negative values check the rounding of the divisions
+            scent.set( p, ( x * 31 + y * 17 ) % 500 - 20 );
+        }
+    }
+}
+
+TEST_CASE( "scent_diffusion_kernels_match" )
+{
+    scent_map scalar( *g );
+    build_urban_scent_map( scalar );
+    scent_map vectorized( scalar );
+
+    for( int i = 0; i < 10; i++ ) {
+        // Moving the center keeps the update from being skipped and shifts the window
+        const tripoint center = scent_center + tripoint( i % 3, i % 2, 0 );
+        scalar.update( center, g->m, scent_kernel::scalar );
+        vectorized.update( center, g->m, scent_kernel::vectorized );
+    }
+    int mismatches = 0;
+    int scented = 0;
+    for( int x = 0; x < SEEX * MAPSIZE; ++x ) {
+        for( int y = 0; y < SEEY * MAPSIZE; ++y ) {
+            const tripoint p( x, y, 0 );
+            mismatches += scalar.get( p ) != vectorized.get( p );
+            scented += scalar.get( p ) > 0;
+        }
+    }
+    CHECK( mismatches == 0 );
+    CHECK( scented > 1000 );
+    clear_map();
+}
+
+TEST_CASE( "scent_spreads_from_active_region_only" )
+{
+    clear_map();
+    scent_map sparse( *g );
+    sparse.reset();
+    sparse.set( scent_center, 500 );
+    // Scent outside of the diffused area makes the whole area active
+    scent_map dense( sparse );
+    dense.set( tripoint( 2, 2, 0 ), 1 );
+
+    for( int i = 0; i < 5; i++ ) {
+        sparse.update( scent_center, g->m );
+        dense.update( scent_center, g->m );
+    }
+    const auto region = sparse.active_region();
+    CHECK( region.first.x >= scent_center.x - 5 );
+    CHECK( region.first.y >= scent_center.y - 5 );
+    CHECK( region.second.x <= scent_center.x + 5 );
+    CHECK( region.second.y <= scent_center.y + 5 );
+    CHECK( dense.active_region().first.x == 2 );
+    int mismatches = 0;
+    for( int x = 10; x < SEEX * MAPSIZE; ++x ) {
+        for( int y = 10; y < SEEY * MAPSIZE; ++y ) {
+            const tripoint p( x, y, 0 );
+            mismatches += sparse.get( p ) != dense.get( p );
+        }
+    }
+    CHECK( mismatches == 0 );
+
+    scent_map decaying( *g );
+    decaying.reset();
+    decaying.set( scent_center, 2 );
+    decaying.set( scent_center + tripoint( 3, 0, 0 ), 1 );
+    decaying.decay();
+    CHECK( decaying.active_region().first.x == scent_center.x );
+    CHECK( decaying.active_region().second.x == scent_center.x );
+    decaying.decay();
+    CHECK( decaying.active_region().first.x > decaying.active_region().second.x );
+}
+
+TEST_CASE( "scent_diffusion_performance", "[.]" )
+{
+    scent_map scent( *g );
+    build_urban_scent_map( scent );
+    const int iterations = 1000;
+    for( scent_kernel kernel : { scent_kernel::scalar, scent_kernel::vectorized } ) {
+        scent_map copy( scent );
+        const auto start = std::chrono::high_resolution_clock::now();
+        for( int i = 0; i < iterations; i++ ) {
+            copy.update( scent_center + tripoint( i % 2, 0, 0 ), g->m, kernel );
+        }
+        const auto end = std::chrono::high_resolution_clock::now();
+        const long duration = std::chrono::duration_cast<std::chrono::microseconds>( end - start ).count();
+        printf( "%d %s scent updates took %ld us\n", iterations,
+                kernel == scent_kernel::scalar ? "scalar" : "vectorized", duration );
+    }
+    clear_map();
+}
@@ -0,0 +1,108 @@
+#include "catch/catch.hpp"
+
+#include "game.h"
+#include "line.h"
+#include "monster.h"
+#include "mtype.h"
+#include "sounds.h"
+#include "weather.h"
+
+#include "map_helpers.h"
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+TEST_CASE( "sounds_are_clustered_by_submap" )
+{
+    clear_map();
+    sounds::reset_sounds();
+    // A firefight in one submap and a single shot in another
+    for( int i = 0; i < 200; i++ ) {
+        sounds::sound( tripoint( 5 * SEEX + i % SEEX, 5 * SEEY + i / SEEX % SEEY, 0 ), 20, "" );
+    }
+    sounds::sound( tripoint( 2 * SEEX, 2 * SEEY, 0 ), 20, "" );
+
+    const auto monster_sounds = sounds::get_monster_sounds();
+    CHECK( monster_sounds.first.size() == 201 );
+    REQUIRE( monster_sounds.second.size() == 2 );
+    const auto &centroids = monster_sounds.second;
+    CHECK( std::find( centroids.begin(), centroids.end(),
+                      tripoint( 2 * SEEX, 2 * SEEY, 0 ) ) != centroids.end() );
+    for( const tripoint &centroid : centroids ) {
+        CHECK( centroid.z == 0 );
+    }
+    sounds::reset_sounds();
+}
+
+TEST_CASE( "loudness_field_finds_the_loudest_sound" )
+{
+    clear_map();
+    g->weather = WEATHER_CLEAR;
+    sounds::reset_sounds();
+    const tripoint quiet( 30, 30, 0 );
+    const tripoint loud( 50, 30, 0 );
+    sounds::sound( quiet, 5, "" );
+    sounds::sound( loud, 30, "" );
+    sounds::process_sounds();
+
+    const int weather_vol = weather_data( g->weather ).sound_attn;
+    const sounds::heard_sound next_to_quiet = sounds::loudest_sound_at( quiet + tripoint( 1, 0, 0 ) );
+    CHECK( next_to_quiet.source == loud );
+    CHECK( next_to_quiet.volume == 30 - weather_vol );
+    CHECK( next_to_quiet.distance == rl_dist( loud, quiet + tripoint( 1, 0, 0 ) ) );
+
+    // Out of reach of both sounds
+    const sounds::heard_sound far_away = sounds::loudest_sound_at( tripoint( 120, 120, 0 ) );
+    CHECK( far_away.volume == 0 );
+
+    sounds::reset_sounds();
+    CHECK( sounds::loudest_sound_at( loud ).volume == 0 );
+}
+
+// Anger, morale, wander position and urge to wander of a monster of the given type after
+// hearing the noises for a turn
+static std::tuple<int, int, tripoint, int> hear_noises( const mtype &type,
+        const std::vector<std::pair<tripoint, int>> &noises )
+{
+    sounds::reset_sounds();
+    monster &listener = spawn_test_monster( "mon_bear", tripoint( 60, 60, 0 ) );
+    listener.type = &type;
+    listener.anger = 10;
+    listener.morale = type.morale;
+    for( const auto &noise : noises ) {
+        sounds::sound( noise.first, noise.second, "" );
+    }
+    srand( 42 );
+    sounds::process_sounds();
+    const auto reaction = std::make_tuple( listener.anger, listener.morale, listener.wander_pos,
+                                           listener.wandf );
+    clear_creatures();
+    sounds::reset_sounds();
+    return reaction;
+}
+
+TEST_CASE( "monsters_react_once_to_the_loudest_sound" )
+{
+    clear_map();
+    g->weather = WEATHER_CLEAR;
+    // Sounds anger this bear as well as scaring it
+    mtype angered = mtype_id( "mon_bear" ).obj();
+    angered.anger.insert( MTRIG_SOUND );
+    angered.bitanger.set( MTRIG_SOUND );
+
+    // Both are heard from 20 tiles away, in different submaps
+    const tripoint loud( 80, 60, 0 );
+    const tripoint quiet( 40, 60, 0 );
+    const auto both = hear_noises( angered, { { loud, 60 }, { quiet, 45 } } );
+    const auto loud_only = hear_noises( angered, { { loud, 60 } } );
+    CHECK( both == loud_only );
+
+    const int heard = 60 - weather_data( g->weather ).sound_attn - 20;
+    CHECK( std::get<0>( both ) == 10 + heard );
+    CHECK( std::get<1>( both ) == angered.morale - heard );
+    // Loud enough to know exactly where it came from
+    CHECK( std::get<2>( both ) == loud );
+    CHECK( std::get<3>( both ) > 0 );
+}
@@ -2,10 +2,18 @@
 
 #include "game.h"
 #include "map.h"
+#include "mapbuffer.h"
+#include "submap.h"
 #include "vehicle.h"
 #include "veh_type.h"
 #include "player.h"
 
+#include "map_helpers.h"
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
 TEST_CASE( "destroy_grabbed_vehicle_section" )
 {
     GIVEN( "A vehicle grabbed by the player" ) {
@@ -26,3 +34,214 @@ TEST_CASE( "destroy_grabbed_vehicle_section" )
         }
     }
 }
+
+// The part lookups must find the same parts as scanning the whole part list
+static void check_part_lookups( const vehicle &veh )
+{
+    for( int x = -25; x <= 25; x++ ) {
+        for( int y = -25; y <= 25; y++ ) {
+            INFO( "at " << x << "," << y );
+            // The cached list is sorted for display, the scan by index
+            std::vector<int> cached = veh.parts_at_relative( x, y );
+            std::sort( cached.begin(), cached.end() );
+            CHECK( cached == veh.parts_at_relative( x, y, false ) );
+            int scanned = -1;
+            for( size_t p = 0; p < veh.parts.size(); p++ ) {
+                if( veh.parts[p].precalc[0] == point( x, y ) && !veh.parts[p].removed ) {
+                    scanned = p;
+                    break;
+                }
+            }
+            CHECK( veh.part_at( x, y ) == scanned );
+        }
+    }
+}
+
+TEST_CASE( "vehicle_part_lookups_match_part_list" )
+{
+    clear_map();
+    vehicle *veh_ptr = g->m.add_vehicle( vproto_id( "schoolbus" ), tripoint( 60, 60, 0 ), 0, 0, 0 );
+    REQUIRE( veh_ptr != nullptr );
+    vehicle &veh = *veh_ptr;
+    check_part_lookups( veh );
+
+    WHEN( "the vehicle turns" ) {
+        veh.face.init( 45 );
+        veh.precalc_mounts( 0, veh.face.dir(), veh.pivot_point() );
+        check_part_lookups( veh );
+    }
+    WHEN( "a part is removed" ) {
+        const point mount = veh.parts.front().mount;
+        const std::vector<int> before = veh.parts_at_relative( mount.x, mount.y );
+        veh.remove_part( before.back() );
+        CHECK( veh.parts_at_relative( mount.x, mount.y ).size() + 1 == before.size() );
+        check_part_lookups( veh );
+    }
+    WHEN( "a part is installed off the frame" ) {
+        const int p = veh.install_part( 20, 0, vpart_id( "frame_vertical" ), true );
+        REQUIRE( p >= 0 );
+        CHECK( veh.parts_at_relative( 20, 0 ) == std::vector<int> { p } );
+        check_part_lookups( veh );
+    }
+    clear_map();
+}
+
+static void check_flag_lists( const vehicle &veh, const std::string &flag )
+{
+    std::vector<int> scanned;
+    std::vector<int> scanned_unbroken;
+    for( size_t p = 0; p < veh.parts.size(); p++ ) {
+        if( veh.part_flag( p, flag ) ) {
+            scanned.push_back( p );
+            if( !veh.parts[ p ].is_broken() ) {
+                scanned_unbroken.push_back( p );
+            }
+        }
+    }
+    CHECK( veh.all_parts_with_feature( flag, false ) == scanned );
+    CHECK( veh.all_parts_with_feature( flag ) == scanned_unbroken );
+    CHECK( veh.get_parts( flag ).size() == scanned_unbroken.size() );
+    CHECK( veh.has_part( flag ) == !scanned_unbroken.empty() );
+}
+
+TEST_CASE( "vehicle_flag_lists_match_part_list" )
+{
+    clear_map();
+    vehicle *veh_ptr = g->m.add_vehicle( vproto_id( "schoolbus" ), tripoint( 60, 60, 0 ), 0, 0, 0 );
+    REQUIRE( veh_ptr != nullptr );
+    vehicle &veh = *veh_ptr;
+    const std::vector<std::string> flags = { "ENGINE", "WHEEL", "HORN", "SEAT", "OPENABLE", "NO_SUCH_FLAG" };
+
+    std::vector<int> wheels;
+    for( size_t p = 0; p < veh.parts.size(); p++ ) {
+        if( veh.part_flag( p, VPFLAG_WHEEL ) ) {
+            wheels.push_back( p );
+        }
+    }
+    REQUIRE( !wheels.empty() );
+    CHECK( veh.all_parts_with_feature( VPFLAG_WHEEL ) == wheels );
+    for( const std::string &flag : flags ) {
+        check_flag_lists( veh, flag );
+    }
+
+    WHEN( "a part breaks" ) {
+        vehicle_part &wheel = veh.parts[ wheels.front() ];
+        veh.mod_hp( wheel, -wheel.info().durability );
+        REQUIRE( veh.parts[ wheels.front() ].is_broken() );
+        CHECK( veh.all_parts_with_feature( VPFLAG_WHEEL ).size() + 1 == wheels.size() );
+        for( const std::string &flag : flags ) {
+            check_flag_lists( veh, flag );
+        }
+    }
+    WHEN( "a part is removed" ) {
+        veh.remove_part( wheels.back() );
+        CHECK( veh.all_parts_with_feature( VPFLAG_WHEEL, false ).size() + 1 == wheels.size() );
+        for( const std::string &flag : flags ) {
+            check_flag_lists( veh, flag );
+        }
+    }
+    clear_map();
+}
+
+static void check_vehicle_registry()
+{
+    std::set<vehicle *> swept;
+    for( auto &elem : MAPBUFFER ) {
+        swept.insert( elem.second->vehicles.begin(), elem.second->vehicles.end() );
+    }
+    std::set<vehicle *> registered;
+    for( auto &elem : MAPBUFFER.vehicle_submaps() ) {
+        CHECK( MAPBUFFER.lookup_submap( elem.first ) == elem.second );
+        CHECK( !elem.second->vehicles.empty() );
+        registered.insert( elem.second->vehicles.begin(), elem.second->vehicles.end() );
+    }
+    CHECK( registered == swept );
+}
+
+TEST_CASE( "vehicle_registry_matches_mapbuffer" )
+{
+    clear_map();
+    check_vehicle_registry();
+
+    vehicle *veh_ptr = g->m.add_vehicle( vproto_id( "schoolbus" ), tripoint( 60, 60, 0 ), 0, 0, 0 );
+    REQUIRE( veh_ptr != nullptr );
+    check_vehicle_registry();
+
+    veh_ptr->engine_on = false;
+    veh_ptr->is_alarm_on = false;
+    veh_ptr->camera_on = false;
+    for( vehicle_part *pt : veh_ptr->get_parts( VPFLAG_ENABLED_DRAINS_EPOWER, true ) ) {
+        pt->enabled = false;
+    }
+    CHECK( veh_ptr->is_dormant() );
+    veh_ptr->engine_on = true;
+    CHECK_FALSE( veh_ptr->is_dormant() );
+
+    WHEN( "the vehicle moves to another submap" ) {
+        tripoint pos = veh_ptr->global_pos3();
+        g->m.displace_vehicle( pos, tripoint( 2 * SEEX, 0, 0 ) );
+        check_vehicle_registry();
+    }
+    WHEN( "the vehicle is destroyed" ) {
+        g->m.destroy_vehicle( veh_ptr );
+        check_vehicle_registry();
+    }
+    clear_map();
+    check_vehicle_registry();
+}
+
+static vehicle &add_battery_vehicle( const tripoint &p, int charge )
+{
+    vehicle *veh_ptr = g->m.add_vehicle( vproto_id( "none" ), p, 0, 0, 0 );
+    REQUIRE( veh_ptr != nullptr );
+    REQUIRE( veh_ptr->install_part( 0, 0, vpart_id( "storage_battery" ), true ) >= 0 );
+    veh_ptr->charge_battery( charge, false );
+    REQUIRE( veh_ptr->fuel_left( "battery" ) == charge );
+    return *veh_ptr;
+}
+
+static int add_cable( vehicle &from, const vehicle &to )
+{
+    vehicle_part cable( vpart_id( "jumper_cable" ), 0, 0, item( "jumper_cable" ) );
+    cable.target.first = g->m.getabs( to.global_pos3() );
+    cable.target.second = to.real_global_pos3();
+    return from.install_part( 0, 0, cable );
+}
+
+TEST_CASE( "vehicle_power_grid_follows_cables" )
+{
+    clear_map();
+    vehicle &first = add_battery_vehicle( tripoint( 60, 60, 0 ), 100 );
+    vehicle &second = add_battery_vehicle( tripoint( 62, 60, 0 ), 1000 );
+    CHECK( first.power_grid().members.size() == 1 );
+    CHECK( first.fuel_left( "battery", true ) == 100 );
+
+    const int cable = add_cable( first, second );
+    REQUIRE( cable >= 0 );
+    REQUIRE( add_cable( second, first ) >= 0 );
+    REQUIRE( first.power_grid().members.size() == 2 );
+    CHECK( &first.power_grid() == &second.power_grid() );
+    CHECK( first.power_grid().charge() == 1100 );
+    CHECK( first.fuel_left( "battery", true ) == 1100 );
+
+    WHEN( "power is drawn through the cable" ) {
+        // The last 200 come from the other vehicle, the cable loses 1% on the way
+        CHECK( first.discharge_battery( 300 ) == 0 );
+        CHECK( first.fuel_left( "battery" ) == 0 );
+        CHECK( second.fuel_left( "battery" ) == 798 );
+        CHECK( first.power_grid().charge() == 798 );
+    }
+    WHEN( "the cable is removed" ) {
+        first.remove_part( cable );
+        CHECK( first.power_grid().members.size() == 1 );
+        CHECK( first.fuel_left( "battery", true ) == 100 );
+        CHECK( first.discharge_battery( 300 ) == 200 );
+        CHECK( second.fuel_left( "battery" ) == 1000 );
+    }
+    WHEN( "the other vehicle goes away" ) {
+        g->m.destroy_vehicle( &second );
+        CHECK( first.power_grid().members.size() == 1 );
+        CHECK( first.fuel_left( "battery", true ) == 100 );
+    }
+    clear_map();
+}